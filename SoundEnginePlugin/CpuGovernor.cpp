@@ -0,0 +1,250 @@
+#include "CpuGovernor.h"
+#include "Generator.h"
+#include "../FootstepsConfig.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace
+{
+    // Voices and ticks of the buffer in one counter, so each Execute only adds once. 48 bits of ticks
+    // hold days at any clock rate, far more than a buffer
+    const int EXECUTE_TICK_BITS = 48;
+    const AkUInt64 EXECUTE_TICK_MASK = (1ull << EXECUTE_TICK_BITS) - 1;
+    // Ticks are only converted once the steady clock has run this long since the first buffer
+    const AkUInt64 CALIBRATION_NANOSECONDS = 10000000;
+
+    // Added to by every voice, possibly from several rendering threads
+    std::atomic<AkUInt64> s_uExecuteTicks(0);
+    std::atomic<AkUInt32> s_uBudgetNanoseconds(0); // smallest non-zero budget of the buffer
+    std::atomic<AkInt32> s_iLevel(GENERATOR_QUALITY_FULL);
+
+    std::atomic<bool> s_bCallbackRegistered(false);
+    std::atomic<bool> s_bResetStatistics(false); // requested by ResetStatistics, applied by the next buffer
+
+    // Only touched by the sound engine's callbacks, which never run concurrently
+    CpuGovernorState s_State = {};
+    AkUInt32 s_uSettleBuffers = 0;
+    AkUInt32 s_uHeadroomBuffers = 0;
+    // Ticks and steady clock at the first buffer
+    bool s_bTickOrigin = false;
+    AkUInt64 s_uOriginTicks = 0;
+    std::chrono::steady_clock::time_point s_OriginTime;
+
+    // Copy of s_State for GetState, behind a sequence lock so neither side ever waits on the other.
+    // The sequence is odd while the copy is being written, readers retry if it was or if it moved
+    const AkUInt32 STATE_WORDS = (sizeof(CpuGovernorState) + sizeof(AkUInt64) - 1) / sizeof(AkUInt64);
+    std::atomic<AkUInt32> s_uStateSequence(0);
+    std::atomic<AkUInt64> s_PublishedState[STATE_WORDS] = {};
+
+    void PublishState()
+    {
+        AkUInt64 Words[STATE_WORDS] = {};
+        memcpy(Words, &s_State, sizeof(CpuGovernorState));
+
+        const AkUInt32 uSequence = s_uStateSequence.load(std::memory_order_relaxed);
+        s_uStateSequence.store(uSequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (AkUInt32 i = 0; i < STATE_WORDS; ++i)
+            s_PublishedState[i].store(Words[i], std::memory_order_relaxed);
+        s_uStateSequence.store(uSequence + 2, std::memory_order_release);
+    }
+
+    void OnGlobalCallback(AK::IAkGlobalPluginContext* in_pContext, AkGlobalCallbackLocation in_eLocation, void* in_pCookie)
+    {
+        if (in_eLocation == AkGlobalCallbackLocation_BeginRender)
+        {
+            CpuGovernor::EndBuffer();
+            return;
+        }
+
+        // Sound engine terminating, start over with full quality if it is initialized again
+        s_State = CpuGovernorState();
+        s_uSettleBuffers = 0;
+        s_uHeadroomBuffers = 0;
+        s_bTickOrigin = false;
+        s_bResetStatistics.store(false, std::memory_order_relaxed);
+        s_iLevel.store(GENERATOR_QUALITY_FULL, std::memory_order_relaxed);
+        PublishState();
+        s_bCallbackRegistered.store(false, std::memory_order_release);
+    }
+
+    // Moves the level from the load of the buffer that just ended
+    void GovernBuffer(AkUInt64 in_uExecute, AkUInt32 in_uBudget, AkUInt64 in_uTicks, std::chrono::steady_clock::time_point in_Now)
+    {
+        CpuGovernorState& State = s_State;
+        const AkUInt32 uVoices = (AkUInt32)(in_uExecute >> EXECUTE_TICK_BITS);
+
+        // Ticks per nanosecond over everything since the first buffer, the level holds until that has run long enough
+        if (!s_bTickOrigin)
+        {
+            s_bTickOrigin = true;
+            s_uOriginTicks = in_uTicks;
+            s_OriginTime = in_Now;
+        }
+        const AkUInt64 uElapsed = (AkUInt64)std::chrono::duration_cast<std::chrono::nanoseconds>(in_Now - s_OriginTime).count();
+        if (uElapsed < CALIBRATION_NANOSECONDS || in_uTicks <= s_uOriginTicks)
+        {
+            State.uLastVoices = uVoices;
+            return;
+        }
+        const double fNanosecondsPerTick = (double)uElapsed / (double)(in_uTicks - s_uOriginTicks);
+        const AkUInt64 uRender = (AkUInt64)((double)(in_uExecute & EXECUTE_TICK_MASK) * fNanosecondsPerTick);
+
+        State.uLastRenderMicroseconds = (AkUInt32)(uRender / 1000);
+        State.uLastBudgetMicroseconds = in_uBudget / 1000;
+        State.uLastVoices = uVoices;
+
+        // Nothing to govern, the next voices start at full quality
+        if (in_uBudget == 0)
+        {
+            State.iLevel = GENERATOR_QUALITY_FULL;
+            State.fLastLoad = 0.0f;
+            s_uSettleBuffers = 0;
+            s_uHeadroomBuffers = 0;
+            s_iLevel.store(State.iLevel, std::memory_order_relaxed);
+            return;
+        }
+
+        const AkReal32 fLoad = (AkReal32)uRender / (AkReal32)in_uBudget;
+        State.fLastLoad = fLoad;
+        if (fLoad > State.fPeakLoad)
+            State.fPeakLoad = fLoad;
+        State.uBuffers++;
+
+        if (s_uSettleBuffers > 0)
+            s_uSettleBuffers--;
+
+        if (fLoad > 1.0f)
+        {
+            State.uOverBudgetBuffers++;
+            s_uHeadroomBuffers = 0;
+            if (s_uSettleBuffers == 0 && State.iLevel < NUM_GENERATOR_QUALITIES - 1)
+            {
+                State.iLevel++;
+                State.uDegrades++;
+                s_uSettleBuffers = GOVERNOR_SETTLE_BUFFERS;
+            }
+        }
+        else if (fLoad < GOVERNOR_RESTORE_LOAD && State.iLevel > GENERATOR_QUALITY_FULL)
+        {
+            // Hysteresis, a single quiet buffer doesn't bring the cost back
+            if (++s_uHeadroomBuffers >= GOVERNOR_RESTORE_BUFFERS)
+            {
+                State.iLevel--;
+                State.uRestores++;
+                s_uHeadroomBuffers = 0;
+                s_uSettleBuffers = GOVERNOR_SETTLE_BUFFERS;
+            }
+        }
+        else
+        {
+            s_uHeadroomBuffers = 0;
+        }
+
+        s_iLevel.store(State.iLevel, std::memory_order_relaxed);
+    }
+}
+
+void CpuGovernor::Register(AK::IAkGlobalPluginContext* in_pGlobalContext)
+{
+    // Voices are initialized by the audio thread, only the first one registers
+    bool bRegistered = false;
+    if (in_pGlobalContext != nullptr && s_bCallbackRegistered.compare_exchange_strong(bRegistered, true, std::memory_order_acq_rel))
+    {
+        const AKRESULT eResult = in_pGlobalContext->RegisterGlobalCallback(
+            AkPluginTypeSource,
+            FootstepsConfig::CompanyID,
+            FootstepsConfig::PluginID,
+            OnGlobalCallback,
+            AkGlobalCallbackLocation_BeginRender | AkGlobalCallbackLocation_Term);
+        if (eResult != AK_Success)
+            s_bCallbackRegistered.store(false, std::memory_order_release);
+    }
+}
+
+AkUInt64 CpuGovernor::ReadTicks()
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    AkUInt64 uTicks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(uTicks));
+    return uTicks;
+#else
+    return (AkUInt64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void CpuGovernor::AddExecuteTicks(AkUInt64 in_uTicks, AkUInt32 in_uBudgetNanoseconds)
+{
+    s_uExecuteTicks.fetch_add((1ull << EXECUTE_TICK_BITS) | (in_uTicks & EXECUTE_TICK_MASK), std::memory_order_relaxed);
+
+    // The strictest budget applies to every voice
+    if (in_uBudgetNanoseconds > 0)
+    {
+        AkUInt32 uBudget = s_uBudgetNanoseconds.load(std::memory_order_relaxed);
+        while ((uBudget == 0 || in_uBudgetNanoseconds < uBudget)
+            && !s_uBudgetNanoseconds.compare_exchange_weak(uBudget, in_uBudgetNanoseconds, std::memory_order_relaxed))
+        {
+        }
+    }
+}
+
+void CpuGovernor::EndBuffer()
+{
+    const AkUInt64 uExecute = s_uExecuteTicks.exchange(0, std::memory_order_relaxed);
+    const AkUInt32 uBudget = s_uBudgetNanoseconds.exchange(0, std::memory_order_relaxed);
+    const AkUInt64 uTicks = ReadTicks();
+    const std::chrono::steady_clock::time_point Now = std::chrono::steady_clock::now();
+
+    if (s_bResetStatistics.exchange(false, std::memory_order_relaxed))
+    {
+        s_State.fPeakLoad = 0.0f;
+        s_State.uBuffers = 0;
+        s_State.uOverBudgetBuffers = 0;
+        s_State.uDegrades = 0;
+        s_State.uRestores = 0;
+    }
+
+    GovernBuffer(uExecute, uBudget, uTicks, Now);
+    PublishState();
+}
+
+AkInt32 CpuGovernor::GetLevel()
+{
+    return s_iLevel.load(std::memory_order_relaxed);
+}
+
+CpuGovernorState CpuGovernor::GetState()
+{
+    AkUInt64 Words[STATE_WORDS];
+    AkUInt32 uSequence;
+    for (;;)
+    {
+        uSequence = s_uStateSequence.load(std::memory_order_acquire);
+        if (uSequence & 1)
+            continue;
+        for (AkUInt32 i = 0; i < STATE_WORDS; ++i)
+            Words[i] = s_PublishedState[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s_uStateSequence.load(std::memory_order_relaxed) == uSequence)
+            break;
+    }
+
+    CpuGovernorState State;
+    memcpy(&State, Words, sizeof(CpuGovernorState));
+    return State;
+}
+
+void CpuGovernor::ResetStatistics()
+{
+    s_bResetStatistics.store(true, std::memory_order_relaxed);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/IAkPlugin.h>
+
+// Level changes of the CpuGovernor. A level change only shows in the measurements once the voices have
+// stepped to it, cached steps first have to record one, so the governor waits before degrading further
+const AkUInt32 GOVERNOR_SETTLE_BUFFERS = 8;
+// Load, as a fraction of the budget, the voices must stay under before they are restored one level
+const AkReal32 GOVERNOR_RESTORE_LOAD = 0.7f;
+const AkUInt32 GOVERNOR_RESTORE_BUFFERS = 48;
+
+// What the governor measured and decided, for tuning the budgets of each platform
+struct CpuGovernorState
+{
+    AkInt32 iLevel; // GeneratorQuality voices with a budget are rendered at
+    AkReal32 fLastLoad; // render time of the last buffer over its budget, 0 without a budget
+    AkReal32 fPeakLoad; // highest load since the last ResetStatistics()
+    AkUInt32 uLastRenderMicroseconds; // every voice's Execute in the last buffer
+    AkUInt32 uLastBudgetMicroseconds; // smallest budget reported in the last buffer
+    AkUInt32 uLastVoices;
+    AkUInt64 uBuffers; // buffers measured with a budget
+    AkUInt64 uOverBudgetBuffers;
+    AkUInt32 uDegrades;
+    AkUInt32 uRestores;
+};
+
+// Process-wide CPU budget shared by every footstep voice.
+// Each voice adds the time its Execute took and its own budget. At the start of every audio buffer the total
+// of the previous one is compared with the smallest budget reported: over budget the voices are degraded one
+// GeneratorQuality level, and restored one level after GOVERNOR_RESTORE_BUFFERS buffers under GOVERNOR_RESTORE_LOAD.
+// Voices time themselves with the CPU's tick counter, which costs a fraction of a clock read. The ticks are
+// converted to nanoseconds once per buffer, against the steady clock since the first buffer.
+// The state is only written by the sound engine's callbacks and read through a sequence lock, no thread takes a lock.
+class CpuGovernor
+{
+public:
+    // Registers the per-buffer callback, once per sound engine
+    static void Register(AK::IAkGlobalPluginContext* in_pGlobalContext);
+    // Tick counter the voices time their Execute with, TSC ticks on x86
+    static AkUInt64 ReadTicks();
+    // Called at the end of every Execute, in_uBudgetNanoseconds is 0 for voices without a budget
+    static void AddExecuteTicks(AkUInt64 in_uTicks, AkUInt32 in_uBudgetNanoseconds);
+    // Closes the buffer being measured and moves the level, run by the sound engine before every buffer
+    static void EndBuffer();
+    // Level for the voices of the buffer being rendered
+    static AkInt32 GetLevel();
+    // State as of the last buffer, never blocks the sound engine's callback
+    static CpuGovernorState GetState();
+    // Clears the counters and the peak load at the next buffer, keeps the level
+    static void ResetStatistics();
+};
@@ -0,0 +1,105 @@
+#include "CrunchGrains.h"
+
+#include <cmath>
+
+namespace
+{
+    // Tuning range of the crunch filter for each surface in Hz, 0 for surfaces without crunch
+    struct CrunchBand
+    {
+        float Freq1;
+        float Freq2;
+    };
+
+    const CrunchBand CRUNCH_BANDS[CrunchGrainBank::NUM_SURFACES] = {
+        { 0.0f, 0.0f },       // Wood
+        { 1000.0f, 200.0f },  // Concrete
+        { 200.0f, 50.0f },    // Dirt
+        { 1500.0f, 800.0f },  // Grass
+        { 0.0f, 0.0f },       // Hollow Wood
+        { 0.0f, 0.0f }        // Metal
+    };
+
+    // Grain envelope ranges in seconds
+    const float GRAIN_MIN_ATTACK = 0.0001f;
+    const float GRAIN_ATTACK_RANGE = 0.0001f;
+    const float GRAIN_MIN_DECAY = 0.0102f;
+    const float GRAIN_DECAY_RANGE = 0.0342f;
+
+    // Noise run through the filter before a grain starts, the continuous chain never started from silence
+    const float GRAIN_PREROLL = 0.01f;
+
+    // Fixed so every voice and every run gets the same grains
+    const unsigned int GRAIN_SEED = 0x6372756e;
+}
+
+const CrunchGrainBank* CrunchGrainBank::Request(AK::IAkPluginMemAlloc* in_pAllocator, AkUInt32 in_uSampleRate)
+{
+    // One per model rate a voice was prepared at, every output rate by every rate divisor
+    return SharedBank::Request<CrunchGrainBank>(in_pAllocator, SHARED_BANK_CRUNCH_GRAINS, in_uSampleRate, 0);
+}
+
+CrunchGrainBank::CrunchGrainBank(AK::IAkPluginMemAlloc* in_pAllocator, AkUInt32 in_uSampleRate, AkUInt32 in_uVariant)
+    : SharedBank(in_pAllocator, SHARED_BANK_CRUNCH_GRAINS, in_uSampleRate, in_uVariant)
+{
+}
+
+const float* CrunchGrainBank::GetGrain(int in_iSurfaceType, int in_iIndex, int& out_iLength) const
+{
+    if (in_iSurfaceType < 0 || in_iSurfaceType >= NUM_SURFACES || in_iIndex < 0 || in_iIndex >= CRUNCH_GRAINS_PER_SURFACE)
+    {
+        out_iLength = 0;
+        return nullptr;
+    }
+    out_iLength = m_Lengths[in_iSurfaceType][in_iIndex];
+    return out_iLength > 0 ? &m_Samples[m_Offsets[in_iSurfaceType][in_iIndex]] : nullptr;
+}
+
+bool CrunchGrainBank::Build()
+{
+    const int SampleRate = (int)m_uSampleRate;
+    const int MaxLength = (int)std::ceil((GRAIN_MIN_ATTACK + GRAIN_ATTACK_RANGE + GRAIN_MIN_DECAY + GRAIN_DECAY_RANGE) * SampleRate) + 2;
+    const int PrerollLength = (int)(GRAIN_PREROLL * SampleRate);
+
+    int NumCrunchSurfaces = 0;
+    for (int Surface = 0; Surface < NUM_SURFACES; ++Surface)
+    {
+        if (CRUNCH_BANDS[Surface].Freq1 > 0.0f)
+            ++NumCrunchSurfaces;
+    }
+    if (!m_Samples.Allocate(NumCrunchSurfaces * CRUNCH_GRAINS_PER_SURFACE * MaxLength, m_Allocator))
+        return false;
+    int NumSamples = 0;
+
+    nemlib::Random Rng(GRAIN_SEED);
+    nemlib::WhiteNoiseGen Noise;
+    Noise.SetSeed(GRAIN_SEED);
+    nemlib::DistortionProcessor Distortion(200.0f);
+
+    for (int Surface = 0; Surface < NUM_SURFACES; ++Surface)
+    {
+        const CrunchBand& Band = CRUNCH_BANDS[Surface];
+        if (Band.Freq1 <= 0.0f)
+            continue;
+
+        for (int Grain = 0; Grain < CRUNCH_GRAINS_PER_SURFACE; ++Grain)
+        {
+            nemlib::BiquadFilter Filter(SampleRate, Rng.NextFloat() * (Band.Freq1 - Band.Freq2) + Band.Freq1, Rng.NextFloat() * 7.0f + 3.0f, 0.0f, nemlib::bq_type_lowpass);
+            nemlib::CurveEnvelope Env(SampleRate, { 0.0f, 1.0f, 0.0f }, { Rng.NextFloat() * GRAIN_ATTACK_RANGE + GRAIN_MIN_ATTACK, Rng.NextFloat() * GRAIN_DECAY_RANGE + GRAIN_MIN_DECAY });
+
+            for (int i = 0; i < PrerollLength; ++i)
+                Filter.ProcessSample(Distortion.ProcessSample(Noise.NextSample()));
+
+            m_Offsets[Surface][Grain] = NumSamples;
+            Env.ResetEnvelope();
+            int Length = 0;
+            while (Env.IsActive() && Length < MaxLength)
+            {
+                m_Samples[NumSamples++] = Env.GetNextEnvelopePoint() * Filter.ProcessSample(Distortion.ProcessSample(Noise.NextSample()));
+                ++Length;
+            }
+            m_Lengths[Surface][Grain] = Length;
+        }
+    }
+    return true;
+}
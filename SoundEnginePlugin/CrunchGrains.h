@@ -0,0 +1,38 @@
+#pragma once
+
+#include "FootstepsLibrary.h"
+#include "SharedBank.h"
+#include <AK/SoundEngine/Common/AkCommonDefs.h>
+
+// Number of grains pre-rendered for every crunchy surface
+const int CRUNCH_GRAINS_PER_SURFACE = 16;
+
+// Process-wide tables of crunch grains, one bank per sample rate.
+// A grain is distorted white noise through a randomly tuned resonant low pass, shaped by a short
+// attack/decay envelope, which is the chain the Generator used to run and retune on every sample.
+// Voices only overlap-add grains from the bank, so nothing is filtered or retuned on the audio thread.
+// Banks are requested by PrepareModel for any number of rates and built by the lookahead worker, the voice
+// triggers no grain until its bank is ready.
+class CrunchGrainBank : public SharedBank
+{
+    friend class SharedBank;
+
+public:
+    static const int NUM_SURFACES = 6;
+
+    // Returns the bank for in_uSampleRate, requesting it from in_pAllocator on first use. nullptr if out of memory.
+    // Never locks
+    static const CrunchGrainBank* Request(AK::IAkPluginMemAlloc* in_pAllocator, AkUInt32 in_uSampleRate);
+
+    // Grain in_iIndex of in_iSurfaceType and its length in samples, nullptr for surfaces without crunch
+    const float* GetGrain(int in_iSurfaceType, int in_iIndex, int& out_iLength) const;
+
+private:
+    CrunchGrainBank(AK::IAkPluginMemAlloc* in_pAllocator, AkUInt32 in_uSampleRate, AkUInt32 in_uVariant);
+
+    bool Build() override;
+
+    nemlib::Buffer<float> m_Samples;
+    int m_Offsets[NUM_SURFACES][CRUNCH_GRAINS_PER_SURFACE] = {};
+    int m_Lengths[NUM_SURFACES][CRUNCH_GRAINS_PER_SURFACE] = {};
+};
@@ -0,0 +1,334 @@
+/*
+* NEMISINDO LIBRARY - KERNELS
+*
+* Scalar reference kernels and their SSE2, AVX2 and AVX-512 variants. The vector variants are compiled with
+* per-function target attributes, or with intrinsics MSVC accepts in any translation unit, so the rest of the
+* library keeps the build's baseline instruction set. None of the targets enables FMA, a fused multiply-add
+* rounds once where the scalar code rounds twice.
+*/
+
+#include "FootstepsKernels.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define NEMLIB_X86_KERNELS 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define NEMLIB_TARGET(Isa)
+#elif defined(__clang__)
+// Clang only fuses within a single expression, which the intrinsics below never are
+#define NEMLIB_TARGET(Isa) __attribute__((target(Isa)))
+#else
+// GCC fuses across statements and AVX-512 brings FMA along with it
+#define NEMLIB_TARGET(Isa) __attribute__((target(Isa), optimize("fp-contract=off")))
+#endif
+#else
+#define NEMLIB_X86_KERNELS 0
+#endif
+
+namespace nemlib
+{
+    namespace
+    {
+        // "lowbias32" integer hash constants (C. Wellons), same stream as Random
+        const unsigned int HASH_STEP = 0x9E3779B9u;
+        const unsigned int HASH_MUL1 = 0x7FEB352Du;
+        const unsigned int HASH_MUL2 = 0x846CA68Bu;
+
+        /*### SCALAR ###*/
+
+        float NoiseSampleScalar(unsigned int InSeed, unsigned int InPosition) {
+            unsigned int X = InSeed + HASH_STEP * InPosition;
+            X ^= X >> 16;
+            X *= HASH_MUL1;
+            X ^= X >> 15;
+            X *= HASH_MUL2;
+            X ^= X >> 16;
+            // Top 23 bits as the mantissa of a float in [2.0, 4.0), then shifted to [-1.0, 1.0)
+            unsigned int FloatBits = 0x40000000u | (X >> 9);
+            float Sample;
+            memcpy(&Sample, &FloatBits, sizeof(Sample));
+            return Sample - 3.0f;
+        }
+
+        void NoiseBlockScalar(unsigned int InSeed, unsigned int InCounter, float* OutBlock, int InCount) {
+            for (int i = 0; i < InCount; i++) {
+                OutBlock[i] = NoiseSampleScalar(InSeed, InCounter + (unsigned int)i);
+            }
+        }
+
+        float FilterBankSampleScalar(FilterBankLanes& InOutLanes, int InNumFilters, float InSample) {
+            FilterBankLanes& L = InOutLanes;
+            float Output = 0.0f;
+            for (int i = 0; i < InNumFilters; i++) {
+                float Out = ((InSample * L.B0[i]) + (L.X1[i] * L.B1[i]) + (L.X2[i] * L.B2[i]) - (L.Y1[i] * L.A1[i]) - (L.Y2[i] * L.A2[i])) / L.A0[i];
+                L.Y2[i] = L.Y1[i];
+                L.Y1[i] = Out;
+                L.X2[i] = L.X1[i];
+                L.X1[i] = InSample;
+                Output += Out * L.Gains[i];
+            }
+            return Output;
+        }
+
+        // The vector kernels weigh every lane at once, the sum stays in lane order to round as the scalar one does
+        float SumInOrder(const float* InValues, int InCount) {
+            float Sum = 0.0f;
+            for (int i = 0; i < InCount; i++) {
+                Sum += InValues[i];
+            }
+            return Sum;
+        }
+
+        const KernelTable SCALAR_KERNELS = { NoiseBlockScalar, FilterBankSampleScalar };
+
+#if NEMLIB_X86_KERNELS
+        /*### SSE2 ###*/
+
+        // Low 32 bits of each product, SSE2 only multiplies the even lanes
+        NEMLIB_TARGET("sse2")
+        inline __m128i MulLo32Sse2(__m128i InA, __m128i InB) {
+            __m128i Even = _mm_mul_epu32(InA, InB);
+            __m128i Odd = _mm_mul_epu32(_mm_srli_epi64(InA, 32), _mm_srli_epi64(InB, 32));
+            return _mm_unpacklo_epi32(_mm_shuffle_epi32(Even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(Odd, _MM_SHUFFLE(0, 0, 2, 0)));
+        }
+
+        NEMLIB_TARGET("sse2")
+        void NoiseBlockSse2(unsigned int InSeed, unsigned int InCounter, float* OutBlock, int InCount) {
+            const __m128i Seed = _mm_set1_epi32((int)InSeed);
+            const __m128i Step = _mm_set1_epi32((int)HASH_STEP);
+            const __m128i Mul1 = _mm_set1_epi32((int)HASH_MUL1);
+            const __m128i Mul2 = _mm_set1_epi32((int)HASH_MUL2);
+            const __m128i Exponent = _mm_set1_epi32(0x40000000);
+            const __m128 Offset = _mm_set1_ps(3.0f);
+            __m128i Position = _mm_add_epi32(_mm_set1_epi32((int)InCounter), _mm_setr_epi32(0, 1, 2, 3));
+            int i = 0;
+            for (; i + 4 <= InCount; i += 4) {
+                __m128i X = _mm_add_epi32(Seed, MulLo32Sse2(Step, Position));
+                X = _mm_xor_si128(X, _mm_srli_epi32(X, 16));
+                X = MulLo32Sse2(X, Mul1);
+                X = _mm_xor_si128(X, _mm_srli_epi32(X, 15));
+                X = MulLo32Sse2(X, Mul2);
+                X = _mm_xor_si128(X, _mm_srli_epi32(X, 16));
+                __m128 Sample = _mm_castsi128_ps(_mm_or_si128(Exponent, _mm_srli_epi32(X, 9)));
+                _mm_storeu_ps(OutBlock + i, _mm_sub_ps(Sample, Offset));
+                Position = _mm_add_epi32(Position, _mm_set1_epi32(4));
+            }
+            // Not handed to NoiseBlockScalar, GCC leaves the upper halves of the registers dirty on tail calls
+            for (; i < InCount; i++) {
+                OutBlock[i] = NoiseSampleScalar(InSeed, InCounter + (unsigned int)i);
+            }
+        }
+
+        NEMLIB_TARGET("sse2")
+        float FilterBankSampleSse2(FilterBankLanes& InOutLanes, int InNumFilters, float InSample) {
+            FilterBankLanes& L = InOutLanes;
+            float Weighted[FILTERBANK_LANES];
+            const __m128 X0 = _mm_set1_ps(InSample);
+            for (int i = 0; i < InNumFilters; i += 4) {
+                __m128 X1 = _mm_loadu_ps(L.X1 + i);
+                __m128 X2 = _mm_loadu_ps(L.X2 + i);
+                __m128 Y1 = _mm_loadu_ps(L.Y1 + i);
+                __m128 Y2 = _mm_loadu_ps(L.Y2 + i);
+                __m128 Sum = _mm_add_ps(_mm_mul_ps(X0, _mm_loadu_ps(L.B0 + i)), _mm_mul_ps(X1, _mm_loadu_ps(L.B1 + i)));
+                Sum = _mm_add_ps(Sum, _mm_mul_ps(X2, _mm_loadu_ps(L.B2 + i)));
+                Sum = _mm_sub_ps(Sum, _mm_mul_ps(Y1, _mm_loadu_ps(L.A1 + i)));
+                Sum = _mm_sub_ps(Sum, _mm_mul_ps(Y2, _mm_loadu_ps(L.A2 + i)));
+                __m128 Out = _mm_div_ps(Sum, _mm_loadu_ps(L.A0 + i));
+                _mm_storeu_ps(L.Y2 + i, Y1);
+                _mm_storeu_ps(L.Y1 + i, Out);
+                _mm_storeu_ps(L.X2 + i, X1);
+                _mm_storeu_ps(L.X1 + i, X0);
+                _mm_storeu_ps(Weighted + i, _mm_mul_ps(Out, _mm_loadu_ps(L.Gains + i)));
+            }
+            return SumInOrder(Weighted, InNumFilters);
+        }
+
+        const KernelTable SSE2_KERNELS = { NoiseBlockSse2, FilterBankSampleSse2 };
+
+        /*### AVX2 ###*/
+
+        NEMLIB_TARGET("avx2")
+        void NoiseBlockAvx2(unsigned int InSeed, unsigned int InCounter, float* OutBlock, int InCount) {
+            const __m256i Seed = _mm256_set1_epi32((int)InSeed);
+            const __m256i Step = _mm256_set1_epi32((int)HASH_STEP);
+            const __m256i Mul1 = _mm256_set1_epi32((int)HASH_MUL1);
+            const __m256i Mul2 = _mm256_set1_epi32((int)HASH_MUL2);
+            const __m256i Exponent = _mm256_set1_epi32(0x40000000);
+            const __m256 Offset = _mm256_set1_ps(3.0f);
+            __m256i Position = _mm256_add_epi32(_mm256_set1_epi32((int)InCounter), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+            int i = 0;
+            for (; i + 8 <= InCount; i += 8) {
+                __m256i X = _mm256_add_epi32(Seed, _mm256_mullo_epi32(Step, Position));
+                X = _mm256_xor_si256(X, _mm256_srli_epi32(X, 16));
+                X = _mm256_mullo_epi32(X, Mul1);
+                X = _mm256_xor_si256(X, _mm256_srli_epi32(X, 15));
+                X = _mm256_mullo_epi32(X, Mul2);
+                X = _mm256_xor_si256(X, _mm256_srli_epi32(X, 16));
+                __m256 Sample = _mm256_castsi256_ps(_mm256_or_si256(Exponent, _mm256_srli_epi32(X, 9)));
+                _mm256_storeu_ps(OutBlock + i, _mm256_sub_ps(Sample, Offset));
+                Position = _mm256_add_epi32(Position, _mm256_set1_epi32(8));
+            }
+            // Not handed to NoiseBlockScalar, GCC leaves the upper halves of the registers dirty on tail calls
+            for (; i < InCount; i++) {
+                OutBlock[i] = NoiseSampleScalar(InSeed, InCounter + (unsigned int)i);
+            }
+        }
+
+        NEMLIB_TARGET("avx2")
+        float FilterBankSampleAvx2(FilterBankLanes& InOutLanes, int InNumFilters, float InSample) {
+            FilterBankLanes& L = InOutLanes;
+            float Weighted[FILTERBANK_LANES];
+            const __m256 X0 = _mm256_set1_ps(InSample);
+            for (int i = 0; i < InNumFilters; i += 8) {
+                __m256 X1 = _mm256_loadu_ps(L.X1 + i);
+                __m256 X2 = _mm256_loadu_ps(L.X2 + i);
+                __m256 Y1 = _mm256_loadu_ps(L.Y1 + i);
+                __m256 Y2 = _mm256_loadu_ps(L.Y2 + i);
+                __m256 Sum = _mm256_add_ps(_mm256_mul_ps(X0, _mm256_loadu_ps(L.B0 + i)), _mm256_mul_ps(X1, _mm256_loadu_ps(L.B1 + i)));
+                Sum = _mm256_add_ps(Sum, _mm256_mul_ps(X2, _mm256_loadu_ps(L.B2 + i)));
+                Sum = _mm256_sub_ps(Sum, _mm256_mul_ps(Y1, _mm256_loadu_ps(L.A1 + i)));
+                Sum = _mm256_sub_ps(Sum, _mm256_mul_ps(Y2, _mm256_loadu_ps(L.A2 + i)));
+                __m256 Out = _mm256_div_ps(Sum, _mm256_loadu_ps(L.A0 + i));
+                _mm256_storeu_ps(L.Y2 + i, Y1);
+                _mm256_storeu_ps(L.Y1 + i, Out);
+                _mm256_storeu_ps(L.X2 + i, X1);
+                _mm256_storeu_ps(L.X1 + i, X0);
+                _mm256_storeu_ps(Weighted + i, _mm256_mul_ps(Out, _mm256_loadu_ps(L.Gains + i)));
+            }
+            return SumInOrder(Weighted, InNumFilters);
+        }
+
+        const KernelTable AVX2_KERNELS = { NoiseBlockAvx2, FilterBankSampleAvx2 };
+
+        /*### AVX-512 ###*/
+
+        NEMLIB_TARGET("avx512f")
+        void NoiseBlockAvx512(unsigned int InSeed, unsigned int InCounter, float* OutBlock, int InCount) {
+            const __m512i Seed = _mm512_set1_epi32((int)InSeed);
+            const __m512i Step = _mm512_set1_epi32((int)HASH_STEP);
+            const __m512i Mul1 = _mm512_set1_epi32((int)HASH_MUL1);
+            const __m512i Mul2 = _mm512_set1_epi32((int)HASH_MUL2);
+            const __m512i Exponent = _mm512_set1_epi32(0x40000000);
+            const __m512 Offset = _mm512_set1_ps(3.0f);
+            // Masked shifts, the unmasked ones start from an undefined vector GCC warns about
+            const __mmask16 ALL_LANES = 0xFFFF;
+            __m512i Position = _mm512_add_epi32(_mm512_set1_epi32((int)InCounter),
+                _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+            int i = 0;
+            for (; i + 16 <= InCount; i += 16) {
+                __m512i X = _mm512_add_epi32(Seed, _mm512_mullo_epi32(Step, Position));
+                X = _mm512_xor_si512(X, _mm512_maskz_srli_epi32(ALL_LANES, X, 16));
+                X = _mm512_mullo_epi32(X, Mul1);
+                X = _mm512_xor_si512(X, _mm512_maskz_srli_epi32(ALL_LANES, X, 15));
+                X = _mm512_mullo_epi32(X, Mul2);
+                X = _mm512_xor_si512(X, _mm512_maskz_srli_epi32(ALL_LANES, X, 16));
+                __m512 Sample = _mm512_castsi512_ps(_mm512_or_si512(Exponent, _mm512_maskz_srli_epi32(ALL_LANES, X, 9)));
+                _mm512_storeu_ps(OutBlock + i, _mm512_sub_ps(Sample, Offset));
+                Position = _mm512_add_epi32(Position, _mm512_set1_epi32(16));
+            }
+            // Not handed to NoiseBlockScalar, GCC leaves the upper halves of the registers dirty on tail calls
+            for (; i < InCount; i++) {
+                OutBlock[i] = NoiseSampleScalar(InSeed, InCounter + (unsigned int)i);
+            }
+        }
+
+        // A bank's filters would fill one vector with more than a third of it idle, and its 64-byte loads rarely
+        // line up with the cache lines, which made the AVX-512 filter bank slower than the AVX2 one
+        const KernelTable AVX512_KERNELS = { NoiseBlockAvx512, FilterBankSampleAvx2 };
+
+        const KernelTable* const VARIANT_KERNELS[NUM_KERNEL_VARIANTS] = { &SCALAR_KERNELS, &SSE2_KERNELS, &AVX2_KERNELS, &AVX512_KERNELS };
+#else
+        const KernelTable* const VARIANT_KERNELS[NUM_KERNEL_VARIANTS] = { &SCALAR_KERNELS, &SCALAR_KERNELS, &SCALAR_KERNELS, &SCALAR_KERNELS };
+#endif
+
+        const char* const VARIANT_NAMES[NUM_KERNEL_VARIANTS] = { "scalar", "sse2", "avx2", "avx512" };
+
+        KernelVariant DetectKernelVariant() {
+#if NEMLIB_X86_KERNELS && defined(_MSC_VER) && !defined(__clang__)
+            int Info[4];
+            __cpuid(Info, 0);
+            const int MaxLeaf = Info[0];
+            __cpuid(Info, 1);
+            if ((Info[3] & (1 << 26)) == 0) {
+                return KERNEL_SCALAR;
+            }
+            // AVX registers are only usable once the OS saves them on context switches
+            const bool HasOsAvx = (Info[2] & (1 << 27)) != 0 && (Info[2] & (1 << 28)) != 0;
+            const unsigned long long SavedState = HasOsAvx ? _xgetbv(0) : 0;
+            if (MaxLeaf < 7 || (SavedState & 0x6) != 0x6) {
+                return KERNEL_SSE2;
+            }
+            __cpuidex(Info, 7, 0);
+            if ((Info[1] & (1 << 16)) != 0 && (SavedState & 0xE6) == 0xE6) {
+                return KERNEL_AVX512;
+            }
+            return (Info[1] & (1 << 5)) != 0 ? KERNEL_AVX2 : KERNEL_SSE2;
+#elif NEMLIB_X86_KERNELS
+            // Also checks that the OS saves the wider registers
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) {
+                return KERNEL_AVX512;
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                return KERNEL_AVX2;
+            }
+            return __builtin_cpu_supports("sse2") ? KERNEL_SSE2 : KERNEL_SCALAR;
+#else
+            return KERNEL_SCALAR;
+#endif
+        }
+
+        const KernelVariant SUPPORTED_VARIANT = DetectKernelVariant();
+
+        // Best supported variant, capped by FOOTSTEPS_KERNELS
+        KernelVariant GetDefaultKernelVariant() {
+            const char* Setting = getenv("FOOTSTEPS_KERNELS");
+            if (Setting != nullptr) {
+                for (int i = 0; i < NUM_KERNEL_VARIANTS; i++) {
+                    if (strcmp(Setting, VARIANT_NAMES[i]) == 0) {
+                        return (KernelVariant)i;
+                    }
+                }
+            }
+            return NUM_KERNEL_VARIANTS;
+        }
+    }
+
+    // Scalar until the selection below has run, for code that renders during static initialization
+    std::atomic<const KernelTable*> ActiveKernels(&SCALAR_KERNELS);
+
+    KernelVariant GetSupportedKernelVariant() {
+        return SUPPORTED_VARIANT;
+    }
+    KernelVariant GetKernelVariant() {
+        // Outside x86 every entry is the scalar table, which is found first
+        const KernelTable* Kernels = ActiveKernels.load(std::memory_order_relaxed);
+        for (int i = 0; i < NUM_KERNEL_VARIANTS; i++) {
+            if (VARIANT_KERNELS[i] == Kernels) {
+                return (KernelVariant)i;
+            }
+        }
+        return KERNEL_SCALAR;
+    }
+    KernelVariant SelectKernels(KernelVariant InVariant) {
+        KernelVariant Variant = InVariant < SUPPORTED_VARIANT ? InVariant : SUPPORTED_VARIANT;
+        if (Variant < KERNEL_SCALAR) {
+            Variant = KERNEL_SCALAR;
+        }
+        ActiveKernels.store(VARIANT_KERNELS[Variant], std::memory_order_relaxed);
+        return Variant;
+    }
+    const char* GetKernelVariantName(KernelVariant InVariant) {
+        return InVariant >= KERNEL_SCALAR && InVariant < NUM_KERNEL_VARIANTS ? VARIANT_NAMES[InVariant] : "unknown";
+    }
+
+    namespace
+    {
+        // Selected once, when the library is loaded and the plug-in registers
+        const KernelVariant LOADED_VARIANT = SelectKernels(GetDefaultKernelVariant());
+    }
+}
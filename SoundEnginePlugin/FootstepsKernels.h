@@ -0,0 +1,70 @@
+/*
+* NEMISINDO LIBRARY - KERNELS
+*
+* The loops every voice runs the most, compiled once per instruction set with the best one picked at run time,
+* so a build for baseline x86-64 still uses AVX2 and AVX-512 on the machines that have them and runs everywhere
+* else. The variant is read from CPUID when the library is loaded, which for the plug-in is when it registers
+* with the sound engine. The scalar kernels are the reference and the only ones outside x86.
+* Every variant runs the same operations in the same order as the scalar one, without fused multiply-adds,
+* so they all render the same output bit for bit.
+* For debugging, the environment variable FOOTSTEPS_KERNELS (scalar, sse2, avx2 or avx512) caps the variant
+* selected at load, and SelectKernels() changes it at any time.
+*/
+
+#pragma once
+#include <atomic>
+
+namespace nemlib
+{
+    // Filters the kernels run in one FilterBank, two AVX2 vectors
+    const int FILTERBANK_LANES = 16;
+
+    /* FilterBankLanes
+    Coefficients, memories and gains of a FilterBank's biquads with one array per field, so the kernels run
+    several filters per instruction. Lanes past the bank's filters have no gain and stay silent. */
+    struct FilterBankLanes {
+        float B0[FILTERBANK_LANES];
+        float B1[FILTERBANK_LANES];
+        float B2[FILTERBANK_LANES];
+        float A0[FILTERBANK_LANES];
+        float A1[FILTERBANK_LANES];
+        float A2[FILTERBANK_LANES];
+        float X1[FILTERBANK_LANES]; // x[n-1]
+        float X2[FILTERBANK_LANES]; // x[n-2]
+        float Y1[FILTERBANK_LANES]; // y[n-1]
+        float Y2[FILTERBANK_LANES]; // y[n-2]
+        float Gains[FILTERBANK_LANES];
+    };
+
+    // Instruction sets the kernels are compiled for, each one needs the ones before it
+    enum KernelVariant {
+        KERNEL_SCALAR = 0,
+        KERNEL_SSE2,
+        KERNEL_AVX2,
+        KERNEL_AVX512,
+        NUM_KERNEL_VARIANTS
+    };
+
+    struct KernelTable {
+        // InCount samples of white noise in [-1.0, 1.0), from the lowbias32 stream of InSeed at position InCounter
+        void (*NoiseBlock)(unsigned int InSeed, unsigned int InCounter, float* OutBlock, int InCount);
+        // Runs InSample through the first InNumFilters lanes and returns their outputs times their gains,
+        // summed in lane order. Lanes after them up to the vector width may be run as well
+        float (*FilterBankSample)(FilterBankLanes& InOutLanes, int InNumFilters, float InSample);
+    };
+
+    // Kernels of the selected variant
+    extern std::atomic<const KernelTable*> ActiveKernels;
+
+    inline const KernelTable& GetKernels() {
+        return *ActiveKernels.load(std::memory_order_relaxed);
+    }
+
+    // Best variant this CPU and operating system can run
+    KernelVariant GetSupportedKernelVariant();
+    KernelVariant GetKernelVariant();
+    // Runs the kernels of InVariant, or of the best supported variant below it, and returns the variant selected
+    KernelVariant SelectKernels(KernelVariant InVariant);
+    // "scalar", "sse2", "avx2" or "avx512"
+    const char* GetKernelVariantName(KernelVariant InVariant);
+}
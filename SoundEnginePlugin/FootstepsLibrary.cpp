@@ -18,9 +18,87 @@
 *
 */
 #include "FootstepsLibrary.h"
+#include <atomic>
+#include <cstring>
 
 namespace nemlib
 {
+    /*### MEMORY ###*/
+
+    namespace {
+        class HeapAllocator : public Allocator
+        {
+        public:
+            void* Allocate(size_t InBytes) override { return malloc(InBytes); }
+            void Free(void* InPointer) override { free(InPointer); }
+        };
+    }
+    Allocator& Allocator::Default() {
+        static HeapAllocator Heap;
+        return Heap;
+    }
+
+    Arena::~Arena() {
+        Release();
+    }
+    bool Arena::Reserve(Allocator& InBacking, size_t InBytes) {
+        if (Block == nullptr || Backing != &InBacking || Capacity < InBytes) {
+            Release();
+            Block = (unsigned char*)InBacking.Allocate(std::max(InBytes, ARENA_ALIGNMENT));
+            if (Block == nullptr) {
+                return false;
+            }
+            Backing = &InBacking;
+            Capacity = std::max(InBytes, ARENA_ALIGNMENT);
+        }
+        Used = 0;
+        Overflow = 0;
+        return true;
+    }
+    void Arena::Release() {
+        if (Block != nullptr) {
+            Backing->Free(Block);
+        }
+        Block = nullptr;
+        Capacity = 0;
+        Used = 0;
+        Overflow = 0;
+    }
+    void* Arena::Allocate(size_t InBytes) {
+        size_t Bytes = SliceBytes(InBytes);
+        if (Block != nullptr && Used + Bytes <= Capacity) {
+            void* Slice = Block + Used;
+            Used += Bytes;
+            return Slice;
+        }
+        if (Backing == nullptr) {
+            return nullptr;
+        }
+        void* Pointer = Backing->Allocate(InBytes);
+        if (Pointer != nullptr) {
+            Overflow += InBytes;
+        }
+        return Pointer;
+    }
+    void Arena::Free(void* InPointer) {
+        unsigned char* Pointer = (unsigned char*)InPointer;
+        if (Pointer != nullptr && (Pointer < Block || Pointer >= Block + Capacity)) {
+            Backing->Free(InPointer);
+        }
+    }
+    size_t Arena::GetCapacity() const {
+        return Capacity;
+    }
+    size_t Arena::GetUsed() const {
+        return Used;
+    }
+    size_t Arena::GetOverflow() const {
+        return Overflow;
+    }
+    size_t Arena::SliceBytes(size_t InBytes) {
+        return (InBytes + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+    }
+
     /*### UTILITIES ###*/
 
     // Function to map the range [-1.0;1.0] to ]0.0;900[
@@ -53,6 +131,20 @@ namespace nemlib
         }
         return Complete;
     }
+    int Timer::SamplesToCompletion() const {
+        if (Play == false) {
+            return -1;
+        }
+        if (Counter >= Time) {
+            return 0;
+        }
+        return (int)ceil((Time - Counter) / Inc);
+    }
+    void Timer::Advance(int InSamples) {
+        if (Play == true && InSamples > 0) {
+            Counter = std::min(Counter + (float)InSamples * Inc, std::max(Counter, Time));
+        }
+    }
 
     // A helper function from our JS implementation.
     float Rescale(float value, float newMin, float newMax, float oldMin, float oldMax) {
@@ -84,6 +176,61 @@ namespace nemlib
         return std::min(std::max(InParam, InMin), InMax);
     }
 
+    /*### RANDOM CLASS ###*/
+
+    // Default Constructor
+    Random::Random() {
+        Seed = RandomSeed();
+    }
+    // Constructor
+    Random::Random(unsigned int InSeed) {
+        Seed = InSeed;
+    }
+    void Random::SetSeed(unsigned int InSeed) {
+        Seed = InSeed;
+        Counter = 0;
+    }
+    unsigned int Random::NextUInt() {
+        // "lowbias32" integer hash of the stream position (C. Wellons)
+        unsigned int X = Seed + 0x9E3779B9u * Counter++;
+        X ^= X >> 16;
+        X *= 0x7FEB352Du;
+        X ^= X >> 15;
+        X *= 0x846CA68Bu;
+        X ^= X >> 16;
+        return X;
+    }
+    void Random::NextUIntBlock(unsigned int* OutValues, int InCount) {
+        // Every value only depends on its position, so this loop has no carried dependency and vectorizes
+        for (int i = 0; i < InCount; i++) {
+            unsigned int X = Seed + 0x9E3779B9u * (Counter + (unsigned int)i);
+            X ^= X >> 16;
+            X *= 0x7FEB352Du;
+            X ^= X >> 15;
+            X *= 0x846CA68Bu;
+            X ^= X >> 16;
+            OutValues[i] = X;
+        }
+        Counter += (unsigned int)InCount;
+    }
+    void Random::NextNoiseBlock(float* OutValues, int InCount) {
+        GetKernels().NoiseBlock(Seed, Counter, OutValues, InCount);
+        Counter += (unsigned int)InCount;
+    }
+    float Random::NextFloat() {
+        // Top 24 bits are exactly representable in a float
+        return (float)(NextUInt() >> 8) * (1.0f / 16777216.0f);
+    }
+    void Random::Skip(unsigned int InCount) {
+        Counter += InCount;
+    }
+
+    unsigned int RandomSeed() {
+        static std::atomic<unsigned int> Instances(0);
+        unsigned int InstanceNum = Instances.fetch_add(1);
+        return static_cast <unsigned> (time(0)) * 0x85EBCA6Bu + InstanceNum * 0xC2B2AE35u;
+    }
+
     /*### SINE WAVE CLASS ###*/
 
     // Sine Wave Class default constructor declaration
@@ -273,11 +420,42 @@ namespace nemlib
         SampleRate = std::max(InSampleRate, 1);
     }
 
+    void WhiteNoiseGen::SetSeed(unsigned int InSeed)
+    {
+        Rng.SetSeed(InSeed);
+        BlockPos = NOISE_BLOCK_SIZE;
+    }
+
     // Returns the value of the next sample
-    float WhiteNoiseGen::NextSample()
+    void WhiteNoiseGen::Fill(float* OutBuffer, int InNumSamples)
     {
-        float Sample = ((float(rand()) / float(RAND_MAX)) * 2.0f) - 1.0f;
-        return Sample;
+        int i = 0;
+        // Hand out what is left of the current block first to stay on the same stream
+        while (i < InNumSamples && BlockPos < NOISE_BLOCK_SIZE) {
+            OutBuffer[i++] = Block[BlockPos++];
+        }
+        // Whole blocks straight from the stream, in a single call for the kernel to run as wide as it can
+        int NumBlocked = (InNumSamples - i) / NOISE_BLOCK_SIZE * NOISE_BLOCK_SIZE;
+        Rng.NextNoiseBlock(OutBuffer + i, NumBlocked);
+        i += NumBlocked;
+        while (i < InNumSamples) {
+            OutBuffer[i++] = NextSample();
+        }
+    }
+    void WhiteNoiseGen::Skip(int InSamples)
+    {
+        int Remaining = NOISE_BLOCK_SIZE - BlockPos;
+        if (InSamples < Remaining) {
+            BlockPos += std::max(InSamples, 0);
+        }
+        else {
+            Rng.Skip((unsigned int)(InSamples - Remaining));
+            BlockPos = NOISE_BLOCK_SIZE;
+        }
+    }
+    void WhiteNoiseGen::GenerateBlock(float* OutBlock)
+    {
+        Rng.NextNoiseBlock(OutBlock, NOISE_BLOCK_SIZE);
     }
 
     /*### PINK NOISE CLASS ###*/
@@ -291,12 +469,12 @@ namespace nemlib
         B4 = 0.0f;
         B5 = 0.0f;
         B6 = 0.0f;
-        srand(static_cast <unsigned> (time(0)));
     }
     // Pink noise generator constructor declaration
     PinkNoiseGen::PinkNoiseGen(int InSampleRate)
     {
         SampleRate = std::max(InSampleRate, 1);
+        White = WhiteNoiseGen(SampleRate);
         B0 = 0.0f;
         B1 = 0.0f;
         B2 = 0.0f;
@@ -304,13 +482,17 @@ namespace nemlib
         B4 = 0.0f;
         B5 = 0.0f;
         B6 = 0.0f;
-        srand(static_cast <unsigned> (time(0)));
+    }
+
+    void PinkNoiseGen::SetSeed(unsigned int InSeed)
+    {
+        White.SetSeed(InSeed);
     }
 
     // Returns the value of the next sample
     float PinkNoiseGen::NextSample()
     {
-        float Sample = ((float(rand()) / float(RAND_MAX)) * 2.0f) - 1.0f;
+        float Sample = White.NextSample();
         B0 = 0.99886f * B0 + Sample * 0.0555179f;
         B1 = 0.99332f * B1 + Sample * 0.0750759f;
         B2 = 0.96900f * B2 + Sample * 0.1538520f;
@@ -321,6 +503,34 @@ namespace nemlib
         B6 = Sample * 0.115926f;
         return 0.11f * Output;
     }
+    void PinkNoiseGen::Fill(float* OutBuffer, int InNumSamples)
+    {
+        // Filter state stays in registers for the whole buffer instead of going through the members every sample
+        float S0 = B0, S1 = B1, S2 = B2, S3 = B3, S4 = B4, S5 = B5, S6 = B6;
+        for (int Start = 0; Start < InNumSamples; Start += NOISE_BLOCK_SIZE) {
+            int Count = std::min(NOISE_BLOCK_SIZE, InNumSamples - Start);
+            White.Fill(WhiteBlock, Count);
+            for (int i = 0; i < Count; i++) {
+                float Sample = WhiteBlock[i];
+                S0 = 0.99886f * S0 + Sample * 0.0555179f;
+                S1 = 0.99332f * S1 + Sample * 0.0750759f;
+                S2 = 0.96900f * S2 + Sample * 0.1538520f;
+                S3 = 0.86650f * S3 + Sample * 0.3104856f;
+                S4 = 0.55000f * S4 + Sample * 0.5329522f;
+                S5 = -0.7616f * S5 - Sample * 0.0168980f;
+                float Output = S0 + S1 + S2 + S3 + S4 + S5 + S6 + Sample * 0.5362f;
+                S6 = Sample * 0.115926f;
+                OutBuffer[Start + i] = 0.11f * Output;
+            }
+        }
+        B0 = S0;
+        B1 = S1;
+        B2 = S2;
+        B3 = S3;
+        B4 = S4;
+        B5 = S5;
+        B6 = S6;
+    }
 
     /*### PHASOR GENERATOR CLASS ###*/
 
@@ -921,13 +1131,16 @@ namespace nemlib
         Type = InType;
         ComputeCoeff();
     }
-    float BiquadFilter::ProcessSample(float InSample) {
-        float out = ((InSample * B0) + (X1 * B1) + (X2 * B2) - (Y1 * A1) - (Y2 * A2)) / A0;
-        Y2 = Y1;
-        Y1 = out;
-        X2 = X1;
-        X1 = InSample;
-        return out;
+    void BiquadFilter::SetCoefficients(const BiquadCoefficients& InCoefficients) {
+        B0 = InCoefficients.B0;
+        B1 = InCoefficients.B1;
+        B2 = InCoefficients.B2;
+        A0 = InCoefficients.A0;
+        A1 = InCoefficients.A1;
+        A2 = InCoefficients.A2;
+    }
+    BiquadCoefficients BiquadFilter::GetCoefficients() const {
+        return { B0, B1, B2, A0, A1, A2 };
     }
     void BiquadFilter::ComputeCoeff(void) {
         float Wc = cos(W);
@@ -1355,49 +1568,52 @@ namespace nemlib
     /*### DELAY ###*/
 
     const float MAX_DELAY_TIME = 5.0f;
-    const int MAX_DELAY_TIME_INT = (int)MAX_DELAY_TIME;
-    // Default Constructor
+    // Default Constructor, no buffer until a constructed delay is assigned
     Delay::Delay() {
         SampleRate = 48000;
-        DelayTime = 1.0f;
-        DelayBuffer.resize(MAX_DELAY_TIME_INT * SampleRate, 0.0f);
-        ReadPointer = (int)((MAX_DELAY_TIME - DelayTime) * (float)SampleRate) - 1;
-        WritePointer = 0;
+        DelayTime = 0.0f;
     }
     // Delay class constructor declaration
-    Delay::Delay(int InSampleRate, float InDelayTime) {
-        SampleRate = InSampleRate;
-        DelayTime = nemlib::Clamp(InDelayTime, 0.0f, MAX_DELAY_TIME - 1.0f / (float)SampleRate);
-        DelayBuffer.resize(MAX_DELAY_TIME_INT * SampleRate, 0.0f);
-        ReadPointer = (int)((MAX_DELAY_TIME - DelayTime) * (float)SampleRate) - 1;
+    Delay::Delay(int InSampleRate, float InDelayTime) : Delay(InSampleRate, InDelayTime, MAX_DELAY_TIME) {}
+    Delay::Delay(int InSampleRate, float InDelayTime, float InMaxDelayTime, Allocator& InAllocator) {
+        SampleRate = std::max(InSampleRate, 1);
+        int Size = GetBufferSize(SampleRate, InMaxDelayTime);
+        BufferSize = DelayBuffer.Allocate(Size, InAllocator) ? Size : 0;
+        float MaxTime = (float)BufferSize / (float)SampleRate;
+        DelayTime = nemlib::Clamp(InDelayTime, 0.0f, MaxTime - 1.0f / (float)SampleRate);
+        ReadPointer = (int)((MaxTime - DelayTime) * (float)SampleRate) - 1;
         WritePointer = 0;
     }
+    int Delay::GetBufferSize(int InSampleRate, float InMaxDelayTime) {
+        float MaxTime = nemlib::Clamp(InMaxDelayTime, 0.0f, MAX_DELAY_TIME);
+        return std::max((int)ceilf(MaxTime * (float)InSampleRate), 2);
+    }
+    size_t Delay::GetRequiredBytes(int InSampleRate, float InMaxDelayTime) {
+        return Arena::SliceBytes((size_t)GetBufferSize(std::max(InSampleRate, 1), InMaxDelayTime) * sizeof(float));
+    }
+    bool Delay::IsAllocated() const {
+        return BufferSize > 0;
+    }
+    size_t Delay::GetMemoryBytes() const {
+        return DelayBuffer.GetBytes();
+    }
     void Delay::SetDelay(float InDelayTime) {
-        DelayTime = nemlib::Clamp(InDelayTime, 0.0f, MAX_DELAY_TIME - 1.0f / (float)SampleRate);
+        DelayTime = nemlib::Clamp(InDelayTime, 0.0f, (float)(BufferSize - 1) / (float)SampleRate);
         ReadPointer = WritePointer - (int)(DelayTime * (float)SampleRate);
         while (ReadPointer < 0) {
-            ReadPointer += MAX_DELAY_TIME_INT * SampleRate;
+            ReadPointer += BufferSize;
         }
-        while (ReadPointer >= MAX_DELAY_TIME_INT * SampleRate) {
+        while (ReadPointer >= BufferSize) {
             ReadPointer--;
         }
     }
-    float Delay::ProcessSample(float InSample) {
-        // Get delayed output
-        float Output = DelayBuffer[ReadPointer];
-        // Updated buffer
-        DelayBuffer[WritePointer] = InSample;
-        // Increment pointers
-        ReadPointer++;
-        WritePointer++;
-        // Wrap pointers
-        if (ReadPointer >= MAX_DELAY_TIME_INT * SampleRate) {
-            ReadPointer = 0;
-        }
-        if (WritePointer >= MAX_DELAY_TIME_INT * SampleRate) {
-            WritePointer = 0;
+    void Delay::Clear(float InTime) {
+        int NumSamples = std::min((int)(InTime * (float)SampleRate), BufferSize);
+        int Position = WritePointer;
+        for (int i = 0; i < NumSamples; i++) {
+            Position = Position > 0 ? Position - 1 : BufferSize - 1;
+            DelayBuffer[Position] = 0.0f;
         }
-        return Output;
     }
 
     /*### FEEDBACK DELAY ###*/
@@ -1566,53 +1782,148 @@ namespace nemlib
         float Random = float(rand()) / float(RAND_MAX);
         return InValue * (1.0f + InAmount * (2.0f * Random - 1.0f));
     }
+    float Vary(float InValue, float InAmount, Random& InRandom) {
+        float RandomValue = InRandom.NextFloat();
+        return InValue * (1.0f + InAmount * (2.0f * RandomValue - 1.0f));
+    }
+
+    void BlendModes(const Mode& InFrom, const Mode& InTo, float InAmount, Mode& OutMode) {
+        float Amount = Clamp(InAmount, 0.0f, 1.0f);
+        int FromModes = std::min(std::max(InFrom.nModes, 0), MAX_FILTERBANK_FILTERS);
+        int ToModes = std::min(std::max(InTo.nModes, 0), MAX_FILTERBANK_FILTERS);
+        OutMode.nModes = std::max(FromModes, ToModes);
+        for (int i = 0; i < OutMode.nModes; i++) {
+            bool HasFrom = i < FromModes;
+            bool HasTo = i < ToModes;
+            if (HasFrom && HasTo && InFrom.Types[i] == InTo.Types[i]) {
+                OutMode.Types[i] = InFrom.Types[i];
+                OutMode.Freqs[i] = InFrom.Freqs[i] * powf(InTo.Freqs[i] / InFrom.Freqs[i], Amount);
+                OutMode.Qs[i] = InFrom.Qs[i] + (InTo.Qs[i] - InFrom.Qs[i]) * Amount;
+                OutMode.Gains[i] = InFrom.Gains[i] + (InTo.Gains[i] - InFrom.Gains[i]) * Amount;
+            }
+            else {
+                bool UseFrom = HasFrom && (!HasTo || Amount < 0.5f);
+                const Mode& Source = UseFrom ? InFrom : InTo;
+                OutMode.Types[i] = Source.Types[i];
+                OutMode.Freqs[i] = Source.Freqs[i];
+                OutMode.Qs[i] = Source.Qs[i];
+                OutMode.Gains[i] = Source.Gains[i] * (UseFrom ? 1.0f - Amount : Amount);
+            }
+        }
+    }
 
     /*### FILTER BANK ###*/
     FilterBank::FilterBank() {
         SampleRate = 48000;
         MuteGain = 1.0f;
-        for (int i = 0; i < 9; i++) {
-            BiquadFilter Filter = BiquadFilter(SampleRate, 200.0f, 1.0f, 0.0f, 2);
-            Filters.push_back(Filter);
-            FilterBandGains.push_back(1.0f);
+        NumFilters = MAX_FILTERBANK_FILTERS;
+        // Lanes past the filters stay silent, with a unit A0 so the kernels never divide by zero
+        memset(&Lanes, 0, sizeof(Lanes));
+        std::fill(Lanes.A0, Lanes.A0 + FILTERBANK_LANES, 1.0f);
+        for (int i = 0; i < NumFilters; i++) {
+            Filters[i] = BiquadFilter(SampleRate, 200.0f, 1.0f, 0.0f, 2);
+            StoreCoefficients(i);
+            Lanes.Gains[i] = 1.0f;
         }
+        NumModes = NumFilters;
+        MaxActive = MAX_FILTERBANK_FILTERS;
+        NumActive = NumFilters;
         srand(static_cast <unsigned> (time(0)));
         OutputMult = 0.0f;
     }
     FilterBank::FilterBank(int InSampleRate, int InNumFilters) {
         SampleRate = std::max(InSampleRate, 1);
         MuteGain = 1.0f;
-        for (int i = 0; i < InNumFilters; i++) {
-            BiquadFilter Filter = BiquadFilter(SampleRate, 200.0f, 1.0f, 0.0f, 2);
-            Filters.push_back(Filter);
-            FilterBandGains.push_back(1.0f);
+        NumFilters = std::min(std::max(InNumFilters, 0), MAX_FILTERBANK_FILTERS);
+        // Lanes past the filters stay silent, with a unit A0 so the kernels never divide by zero
+        memset(&Lanes, 0, sizeof(Lanes));
+        std::fill(Lanes.A0, Lanes.A0 + FILTERBANK_LANES, 1.0f);
+        for (int i = 0; i < NumFilters; i++) {
+            Filters[i] = BiquadFilter(SampleRate, 200.0f, 1.0f, 0.0f, 2);
+            StoreCoefficients(i);
+            Lanes.Gains[i] = 1.0f;
         }
+        NumModes = NumFilters;
+        MaxActive = MAX_FILTERBANK_FILTERS;
+        NumActive = NumFilters;
         srand(static_cast <unsigned> (time(0)));
         OutputMult = 0.0f;
     }
-    void FilterBank::InitialiseFilterBank(Mode InFilterInfo) {
-        for (int i = 0; i < InFilterInfo.nModes; i++) {
-            Filters[i].ResetFilter();
+    void FilterBank::InitialiseFilterBank(const Mode& InFilterInfo) {
+        int NumModes = std::min(InFilterInfo.nModes, NumFilters);
+        for (int i = 0; i < NumModes; i++) {
+            ClearMemories(i);
             Filters[i].SetType(InFilterInfo.Types[i]);
             Filters[i].SetFrequency(InFilterInfo.Freqs[i]);
             Filters[i].SetQFactor(InFilterInfo.Qs[i]);
-            FilterBandGains[i] = InFilterInfo.Gains[i];
+            StoreCoefficients(i);
+            Lanes.Gains[i] = InFilterInfo.Gains[i];
         }
-        for (int i = InFilterInfo.nModes; i < 9; i++) {
-            FilterBandGains[i] = 0.0f;
+        for (int i = NumModes; i < NumFilters; i++) {
+            Lanes.Gains[i] = 0.0f;
         }
+        this->NumModes = NumModes;
+        UpdateActiveFilters();
         OutputMult = 0.0f;
     }
-    void FilterBank::VaryParameters(Mode InFilterInfo) {
-        for (int i = 0; i < InFilterInfo.nModes; i++) {
+    void FilterBank::MorphFilterBank(const Mode& InFilterInfo) {
+        int NewNumModes = std::min(InFilterInfo.nModes, NumFilters);
+        for (int i = 0; i < NewNumModes; i++) {
+            if (i >= NumModes) {
+                ClearMemories(i);
+            }
+            Filters[i].SetType(InFilterInfo.Types[i]);
+            Filters[i].SetFrequency(InFilterInfo.Freqs[i]);
+            Filters[i].SetQFactor(InFilterInfo.Qs[i]);
+            StoreCoefficients(i);
+            Lanes.Gains[i] = InFilterInfo.Gains[i];
+        }
+        for (int i = NewNumModes; i < NumFilters; i++) {
+            Lanes.Gains[i] = 0.0f;
+        }
+        NumModes = NewNumModes;
+        UpdateActiveFilters();
+    }
+    void FilterBank::VaryParameters(const Mode& InFilterInfo) {
+        int NumModes = std::min(InFilterInfo.nModes, NumFilters);
+        for (int i = 0; i < NumModes; i++) {
             Filters[i].SetFrequency(Vary(InFilterInfo.Freqs[i], 0.2f));
             Filters[i].SetQFactor(Vary(InFilterInfo.Qs[i], 0.3f));
-            FilterBandGains[i] = Vary(InFilterInfo.Gains[i], 0.3f);
+            StoreCoefficients(i);
+            Lanes.Gains[i] = Vary(InFilterInfo.Gains[i], 0.3f);
+        }
+    }
+    void FilterBank::VaryParameters(const Mode& InFilterInfo, Random& InRandom) {
+        int NumModes = std::min(InFilterInfo.nModes, NumFilters);
+        for (int i = 0; i < NumModes; i++) {
+            Filters[i].SetFrequency(Vary(InFilterInfo.Freqs[i], 0.2f, InRandom));
+            Filters[i].SetQFactor(Vary(InFilterInfo.Qs[i], 0.3f, InRandom));
+            StoreCoefficients(i);
+            Lanes.Gains[i] = Vary(InFilterInfo.Gains[i], 0.3f, InRandom);
+        }
+    }
+    void FilterBank::ComputeVariation(const Mode& InFilterInfo, Random& InRandom, FilterBankVariation& OutVariation) const {
+        int NumModes = std::min(InFilterInfo.nModes, NumFilters);
+        for (int i = 0; i < NumModes; i++) {
+            // Drawn in the order VaryParameters draws them
+            float Frequency = Vary(InFilterInfo.Freqs[i], 0.2f, InRandom);
+            float QFactor = Vary(InFilterInfo.Qs[i], 0.3f, InRandom);
+            OutVariation.Coefficients[i] = BiquadFilter(SampleRate, Frequency, QFactor, 0.0f, InFilterInfo.Types[i]).GetCoefficients();
+            OutVariation.Gains[i] = Vary(InFilterInfo.Gains[i], 0.3f, InRandom);
+        }
+        OutVariation.nModes = NumModes;
+    }
+    void FilterBank::ApplyVariation(const FilterBankVariation& InVariation) {
+        int NumModes = std::min(InVariation.nModes, NumFilters);
+        for (int i = 0; i < NumModes; i++) {
+            Filters[i].SetCoefficients(InVariation.Coefficients[i]);
+            StoreCoefficients(i);
+            Lanes.Gains[i] = InVariation.Gains[i];
         }
     }
     void FilterBank::ResetFilter() {
-        for (int i = 0; i < (int)Filters.size(); i++) {
-            FilterBandGains[i] = 0.0f;
+        for (int i = 0; i < NumFilters; i++) {
+            Lanes.Gains[i] = 0.0f;
         }
     }
     void FilterBank::Mute() {
@@ -1624,15 +1935,38 @@ namespace nemlib
     void FilterBank::Unmute(float InGain) {
         MuteGain = InGain;
     }
-    float FilterBank::ProcessSample(float InSample) {
-        float Output = 0.0f;
-        if (OutputMult < 1.0f) {
-            OutputMult += 1.0f / (0.01f * (float)SampleRate);
+    void FilterBank::FadeIn() {
+        for (int i = 0; i < NumFilters; i++) {
+            ClearMemories(i);
         }
-        for (int i = 0; i < (int)Filters.size(); i++) {
-            Output += Filters[i].ProcessSample(InSample) * FilterBandGains[i];
+        OutputMult = 0.0f;
+    }
+    void FilterBank::SetMaxActiveFilters(int InMaxFilters) {
+        MaxActive = std::max(InMaxFilters, 1);
+        UpdateActiveFilters();
+    }
+    void FilterBank::UpdateActiveFilters() {
+        // Filters that were skipped still hold the signal from before, they restart silent
+        int NewNumActive = std::min(NumModes, MaxActive);
+        for (int i = NumActive; i < NewNumActive; i++) {
+            ClearMemories(i);
         }
-        return Output * MuteGain * OutputMult * OutputMult;
+        NumActive = NewNumActive;
+    }
+    void FilterBank::StoreCoefficients(int InIndex) {
+        BiquadCoefficients Coefficients = Filters[InIndex].GetCoefficients();
+        Lanes.B0[InIndex] = Coefficients.B0;
+        Lanes.B1[InIndex] = Coefficients.B1;
+        Lanes.B2[InIndex] = Coefficients.B2;
+        Lanes.A0[InIndex] = Coefficients.A0;
+        Lanes.A1[InIndex] = Coefficients.A1;
+        Lanes.A2[InIndex] = Coefficients.A2;
+    }
+    void FilterBank::ClearMemories(int InIndex) {
+        Lanes.X1[InIndex] = 0.0f;
+        Lanes.X2[InIndex] = 0.0f;
+        Lanes.Y1[InIndex] = 0.0f;
+        Lanes.Y2[InIndex] = 0.0f;
     }
 
     /*### CURVE ENVELOPE ###*/
@@ -1641,8 +1975,7 @@ namespace nemlib
         EnvPosInc = 1.0f / 48000.0f;
         EnvPos = 0.0f;
         HasStarted = false;
-        Values = { 0.0f, 1.0f, 0.0f };
-        NumOfValues = 3;
+        StoreValues(nullptr, 0);
         Time = 0.5f;
         Counter = 1;
         Boundary = Time / (float)NumOfValues;
@@ -1652,14 +1985,7 @@ namespace nemlib
         EnvPosInc = 1.0f / (float)SampleRate;
         EnvPos = 0.0f;
         HasStarted = false;
-        if (InValues.size() < 2) {
-            Values = { 0.0f, 1.0f, 0.0f };
-            NumOfValues = 3;
-        }
-        else {
-            Values = InValues;
-            NumOfValues = (int)Values.size();
-        }
+        StoreValues(InValues.data(), (int)InValues.size());
         Time = std::max(InTime, 3.0f * (float)(NumOfValues / SampleRate));
         Counter = 1;
         Boundary = Time / (float)NumOfValues;
@@ -1669,58 +1995,69 @@ namespace nemlib
         EnvPosInc = 1.0f / (float)SampleRate;
         EnvPos = 0.0f;
         HasStarted = false;
-        if ((int)InValues.size() < 2) {
-            Values = { 0.0f, 1.0f, 0.0f };
+        StoreValues(InValues.data(), (int)InValues.size());
+        StoreTimes(InTimes.data(), (int)InTimes.size());
+        Counter = 1;
+        if (NumOfTimes == 0) {
+            Boundary = Time / (float)NumOfValues;
+        }
+        else {
+            Boundary = Times[0];
+        }
+    }
+    void CurveEnvelope::StoreValues(const float* InValues, int InNumValues) {
+        if (InNumValues < 2) {
+            Values[0] = 0.0f;
+            Values[1] = 1.0f;
+            Values[2] = 0.0f;
             NumOfValues = 3;
         }
         else {
-            Values = InValues;
-            NumOfValues = (int)Values.size();
+            NumOfValues = std::min(InNumValues, MAX_ENVELOPE_POINTS);
+            std::copy(InValues, InValues + NumOfValues, Values);
         }
-        if ((int)InTimes.size() == NumOfValues - 1) {
-            Times = InTimes;
+    }
+    void CurveEnvelope::StoreTimes(const float* InTimes, int InNumTimes) {
+        if (InNumTimes == NumOfValues - 1) {
+            NumOfTimes = InNumTimes;
             Time = 0.0f;
-            for (int i = 0; i < (int)Times.size(); i++) {
+            for (int i = 0; i < NumOfTimes; i++) {
+                Times[i] = InTimes[i];
                 Time += Times[i];
             }
         }
         else {
-            Times = std::vector<float>();
+            NumOfTimes = 0;
             Time = 0.5f;
         }
-        Counter = 1;
-        Boundary = Times[0];
     }
-    void CurveEnvelope::SetValues(std::vector<float> InValues) {
-        if (InValues.size() < 2) {
-            Values = { 0.0f, 1.0f, 0.0f };
-            NumOfValues = 3;
-        }
-        else {
-            Values = InValues;
-            NumOfValues = (int)Values.size();
-        }
+    void CurveEnvelope::SetValues(std::initializer_list<float> InValues) {
+        StoreValues(InValues.begin(), (int)InValues.size());
         Time = std::max(Time, 3.0f * (float)(NumOfValues / SampleRate));
         ResetEnvelope();
     }
     void CurveEnvelope::SetTime(float InTime) { Time = std::max(InTime, 3.0f * (float)(NumOfValues / SampleRate)); }
-    void CurveEnvelope::SetTimes(std::vector<float> InTimes) {
-        if ((int)InTimes.size() == NumOfValues - 1) {
-            Times = InTimes;
-            Time = 0.0f;
-            for (int i = 0; i < (int)Times.size(); i++) {
-                Time += Times[i];
-            }
+    void CurveEnvelope::SetTimes(std::initializer_list<float> InTimes) {
+        StoreTimes(InTimes.begin(), (int)InTimes.size());
+    }
+    float CurveEnvelope::GetNextEnvelopePoint() {
+        if (Resolution <= 1) {
+            return EvaluateNextPoint();
         }
-        else {
-            Times = std::vector<float>();
-            Time = 0.5f;
+        if (RampPoints == 0) {
+            // Ramp to the point at the end of the next Resolution points
+            Advance(Resolution - 1);
+            RampIncrement = (EvaluateNextPoint() - RampValue) / (float)Resolution;
+            RampPoints = Resolution;
         }
+        RampValue += RampIncrement;
+        RampPoints--;
+        return RampValue;
     }
-    float CurveEnvelope::GetNextEnvelopePoint() {
+    float CurveEnvelope::EvaluateNextPoint() {
         float EnvReturnValue = Values[0];
         if (HasStarted == true) {
-            if (Times.empty()) {
+            if (NumOfTimes == 0) {
                 if (Counter <= NumOfValues - 1) {
                     if (EnvPos <= Boundary) {
                         EnvReturnValue = Values[Counter] + (EnvPos - Boundary) * (float)NumOfValues * (Values[Counter] - Values[Counter - 1]) / Time;
@@ -1732,7 +2069,7 @@ namespace nemlib
                             EnvReturnValue = Values[Counter] + (EnvPos - Boundary) * (float)NumOfValues * (Values[Counter] - Values[Counter - 1]) / Time;
                         }
                         else {
-                            EnvReturnValue = Values.back();
+                            EnvReturnValue = Values[NumOfValues - 1];
                         }
                     }
                     if (EnvPos <= Time) {
@@ -1740,7 +2077,7 @@ namespace nemlib
                     }
                 }
                 else {
-                    EnvReturnValue = Values.back();
+                    EnvReturnValue = Values[NumOfValues - 1];
                 }
             }
             else {
@@ -1750,12 +2087,12 @@ namespace nemlib
                     }
                     else {
                         Counter++;
-                        Boundary += Times[Counter - 1];
                         if (Counter <= NumOfValues - 1) {
+                            Boundary += Times[Counter - 1];
                             EnvReturnValue = Values[Counter] + (EnvPos - Boundary) * (Values[Counter] - Values[Counter - 1]) / Times[Counter - 1];
                         }
                         else {
-                            EnvReturnValue = Values.back();
+                            EnvReturnValue = Values[NumOfValues - 1];
                         }
                     }
                     if (EnvPos <= Time) {
@@ -1763,7 +2100,7 @@ namespace nemlib
                     }
                 }
                 else {
-                    EnvReturnValue = Values.back();
+                    EnvReturnValue = Values[NumOfValues - 1];
                 }
             }
         }
@@ -1773,11 +2110,424 @@ namespace nemlib
         EnvPos = 0.0f;
         HasStarted = true;
         Counter = 1;
-        if (Times.empty()) {
+        RampPoints = 0;
+        if (NumOfTimes == 0) {
             Boundary = Time / (float)NumOfValues;
         }
         else {
             Boundary = Times[0];
         }
     }
+    bool CurveEnvelope::IsActive() const {
+        return HasStarted && Counter <= NumOfValues - 1;
+    }
+    void CurveEnvelope::SetResolution(int InSamples) {
+        Resolution = std::max(InSamples, 1);
+        RampPoints = 0;
+    }
+    void CurveEnvelope::Advance(int InSamples) {
+        if (HasStarted == false || InSamples <= 0) {
+            return;
+        }
+        // GetNextEnvelopePoint stops moving once past the end, so does this
+        EnvPos = std::min(EnvPos + (float)InSamples * EnvPosInc, std::max(EnvPos, Time + EnvPosInc));
+        while (Counter <= NumOfValues - 1 && EnvPos > Boundary) {
+            Counter++;
+            if (Counter <= NumOfValues - 1) {
+                Boundary += NumOfTimes == 0 ? Time / (float)NumOfValues : Times[Counter - 1];
+            }
+        }
+    }
+
+    /*### CONTROL CURVE ###*/
+    ControlCurve::ControlCurve() {
+        for (int i = 0; i < MAX_CURVE_POINTS; i++) {
+            Values[i] = 0.0f;
+            Times[i] = 0.0f;
+        }
+        Values[MAX_CURVE_POINTS] = 0.0f;
+    }
+    void ControlCurve::Start(float InFrom, const float* InValues, const float* InTimes, int InNumPoints) {
+        NumPoints = Clamp(InNumPoints, 0, MAX_CURVE_POINTS);
+        Values[0] = InFrom;
+        for (int i = 0; i < NumPoints; i++) {
+            Values[i + 1] = InValues[i];
+            Times[i] = std::max(InTimes[i], 0.0f);
+        }
+        Segment = 0;
+        SegmentPos = 0.0f;
+    }
+    void ControlCurve::Stop() {
+        NumPoints = 0;
+    }
+    bool ControlCurve::IsActive() const {
+        return Segment < NumPoints;
+    }
+    float ControlCurve::Advance(float InSeconds) {
+        if (Segment >= NumPoints) {
+            return Values[NumPoints];
+        }
+        SegmentPos += std::max(InSeconds, 0.0f);
+        while (Segment < NumPoints && SegmentPos >= Times[Segment]) {
+            SegmentPos -= Times[Segment];
+            Segment++;
+        }
+        if (Segment >= NumPoints) {
+            return Values[NumPoints];
+        }
+        return Values[Segment] + (Values[Segment + 1] - Values[Segment]) * SegmentPos / Times[Segment];
+    }
+
+    /*### GRAIN PLAYER ###*/
+    GrainPlayer::GrainPlayer() {
+        for (int i = 0; i < MAX_GRAIN_VOICES; i++) {
+            Samples[i] = nullptr;
+            Lengths[i] = 0;
+            Positions[i] = 0;
+            Gains[i] = 0.0f;
+        }
+        NumActive = 0;
+    }
+    void GrainPlayer::Trigger(const float* InSamples, int InLength, float InGain) {
+        if (InSamples == nullptr || InLength <= 0) {
+            return;
+        }
+        int Voice = NumActive;
+        if (NumActive < MAX_GRAIN_VOICES) {
+            NumActive++;
+        }
+        else {
+            // Every voice is busy, steal the one with the least left to play
+            Voice = 0;
+            for (int i = 1; i < MAX_GRAIN_VOICES; i++) {
+                if (Lengths[i] - Positions[i] < Lengths[Voice] - Positions[Voice]) {
+                    Voice = i;
+                }
+            }
+        }
+        Samples[Voice] = InSamples;
+        Lengths[Voice] = InLength;
+        Positions[Voice] = 0;
+        Gains[Voice] = InGain;
+    }
+    void GrainPlayer::Stop() {
+        NumActive = 0;
+    }
+    bool GrainPlayer::IsPlaying() const {
+        return NumActive > 0;
+    }
+    float GrainPlayer::ProcessSample() {
+        float Output = 0.0f;
+        int i = 0;
+        while (i < NumActive) {
+            Output += Gains[i] * Samples[i][Positions[i]];
+            if (++Positions[i] < Lengths[i]) {
+                i++;
+                continue;
+            }
+            // Finished, keep the active grains packed at the front
+            NumActive--;
+            Samples[i] = Samples[NumActive];
+            Lengths[i] = Lengths[NumActive];
+            Positions[i] = Positions[NumActive];
+            Gains[i] = Gains[NumActive];
+        }
+        return Output;
+    }
+
+    /*### REAL FFT ###*/
+    RealFFT::RealFFT() {
+    }
+    RealFFT::RealFFT(int InSize, Allocator& InAllocator) {
+        SetSize(InSize, InAllocator);
+    }
+    bool RealFFT::SetSize(int InSize, Allocator& InAllocator) {
+        if (InSize == Size) {
+            return true;
+        }
+        Size = std::max(InSize, 4);
+        int HalfSize = Size / 2;
+        if (!Twiddles.Allocate(Size, InAllocator) || !BitReverse.Allocate(HalfSize, InAllocator) || !Work.Allocate(Size, InAllocator)) {
+            Twiddles.Release();
+            BitReverse.Release();
+            Work.Release();
+            Size = 0;
+            return false;
+        }
+        for (int k = 0; k < HalfSize; k++) {
+            double Angle = 2.0 * NEM_PI * (double)k / (double)Size;
+            Twiddles[2 * k] = (float)std::cos(Angle);
+            Twiddles[2 * k + 1] = (float)std::sin(Angle);
+        }
+        int Bits = 0;
+        while ((1 << Bits) < HalfSize) {
+            Bits++;
+        }
+        for (int i = 0; i < HalfSize; i++) {
+            int Reversed = 0;
+            for (int b = 0; b < Bits; b++) {
+                Reversed |= ((i >> b) & 1) << (Bits - 1 - b);
+            }
+            BitReverse[i] = Reversed;
+        }
+        return true;
+    }
+    int RealFFT::GetSize() const {
+        return Size;
+    }
+    size_t RealFFT::GetMemoryBytes() const {
+        return Twiddles.GetBytes() + BitReverse.GetBytes() + Work.GetBytes();
+    }
+    size_t RealFFT::GetRequiredBytes(int InSize) {
+        InSize = std::max(InSize, 4);
+        return Arena::SliceBytes((size_t)InSize * sizeof(float)) + Arena::SliceBytes((size_t)(InSize / 2) * sizeof(int))
+            + Arena::SliceBytes((size_t)InSize * sizeof(float));
+    }
+    void RealFFT::Transform(float* InOutData, bool InInverse) {
+        int HalfSize = Size / 2;
+        for (int i = 0; i < HalfSize; i++) {
+            int j = BitReverse[i];
+            if (j > i) {
+                std::swap(InOutData[2 * i], InOutData[2 * j]);
+                std::swap(InOutData[2 * i + 1], InOutData[2 * j + 1]);
+            }
+        }
+        float Sign = InInverse ? 1.0f : -1.0f;
+        for (int Length = 2; Length <= HalfSize; Length <<= 1) {
+            int Half = Length / 2;
+            int Step = Size / Length;
+            for (int i = 0; i < HalfSize; i += Length) {
+                for (int j = 0; j < Half; j++) {
+                    float Wr = Twiddles[2 * j * Step];
+                    float Wi = Sign * Twiddles[2 * j * Step + 1];
+                    float* A = &InOutData[2 * (i + j)];
+                    float* B = &InOutData[2 * (i + j + Half)];
+                    float Vr = B[0] * Wr - B[1] * Wi;
+                    float Vi = B[0] * Wi + B[1] * Wr;
+                    B[0] = A[0] - Vr;
+                    B[1] = A[1] - Vi;
+                    A[0] += Vr;
+                    A[1] += Vi;
+                }
+            }
+        }
+    }
+    void RealFFT::Forward(const float* InSamples, float* OutSpectrum) {
+        // Even samples as real parts and odd samples as imaginary parts, then split the two spectra apart
+        int HalfSize = Size / 2;
+        std::copy(InSamples, InSamples + Size, Work.begin());
+        Transform(Work.Data(), false);
+        for (int k = 0; k < HalfSize; k++) {
+            int m = (HalfSize - k) % HalfSize;
+            float Zr = Work[2 * k];
+            float Zi = Work[2 * k + 1];
+            float Cr = Work[2 * m];
+            float Ci = -Work[2 * m + 1];
+            float Er = 0.5f * (Zr + Cr);
+            float Ei = 0.5f * (Zi + Ci);
+            float Or = 0.5f * (Zi - Ci);
+            float Oi = -0.5f * (Zr - Cr);
+            float Wr = Twiddles[2 * k];
+            float Wi = -Twiddles[2 * k + 1];
+            OutSpectrum[2 * k] = Er + Wr * Or - Wi * Oi;
+            OutSpectrum[2 * k + 1] = Ei + Wr * Oi + Wi * Or;
+        }
+        OutSpectrum[Size] = Work[0] - Work[1];
+        OutSpectrum[Size + 1] = 0.0f;
+    }
+    void RealFFT::Inverse(const float* InSpectrum, float* OutSamples) {
+        int HalfSize = Size / 2;
+        for (int k = 0; k < HalfSize; k++) {
+            float Xr = InSpectrum[2 * k];
+            float Xi = InSpectrum[2 * k + 1];
+            float Cr = InSpectrum[2 * (HalfSize - k)];
+            float Ci = -InSpectrum[2 * (HalfSize - k) + 1];
+            float Er = 0.5f * (Xr + Cr);
+            float Ei = 0.5f * (Xi + Ci);
+            float Tr = 0.5f * (Xr - Cr);
+            float Ti = 0.5f * (Xi - Ci);
+            float Wr = Twiddles[2 * k];
+            float Wi = -Twiddles[2 * k + 1];
+            float Or = Tr * Wr + Ti * Wi;
+            float Oi = Ti * Wr - Tr * Wi;
+            Work[2 * k] = Er - Oi;
+            Work[2 * k + 1] = Ei + Or;
+        }
+        Transform(Work.Data(), true);
+        float Scale = 1.0f / (float)HalfSize;
+        for (int i = 0; i < Size; i++) {
+            OutSamples[i] = Work[i] * Scale;
+        }
+    }
+
+    /*### PARTITIONED IMPULSE ###*/
+    bool PartitionedImpulse::SetImpulse(const float* InSamples, int InLength, int InBlockSize, Allocator& InAllocator) {
+        BlockSize = std::max(InBlockSize, 2);
+        NumPartitions = (std::max(InLength, 0) + BlockSize - 1) / BlockSize;
+        int BinFloats = BlockSize * 2 + 2;
+        RealFFT FFT;
+        Buffer<float> Padded;
+        if (!Spectra.Allocate(NumPartitions * BinFloats, InAllocator) || !FFT.SetSize(2 * BlockSize, InAllocator)
+            || !Padded.Allocate(2 * BlockSize, InAllocator)) {
+            Spectra.Release();
+            NumPartitions = 0;
+            return false;
+        }
+        for (int p = 0; p < NumPartitions; p++) {
+            Padded.Fill(0.0f);
+            int Start = p * BlockSize;
+            int Count = std::min(BlockSize, InLength - Start);
+            std::copy(InSamples + Start, InSamples + Start + Count, Padded.begin());
+            FFT.Forward(Padded.Data(), &Spectra[p * BinFloats]);
+        }
+        return true;
+    }
+    int PartitionedImpulse::GetBlockSize() const {
+        return BlockSize;
+    }
+    int PartitionedImpulse::GetNumPartitions() const {
+        return NumPartitions;
+    }
+    const float* PartitionedImpulse::GetPartition(int InIndex) const {
+        return &Spectra[InIndex * (BlockSize * 2 + 2)];
+    }
+
+    /*### PARTITIONED CONVOLVER ###*/
+    bool PartitionedConvolver::Prepare(int InBlockSize, int InMaxPartitions, Allocator& InAllocator) {
+        InBlockSize = std::max(InBlockSize, 2);
+        InMaxPartitions = std::max(InMaxPartitions, 1);
+        if (InBlockSize == BlockSize && InMaxPartitions == MaxPartitions) {
+            return true;
+        }
+        Release();
+        // Same order as GetRequiredBytes(), so an arena sized by it fits exactly
+        bool Allocated = FFT.SetSize(2 * InBlockSize, InAllocator)
+            && Input.Allocate(2 * InBlockSize, InAllocator)
+            && Output.Allocate(InBlockSize, InAllocator)
+            && Sum.Allocate(2 * InBlockSize + 2, InAllocator)
+            && Frame.Allocate(2 * InBlockSize, InAllocator)
+            && History.Allocate(InMaxPartitions * (2 * InBlockSize + 2), InAllocator)
+            && HistoryImpulses.Allocate(InMaxPartitions, InAllocator);
+        if (!Allocated) {
+            Release();
+            return false;
+        }
+        BlockSize = InBlockSize;
+        MaxPartitions = InMaxPartitions;
+        Reset();
+        return true;
+    }
+    void PartitionedConvolver::Release() {
+        FFT = RealFFT();
+        Input.Release();
+        Output.Release();
+        Sum.Release();
+        Frame.Release();
+        History.Release();
+        HistoryImpulses.Release();
+        Impulse = nullptr;
+        BlockSize = 0;
+        MaxPartitions = 0;
+        Head = 0;
+        Pos = 0;
+        TailBlocks = 0;
+        BlockHasInput = false;
+        PrevBlockHadInput = false;
+        OutputPending = false;
+    }
+    bool PartitionedConvolver::IsPrepared() const {
+        return BlockSize > 0;
+    }
+    size_t PartitionedConvolver::GetMemoryBytes() const {
+        return FFT.GetMemoryBytes() + Input.GetBytes() + Output.GetBytes() + Sum.GetBytes() + Frame.GetBytes()
+            + History.GetBytes() + HistoryImpulses.GetBytes();
+    }
+    size_t PartitionedConvolver::GetRequiredBytes(int InBlockSize, int InMaxPartitions) {
+        InBlockSize = std::max(InBlockSize, 2);
+        InMaxPartitions = std::max(InMaxPartitions, 1);
+        return RealFFT::GetRequiredBytes(2 * InBlockSize)
+            + Arena::SliceBytes((size_t)(2 * InBlockSize) * sizeof(float))
+            + Arena::SliceBytes((size_t)InBlockSize * sizeof(float))
+            + Arena::SliceBytes((size_t)(2 * InBlockSize + 2) * sizeof(float))
+            + Arena::SliceBytes((size_t)(2 * InBlockSize) * sizeof(float))
+            + Arena::SliceBytes((size_t)InMaxPartitions * (2 * InBlockSize + 2) * sizeof(float))
+            + Arena::SliceBytes((size_t)InMaxPartitions * sizeof(const PartitionedImpulse*));
+    }
+    void PartitionedConvolver::SetImpulse(const PartitionedImpulse* InImpulse) {
+        Impulse = (InImpulse != nullptr && InImpulse->GetBlockSize() == BlockSize) ? InImpulse : nullptr;
+    }
+    void PartitionedConvolver::Reset() {
+        Input.Fill(0.0f);
+        Output.Fill(0.0f);
+        HistoryImpulses.Fill(nullptr);
+        Head = 0;
+        Pos = 0;
+        TailBlocks = 0;
+        BlockHasInput = false;
+        PrevBlockHadInput = false;
+        OutputPending = false;
+    }
+    bool PartitionedConvolver::IsActive() const {
+        return TailBlocks > 0 || OutputPending || BlockHasInput || PrevBlockHadInput;
+    }
+    int PartitionedConvolver::GetLatency() const {
+        return BlockSize;
+    }
+    float PartitionedConvolver::ProcessSample(float InSample) {
+        if (BlockSize == 0) {
+            return 0.0f;
+        }
+        Input[BlockSize + Pos] = InSample;
+        BlockHasInput = BlockHasInput || InSample != 0.0f;
+        float OutSample = Output[Pos];
+        if (++Pos == BlockSize) {
+            Pos = 0;
+            ProcessBlock();
+        }
+        return OutSample;
+    }
+    void PartitionedConvolver::ProcessBlock() {
+        bool FrameHasInput = (BlockHasInput || PrevBlockHadInput) && Impulse != nullptr;
+        PrevBlockHadInput = BlockHasInput;
+        BlockHasInput = false;
+        if (!FrameHasInput && TailBlocks == 0) {
+            // Idle, nothing left to ring, only the last computed block may still need silencing
+            std::copy(Input.begin() + BlockSize, Input.end(), Input.begin());
+            if (OutputPending) {
+                std::fill(Output.begin(), Output.end(), 0.0f);
+                OutputPending = false;
+            }
+            return;
+        }
+
+        int BinFloats = 2 * BlockSize + 2;
+        Head = (Head + MaxPartitions - 1) % MaxPartitions;
+        HistoryImpulses[Head] = nullptr;
+        if (FrameHasInput) {
+            FFT.Forward(Input.Data(), &History[Head * BinFloats]);
+            HistoryImpulses[Head] = Impulse;
+            TailBlocks = std::max(TailBlocks, std::min(Impulse->GetNumPartitions(), MaxPartitions));
+        }
+        std::copy(Input.begin() + BlockSize, Input.end(), Input.begin());
+
+        // Frame k blocks old meets partition k of the impulse it was played into
+        std::fill(Sum.begin(), Sum.end(), 0.0f);
+        for (int k = 0; k < MaxPartitions; k++) {
+            int Slot = (Head + k) % MaxPartitions;
+            const PartitionedImpulse* SlotImpulse = HistoryImpulses[Slot];
+            if (SlotImpulse == nullptr || k >= SlotImpulse->GetNumPartitions()) {
+                continue;
+            }
+            const float* X = &History[Slot * BinFloats];
+            const float* H = SlotImpulse->GetPartition(k);
+            for (int i = 0; i < BinFloats; i += 2) {
+                Sum[i] += X[i] * H[i] - X[i + 1] * H[i + 1];
+                Sum[i + 1] += X[i] * H[i + 1] + X[i + 1] * H[i];
+            }
+        }
+        FFT.Inverse(Sum.Data(), Frame.Data());
+        std::copy(Frame.begin() + BlockSize, Frame.end(), Output.begin());
+        OutputPending = true;
+        TailBlocks--;
+    }
 }
@@ -1,171 +1,532 @@
-/*******************************************************************************
-The content of this file includes portions of the AUDIOKINETIC Wwise Technology
-released in source code form as part of the SDK installer package.
-
-Commercial License Usage
-
-Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
-may use this file in accordance with the end user license agreement provided
-with the software or, alternatively, in accordance with the terms contained in a
-written agreement between you and Audiokinetic Inc.
-
-Apache License Usage
-
-Alternatively, this file may be used under the Apache License, Version 2.0 (the
-"Apache License"); you may not use this file except in compliance with the
-Apache License. You may obtain a copy of the Apache License at
-http://www.apache.org/licenses/LICENSE-2.0.
-
-Unless required by applicable law or agreed to in writing, software distributed
-under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
-OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
-the specific language governing permissions and limitations under the License.
-
-  Copyright (c) 2021 Audiokinetic Inc.
-*******************************************************************************/
-
-#include "FootstepsSource.h"
-#include "../FootstepsConfig.h"
-
-#include <AK/AkWwiseSDKVersion.h>
-
-AK::IAkPlugin* CreateFootstepsSource(AK::IAkPluginMemAlloc* in_pAllocator)
-{
-    return AK_PLUGIN_NEW(in_pAllocator, FootstepsSource());
-}
-
-AK::IAkPluginParam* CreateFootstepsSourceParams(AK::IAkPluginMemAlloc* in_pAllocator)
-{
-    return AK_PLUGIN_NEW(in_pAllocator, FootstepsSourceParams());
-}
-
-AK_IMPLEMENT_PLUGIN_FACTORY(FootstepsSource, AkPluginTypeSource, FootstepsConfig::CompanyID, FootstepsConfig::PluginID)
-
-FootstepsSource::FootstepsSource()
-    : m_pParams(nullptr)
-    , m_pAllocator(nullptr)
-    , m_pContext(nullptr)
-{
-}
-
-FootstepsSource::~FootstepsSource()
-{
-}
-
-AKRESULT FootstepsSource::Init(AK::IAkPluginMemAlloc* in_pAllocator, AK::IAkSourcePluginContext* in_pContext, AK::IAkPluginParam* in_pParams, AkAudioFormat& in_rFormat)
-{
-    m_pParams = (FootstepsSourceParams*)in_pParams;
-    m_pAllocator = in_pAllocator;
-    m_pContext = in_pContext;
-
-    m_durationHandler.Setup(0.1f, 0, in_rFormat.uSampleRate);
-
-    //Prepare Model
-    generator.PrepareModel(in_rFormat.uSampleRate);
-    
-    return AK_Success;
-}
-
-AKRESULT FootstepsSource::Term(AK::IAkPluginMemAlloc* in_pAllocator)
-{
-    AK_PLUGIN_DELETE(in_pAllocator, this);
-    return AK_Success;
-}
-
-AKRESULT FootstepsSource::Reset()
-{
-    return AK_Success;
-}
-
-AKRESULT FootstepsSource::GetPluginInfo(AkPluginInfo& out_rPluginInfo)
-{
-    out_rPluginInfo.eType = AkPluginTypeSource;
-    out_rPluginInfo.bIsInPlace = true;
-    out_rPluginInfo.uBuildVersion = AK_WWISESDK_VERSION_COMBINED;
-    return AK_Success;
-}
-
-void FootstepsSource::Execute(AkAudioBuffer* out_pBuffer)
-{
-    //m_durationHandler.SetDuration(m_pParams->RTPC.fDuration);
-    m_durationHandler.ProduceBuffer(out_pBuffer);
-
-    const AkUInt32 uNumChannels = out_pBuffer->NumChannels();
-
-    //AkUInt16 uFramesProduced;
-
-    out_pBuffer->uValidFrames = out_pBuffer->MaxFrames();
-    m_durationHandler.SetLooping(0);
-    //===========Parameter linear ramp block=============
-    //HasChanged
-
-    //shoe
-    if (m_pParams->m_paramChangeHandler.HasChanged(PARAM_SHOE_ID))
-    {
-        generator.SetShoeType(m_pParams->RTPC.fShoeType);
-    }
-
-    //surface
-    if (m_pParams->m_paramChangeHandler.HasChanged(PARAM_SURFACE_ID))
-    {
-        generator.SetSurfaceType(m_pParams->RTPC.fSurfaceType);
-    }
-
-    //terrain
-    if (m_pParams->m_paramChangeHandler.HasChanged(PARAM_TERRAIN_ID))
-    {
-        generator.SetTerrain(m_pParams->RTPC.fTerrain);
-    }
-
-    //Pace
-    if (m_pParams->m_paramChangeHandler.HasChanged(PARAM_PACE_ID))
-    {
-        generator.SetPace(m_pParams->RTPC.fPace);
-    }
-
-    //Firmness
-    if (m_pParams->m_paramChangeHandler.HasChanged(PARAM_FIRMNESS_ID))
-    {
-        generator.SetFirmness(m_pParams->RTPC.fFirmness);
-        
-    }
-
-    //Steadiness
-    if (m_pParams->m_paramChangeHandler.HasChanged(PARAM_STEADINESS_ID))
-    {
-        generator.SetSteadiness(m_pParams->RTPC.fSteadiness);
-        
-    }
-    
-    //Automated
-    if (m_pParams->m_paramChangeHandler.HasChanged(PARAM_AUTOMATED_ID))
-    {
-        generator.SetAutomeated(m_pParams->RTPC.fAutomated);
-
-    }
-    
-     
-    for (AkUInt32 i = 0; i < uNumChannels; ++i)
-    {
-        AkReal32* AK_RESTRICT pBuf = (AkReal32* AK_RESTRICT)out_pBuffer->GetChannel(i);
-        generator.ExcuteModel(pBuf, out_pBuffer->uValidFrames);
-        //uFramesProduced = 0;
-        //while (uFramesProduced < out_pBuffer->uValidFrames)
-        //{
-        //    // Generate output here
-        //    
-        //    generator.Step();
-        //    //
-        // 
-        //    float OutputSample = generator.IncrementTheModelChannel();
-        //    *pBuf++ = OutputSample;
-        //    ++uFramesProduced;
-        //    
-        //}
-    }
-}
-
-AkReal32 FootstepsSource::GetDuration() const
-{
-    return m_durationHandler.GetDuration() * 1000.0f;
-}
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2021 Audiokinetic Inc.
+*******************************************************************************/
+
+#include "FootstepsSource.h"
+#include "GeneratorPool.h"
+#include "CpuGovernor.h"
+#include "../FootstepsConfig.h"
+
+#include <AK/AkWwiseSDKVersion.h>
+
+#include <cstdlib>
+#include <cstring>
+
+AK::IAkPlugin* CreateFootstepsSource(AK::IAkPluginMemAlloc* in_pAllocator)
+{
+    return AK_PLUGIN_NEW(in_pAllocator, FootstepsSource());
+}
+
+AK::IAkPluginParam* CreateFootstepsSourceParams(AK::IAkPluginMemAlloc* in_pAllocator)
+{
+    return AK_PLUGIN_NEW(in_pAllocator, FootstepsSourceParams());
+}
+
+namespace
+{
+    //Parameters that change what the generator renders, anything the lookahead worker rendered before them is stale
+    const AkUInt32 AUDIBLE_PARAMS = ((1u << NUM_PARAMS) - 1)
+        & ~((1u << PARAM_LOOKAHEADTIME_ID) | (1u << PARAM_CPUBUDGET_ID) | (1u << PARAM_RATEDIVISOR_ID) | (1u << PARAM_IDLERELEASETIME_ID));
+
+    //The lookahead worker lives as long as the sound engine, started and joined off the audio thread
+    void OnFootstepsRegister(AK::IAkGlobalPluginContext* in_pContext, AkGlobalCallbackLocation in_eLocation, void* in_pCookie)
+    {
+        if (in_eLocation == AkGlobalCallbackLocation_Register)
+        {
+            LookaheadRenderer::StartWorker();
+            in_pContext->RegisterGlobalCallback(
+                AkPluginTypeSource,
+                FootstepsConfig::CompanyID,
+                FootstepsConfig::PluginID,
+                OnFootstepsRegister,
+                AkGlobalCallbackLocation_Term);
+        }
+        else if (in_eLocation == AkGlobalCallbackLocation_Term)
+        {
+            LookaheadRenderer::StopWorker();
+        }
+    }
+}
+
+//AK_IMPLEMENT_PLUGIN_FACTORY without a registration callback, spelled out to start the lookahead worker
+AK::PluginRegistration FootstepsSourceRegistration(AkPluginTypeSource, FootstepsConfig::CompanyID, FootstepsConfig::PluginID,
+    CreateFootstepsSource, CreateFootstepsSourceParams, OnFootstepsRegister, nullptr);
+
+#if FOOTSTEPS_TRACE_EVENTS
+namespace
+{
+    //The writer thread is joined with the sound engine, never from a static destructor while the module unloads
+    void OnTraceLogTerm(AK::IAkGlobalPluginContext* in_pContext, AkGlobalCallbackLocation in_eLocation, void* in_pCookie)
+    {
+        TraceLogWriter::Stop();
+    }
+}
+#endif
+
+FootstepsSource::FootstepsSource()
+    : m_pParams(nullptr)
+    , m_pAllocator(nullptr)
+    , m_pContext(nullptr)
+    , m_pGenerator(nullptr)
+    , m_appliedParams()
+    , m_bApplyAllParams(true)
+    , m_bResetPending(false)
+    , m_bInvalidatePending(false)
+    , m_uSkipFrames(0)
+{
+}
+
+FootstepsSource::~FootstepsSource()
+{
+}
+
+AKRESULT FootstepsSource::Init(AK::IAkPluginMemAlloc* in_pAllocator, AK::IAkSourcePluginContext* in_pContext, AK::IAkPluginParam* in_pParams, AkAudioFormat& in_rFormat)
+{
+    m_pParams = (FootstepsSourceParams*)in_pParams;
+    m_pAllocator = in_pAllocator;
+    m_pContext = in_pContext;
+
+    m_durationHandler.Setup(0.1f, 0, in_rFormat.uSampleRate);
+
+    //Every parameter is dispatched to the generator on the first Execute
+    const FootstepsParamSnapshot& Params = m_pParams->GetSnapshot();
+    m_bApplyAllParams = true;
+    m_bResetPending = false;
+    m_bInvalidatePending = false;
+    m_uSkipFrames = 0;
+
+    //Prepared model from the pool, a full PrepareModel only if none is left at this rate
+    m_pGenerator = GeneratorPool::Acquire(in_pAllocator, in_pContext->GlobalContext(), in_rFormat.uSampleRate, Params.NonRTPC.fRateDivisor);
+    if (m_pGenerator == nullptr)
+        return AK_InsufficientMemory;
+    //Convolution and the step cache are allocated here or not at all, switching them on later applies to the next voice.
+    //The separation delay and crunch grains only for the terrain, crowd and surfaces the voice starts with
+    GeneratorSubsystems Subsystems;
+    Subsystems.Convolution = Params.NonRTPC.fConvolution;
+    Subsystems.StepCache = Params.NonRTPC.fCpuBudget > 0.0f;
+    Subsystems.OneShot = Params.NonRTPC.fOneShot;
+    Subsystems.Terrain = (AkInt32)Params.RTPC.fTerrain;
+    Subsystems.CrowdSize = (AkInt32)Params.RTPC.fCrowdSize;
+    Subsystems.SurfaceType = (AkInt32)Params.RTPC.fSurfaceType;
+    Subsystems.BlendSurface = (AkInt32)Params.RTPC.fBlendSurface;
+    Subsystems.IdleReleaseTime = Params.NonRTPC.fIdleReleaseTime;
+    m_pGenerator->PrepareSubsystems(Subsystems);
+
+    //Every voice's render time counts against the shared budget
+    CpuGovernor::Register(in_pContext->GlobalContext());
+
+#if FOOTSTEPS_TRACE_EVENTS
+    //Trace builds log the events of every voice to the file named by FOOTSTEPS_TRACE_LOG, if set
+    const char* szTraceLog = getenv("FOOTSTEPS_TRACE_LOG");
+    if (szTraceLog != nullptr && !TraceLogWriter::IsStarted() && TraceLogWriter::Start(szTraceLog))
+    {
+        in_pContext->GlobalContext()->RegisterGlobalCallback(
+            AkPluginTypeSource,
+            FootstepsConfig::CompanyID,
+            FootstepsConfig::PluginID,
+            OnTraceLogTerm,
+            AkGlobalCallbackLocation_Term);
+    }
+#endif
+
+    //One-shot voices are too short to benefit from lookahead rendering
+    if (Params.NonRTPC.fOneShot)
+    {
+        StartOneShot(Params);
+        return AK_Success;
+    }
+
+    //Lookahead rendering only pays for its ring when enabled in the authoring tool
+    if (Params.NonRTPC.fLookaheadTime > 0.0f)
+    {
+        AKRESULT eResult = m_lookahead.Init(in_pAllocator, m_pGenerator, in_rFormat.uSampleRate);
+        if (eResult == AK_InsufficientMemory)
+            return eResult;
+    }
+    
+    return AK_Success;
+}
+
+AKRESULT FootstepsSource::Term(AK::IAkPluginMemAlloc* in_pAllocator)
+{
+    //A generator the worker is rendering with right now is handed back to the pool by the worker
+    if (m_lookahead.Term(in_pAllocator))
+        GeneratorPool::Release(in_pAllocator, m_pGenerator);
+    m_pGenerator = nullptr;
+    AK_PLUGIN_DELETE(in_pAllocator, this);
+    return AK_Success;
+}
+
+AKRESULT FootstepsSource::Reset()
+{
+    //Without waiting for the lookahead worker, the next Execute resets the generator if it is mid-chunk
+    m_bResetPending = true;
+    if (m_lookahead.Reclaim())
+        ResetGenerator(m_pParams->GetSnapshot());
+    return AK_Success;
+}
+
+AKRESULT FootstepsSource::GetPluginInfo(AkPluginInfo& out_rPluginInfo)
+{
+    out_rPluginInfo.eType = AkPluginTypeSource;
+    out_rPluginInfo.bIsInPlace = true;
+    out_rPluginInfo.uBuildVersion = AK_WWISESDK_VERSION_COMBINED;
+    return AK_Success;
+}
+
+void FootstepsSource::Execute(AkAudioBuffer* out_pBuffer)
+{
+    //Ticks rather than the steady clock, two clock reads cost more than a 64-frame buffer can afford
+    const AkUInt64 uStartTicks = CpuGovernor::ReadTicks();
+
+    //m_durationHandler.SetDuration(m_pParams->RTPC.fDuration);
+    m_durationHandler.ProduceBuffer(out_pBuffer);
+
+    //One consistent set of parameters for the whole buffer
+    const FootstepsParamSnapshot& Params = m_pParams->GetSnapshot();
+    const AkUInt32 uChangedParams = DiffParams(Params);
+
+    const AkUInt32 uNumChannels = out_pBuffer->NumChannels();
+
+    //AkUInt16 uFramesProduced;
+
+    //One-shot voices keep the handler's frame count and end of stream, walking never ends
+    if (!Params.NonRTPC.fOneShot)
+    {
+        out_pBuffer->uValidFrames = out_pBuffer->MaxFrames();
+        m_durationHandler.SetLooping(0);
+    }
+    //===========Parameter linear ramp block=============
+    //HasChanged
+
+    //What the lookahead worker rendered before an audible change is dropped as soon as the generator is back, until
+    //then it keeps playing rather than leaving a gap
+    if (uChangedParams & AUDIBLE_PARAMS)
+        m_bInvalidatePending = true;
+
+    //A generator lent to the lookahead worker is only taken back when there is something to change
+    bool bHeld = !m_lookahead.IsLent();
+    if (!bHeld && (uChangedParams != 0 || m_bResetPending || m_bInvalidatePending || m_uSkipFrames > 0))
+        bHeld = m_lookahead.Reclaim();
+    if (bHeld)
+        CatchUpGenerator(Params);
+
+    //Voices rendered by the lookahead worker don't load the audio thread and keep their level. After a change the
+    //voice renders inline until its parameters settle
+    const bool bLend = m_lookahead.IsEnabled() && m_pGenerator->m_Automated && (uChangedParams & AUDIBLE_PARAMS) == 0;
+    if (bHeld && !bLend)
+    {
+        m_pGenerator->SetQualityLevel(Params.NonRTPC.fCpuBudget > 0.0f ? CpuGovernor::GetLevel() : GENERATOR_QUALITY_FULL);
+    }
+     
+    //The model is mono, rendered once into the first channel and copied to the others
+    if (uNumChannels > 0)
+    {
+        const AkUInt16 uFrames = out_pBuffer->uValidFrames;
+        AkReal32* AK_RESTRICT pBuf = (AkReal32* AK_RESTRICT)out_pBuffer->GetChannel(0);
+        //What the worker rendered before a pending reset is not played
+        const AkUInt32 uRead = m_bResetPending ? 0 : m_lookahead.Read(pBuf, uFrames);
+
+        //Underrun, the rest is rendered inline unless the worker is still mid-chunk
+        if (uRead < uFrames)
+        {
+            if (!bHeld && m_lookahead.Reclaim())
+            {
+                bHeld = true;
+                CatchUpGenerator(Params);
+            }
+            if (bHeld)
+                m_pGenerator->ExcuteModel(pBuf + uRead, (AkUInt16)(uFrames - uRead));
+            else
+                memset(pBuf + uRead, 0, (uFrames - uRead) * sizeof(AkReal32));
+        }
+
+        for (AkUInt32 i = 1; i < uNumChannels; ++i)
+            memcpy(out_pBuffer->GetChannel(i), pBuf, uFrames * sizeof(AkReal32));
+    }
+
+    //Hand automated voices back to the worker once their parameters have settled
+    if (bHeld && bLend)
+    {
+        m_lookahead.Lend();
+    }
+
+    //The budget is a share of the buffer's duration, fCpuBudget is in %
+    AkUInt32 uBudget = 0;
+    if (Params.NonRTPC.fCpuBudget > 0.0f)
+        uBudget = (AkUInt32)(Params.NonRTPC.fCpuBudget * 1.0e7f * (AkReal32)out_pBuffer->MaxFrames() / (AkReal32)m_pGenerator->m_outputRate);
+    CpuGovernor::AddExecuteTicks(CpuGovernor::ReadTicks() - uStartTicks, uBudget);
+}
+
+AkReal32 FootstepsSource::GetDuration() const
+{
+    return m_durationHandler.GetDuration() * 1000.0f;
+}
+
+AKRESULT FootstepsSource::TimeSkip(AkUInt32& io_uFrames)
+{
+    //One consistent set of parameters for the skipped frames, like a buffer
+    const FootstepsParamSnapshot& Params = m_pParams->GetSnapshot();
+
+    //The generator is advanced in place, if the lookahead worker is mid-chunk the next Execute does it
+    const bool bHeld = m_lookahead.Reclaim();
+    if (bHeld)
+        CatchUpGenerator(Params);
+
+    //Let the duration handler account for the skipped frames, one-shot voices can end while virtual
+    AkAudioBuffer SkipBuffer;
+    SkipBuffer.AttachContiguousDeinterleavedData(nullptr, (AkUInt16)io_uFrames, 0, AkChannelConfig());
+    m_durationHandler.ProduceBuffer(&SkipBuffer);
+    if (!m_appliedParams.NonRTPC.fOneShot)
+    {
+        SkipBuffer.uValidFrames = SkipBuffer.MaxFrames();
+        SkipBuffer.eState = AK_DataReady;
+    }
+
+    //What the worker rendered ahead is skipped first
+    m_uSkipFrames += SkipBuffer.uValidFrames;
+    if (!m_bResetPending)
+        m_uSkipFrames -= m_lookahead.Skip(m_uSkipFrames);
+    if (bHeld)
+    {
+        m_pGenerator->Advance(m_uSkipFrames);
+        m_uSkipFrames = 0;
+    }
+    io_uFrames = SkipBuffer.uValidFrames;
+    return SkipBuffer.eState;
+}
+
+AkUInt32 FootstepsSource::DiffParams(const FootstepsParamSnapshot& in_params) const
+{
+    if (m_bApplyAllParams)
+        return (1u << NUM_PARAMS) - 1;
+
+    //Same publish as last time, nothing can have changed
+    if (in_params.uSequence == m_appliedParams.uSequence)
+        return 0;
+
+    const FootstepsRTPCParams& RTPC = in_params.RTPC;
+    const FootstepsRTPCParams& OldRTPC = m_appliedParams.RTPC;
+    const FootstepsNonRTPCParams& NonRTPC = in_params.NonRTPC;
+    const FootstepsNonRTPCParams& OldNonRTPC = m_appliedParams.NonRTPC;
+
+    AkUInt32 uChanged = 0;
+    uChanged |= (AkUInt32)(RTPC.fShoeType != OldRTPC.fShoeType) << PARAM_SHOE_ID;
+    uChanged |= (AkUInt32)(RTPC.fSurfaceType != OldRTPC.fSurfaceType) << PARAM_SURFACE_ID;
+    uChanged |= (AkUInt32)(RTPC.fTerrain != OldRTPC.fTerrain) << PARAM_TERRAIN_ID;
+    uChanged |= (AkUInt32)(RTPC.fPace != OldRTPC.fPace) << PARAM_PACE_ID;
+    uChanged |= (AkUInt32)(RTPC.fFirmness != OldRTPC.fFirmness) << PARAM_FIRMNESS_ID;
+    uChanged |= (AkUInt32)(RTPC.fSteadiness != OldRTPC.fSteadiness) << PARAM_STEADINESS_ID;
+    uChanged |= (AkUInt32)(RTPC.fAutomated != OldRTPC.fAutomated) << PARAM_AUTOMATED_ID;
+    uChanged |= (AkUInt32)(RTPC.fCrowdSize != OldRTPC.fCrowdSize) << PARAM_CROWDSIZE_ID;
+    uChanged |= (AkUInt32)(RTPC.fPaceSpread != OldRTPC.fPaceSpread) << PARAM_PACESPREAD_ID;
+    uChanged |= (AkUInt32)(RTPC.fSteadinessSpread != OldRTPC.fSteadinessSpread) << PARAM_STEADINESSSPREAD_ID;
+    uChanged |= (AkUInt32)(NonRTPC.fLookaheadTime != OldNonRTPC.fLookaheadTime) << PARAM_LOOKAHEADTIME_ID;
+    uChanged |= (AkUInt32)(NonRTPC.fOneShot != OldNonRTPC.fOneShot) << PARAM_ONESHOT_ID;
+    uChanged |= (AkUInt32)(NonRTPC.fConvolution != OldNonRTPC.fConvolution) << PARAM_CONVOLUTION_ID;
+    uChanged |= (AkUInt32)(RTPC.fPaceTarget != OldRTPC.fPaceTarget) << PARAM_PACETARGET_ID;
+    uChanged |= (AkUInt32)(RTPC.fPaceCurveTime != OldRTPC.fPaceCurveTime) << PARAM_PACECURVETIME_ID;
+    uChanged |= (AkUInt32)(RTPC.fFirmnessTarget != OldRTPC.fFirmnessTarget) << PARAM_FIRMNESSTARGET_ID;
+    uChanged |= (AkUInt32)(RTPC.fFirmnessCurveTime != OldRTPC.fFirmnessCurveTime) << PARAM_FIRMNESSCURVETIME_ID;
+    uChanged |= (AkUInt32)(NonRTPC.fMaxModes != OldNonRTPC.fMaxModes) << PARAM_MAXMODES_ID;
+    uChanged |= (AkUInt32)(NonRTPC.fCrunch != OldNonRTPC.fCrunch) << PARAM_CRUNCH_ID;
+    uChanged |= (AkUInt32)(NonRTPC.fEnvelopeResolution != OldNonRTPC.fEnvelopeResolution) << PARAM_ENVELOPERESOLUTION_ID;
+    uChanged |= (AkUInt32)(RTPC.fBlendSurface != OldRTPC.fBlendSurface) << PARAM_BLENDSURFACE_ID;
+    uChanged |= (AkUInt32)(RTPC.fSurfaceBlend != OldRTPC.fSurfaceBlend) << PARAM_SURFACEBLEND_ID;
+    uChanged |= (AkUInt32)(NonRTPC.fIdleReleaseTime != OldNonRTPC.fIdleReleaseTime) << PARAM_IDLERELEASETIME_ID;
+    return uChanged;
+}
+
+void FootstepsSource::ApplyParamChanges(const FootstepsParamSnapshot& in_params, AkUInt32 in_uChanged)
+{
+    if (in_uChanged != 0)
+        FOOTSTEPS_TRACE(m_pGenerator->GetTrace(), TRACE_EVENT_PARAMS, in_uChanged);
+
+    //Quality tier first, the surface set below reads it. The rate divisor was given to the pool in Init
+    const AkUInt32 uTier = (1u << PARAM_MAXMODES_ID) | (1u << PARAM_CRUNCH_ID) | (1u << PARAM_ENVELOPERESOLUTION_ID);
+    if (in_uChanged & uTier)
+    {
+        GeneratorTier Tier;
+        Tier.MaxModes = in_params.NonRTPC.fMaxModes;
+        Tier.Crunch = in_params.NonRTPC.fCrunch;
+        Tier.EnvelopeResolution = in_params.NonRTPC.fEnvelopeResolution;
+        m_pGenerator->SetTier(Tier);
+    }
+
+    //shoe
+    if (in_uChanged & (1u << PARAM_SHOE_ID))
+    {
+        m_pGenerator->SetShoeType(in_params.RTPC.fShoeType);
+    }
+
+    //surface
+    if (in_uChanged & (1u << PARAM_SURFACE_ID))
+    {
+        m_pGenerator->SetSurfaceType(in_params.RTPC.fSurfaceType);
+    }
+
+    //Surface blend, the generator evaluates it on the next step
+    if (in_uChanged & (1u << PARAM_BLENDSURFACE_ID))
+    {
+        m_pGenerator->SetBlendSurface(in_params.RTPC.fBlendSurface);
+    }
+
+    if (in_uChanged & (1u << PARAM_SURFACEBLEND_ID))
+    {
+        m_pGenerator->SetSurfaceBlend(in_params.RTPC.fSurfaceBlend);
+    }
+
+    //terrain
+    if (in_uChanged & (1u << PARAM_TERRAIN_ID))
+    {
+        m_pGenerator->SetTerrain(in_params.RTPC.fTerrain);
+    }
+
+    //Pace, a new target or curve time restarts the curve from the current pace, a time of 0 goes back to Pace
+    const AkUInt32 uPaceCurve = (1u << PARAM_PACE_ID) | (1u << PARAM_PACETARGET_ID) | (1u << PARAM_PACECURVETIME_ID);
+    if (in_uChanged & uPaceCurve)
+    {
+        if ((in_uChanged & (1u << PARAM_PACE_ID)) || in_params.RTPC.fPaceCurveTime <= 0.0f)
+        {
+            m_pGenerator->SetPace(in_params.RTPC.fPace);
+        }
+        if (in_params.RTPC.fPaceCurveTime > 0.0f)
+        {
+            m_pGenerator->SetPaceCurve(in_params.RTPC.fPaceTarget, in_params.RTPC.fPaceCurveTime);
+        }
+    }
+
+    //Firmness
+    const AkUInt32 uFirmnessCurve = (1u << PARAM_FIRMNESS_ID) | (1u << PARAM_FIRMNESSTARGET_ID) | (1u << PARAM_FIRMNESSCURVETIME_ID);
+    if (in_uChanged & uFirmnessCurve)
+    {
+        if ((in_uChanged & (1u << PARAM_FIRMNESS_ID)) || in_params.RTPC.fFirmnessCurveTime <= 0.0f)
+        {
+            m_pGenerator->SetFirmness(in_params.RTPC.fFirmness);
+        }
+        if (in_params.RTPC.fFirmnessCurveTime > 0.0f)
+        {
+            m_pGenerator->SetFirmnessCurve(in_params.RTPC.fFirmnessTarget, in_params.RTPC.fFirmnessCurveTime);
+        }
+    }
+
+    //Steadiness
+    if (in_uChanged & (1u << PARAM_STEADINESS_ID))
+    {
+        m_pGenerator->SetSteadiness(in_params.RTPC.fSteadiness);
+    }
+
+    //Automated
+    if (in_uChanged & (1u << PARAM_AUTOMATED_ID))
+    {
+        m_pGenerator->SetAutomeated(in_params.RTPC.fAutomated);
+    }
+
+    //Crowd
+    if (in_uChanged & (1u << PARAM_PACESPREAD_ID))
+    {
+        m_pGenerator->SetPaceSpread(in_params.RTPC.fPaceSpread);
+    }
+
+    if (in_uChanged & (1u << PARAM_STEADINESSSPREAD_ID))
+    {
+        m_pGenerator->SetSteadinessSpread(in_params.RTPC.fSteadinessSpread);
+    }
+
+    if (in_uChanged & (1u << PARAM_CROWDSIZE_ID))
+    {
+        m_pGenerator->SetCrowdSize(in_params.RTPC.fCrowdSize);
+    }
+
+    //A voice that started upstairs or in a crowd gets its separation delay once it walks flat on its own
+    if (in_uChanged & ((1u << PARAM_TERRAIN_ID) | (1u << PARAM_CROWDSIZE_ID)))
+    {
+        m_pGenerator->PrepareBallPath();
+    }
+
+    //Convolution
+    if (in_uChanged & (1u << PARAM_CONVOLUTION_ID))
+    {
+        m_pGenerator->SetConvolution(in_params.NonRTPC.fConvolution);
+    }
+
+    //Optional subsystems
+    if (in_uChanged & (1u << PARAM_IDLERELEASETIME_ID))
+    {
+        m_pGenerator->SetIdleReleaseTime(in_params.NonRTPC.fIdleReleaseTime);
+    }
+
+    //Lookahead
+    if (in_uChanged & (1u << PARAM_LOOKAHEADTIME_ID))
+    {
+        m_lookahead.SetLookaheadTime(in_params.NonRTPC.fLookaheadTime / 1000.0f);
+    }
+
+    m_appliedParams = in_params;
+    m_bApplyAllParams = false;
+}
+
+void FootstepsSource::ResetGenerator(const FootstepsParamSnapshot& in_params)
+{
+    m_lookahead.Clear();
+    m_pGenerator->ReleaseIdleSubsystems();
+    m_pGenerator->ResetModel();
+    //ResetModel restores the defaults, re-apply every parameter on the next Execute
+    m_bApplyAllParams = true;
+    m_bResetPending = false;
+    m_bInvalidatePending = false;
+    m_uSkipFrames = 0;
+    if (in_params.NonRTPC.fOneShot)
+    {
+        StartOneShot(in_params);
+    }
+}
+
+void FootstepsSource::CatchUpGenerator(const FootstepsParamSnapshot& in_params)
+{
+    if (m_bResetPending)
+        ResetGenerator(in_params);
+    if (m_bInvalidatePending)
+    {
+        m_lookahead.Clear();
+        m_bInvalidatePending = false;
+    }
+    ApplyParamChanges(in_params, DiffParams(in_params));
+    if (m_uSkipFrames > 0)
+    {
+        m_uSkipFrames -= m_lookahead.Skip(m_uSkipFrames);
+        m_pGenerator->Advance(m_uSkipFrames);
+        m_uSkipFrames = 0;
+    }
+}
+
+void FootstepsSource::StartOneShot(const FootstepsParamSnapshot& in_params)
+{
+    //The step is shaped by the current parameters, apply them before triggering it
+    ApplyParamChanges(in_params, DiffParams(in_params));
+    m_durationHandler.SetDuration(m_pGenerator->TriggerOneShot());
+    m_durationHandler.SetLooping(1);
+    m_durationHandler.Reset();
+}
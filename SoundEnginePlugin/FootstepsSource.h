@@ -1,83 +1,99 @@
-/*******************************************************************************
-The content of this file includes portions of the AUDIOKINETIC Wwise Technology
-released in source code form as part of the SDK installer package.
-
-Commercial License Usage
-
-Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
-may use this file in accordance with the end user license agreement provided
-with the software or, alternatively, in accordance with the terms contained in a
-written agreement between you and Audiokinetic Inc.
-
-Apache License Usage
-
-Alternatively, this file may be used under the Apache License, Version 2.0 (the
-"Apache License"); you may not use this file except in compliance with the
-Apache License. You may obtain a copy of the Apache License at
-http://www.apache.org/licenses/LICENSE-2.0.
-
-Unless required by applicable law or agreed to in writing, software distributed
-under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
-OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
-the specific language governing permissions and limitations under the License.
-
-  Copyright (c) 2021 Audiokinetic Inc.
-*******************************************************************************/
-
-#ifndef FootstepsSource_H
-#define FootstepsSource_H
-
-#include "FootstepsSourceParams.h"
-#include "Generator.h"
-
-#include <AK/Plugin/PluginServices/AkFXDurationHandler.h>
-
-
-/// See https://www.audiokinetic.com/library/edge/?source=SDK&id=soundengine__plugins__source.html
-/// for the documentation about source plug-ins
-class FootstepsSource
-    : public AK::IAkSourcePlugin
-{
-public:
-    FootstepsSource();
-    ~FootstepsSource();
-
-    /// Plug-in initialization.
-    /// Prepares the plug-in for data processing, allocates memory and sets up the initial conditions.
-    AKRESULT Init(AK::IAkPluginMemAlloc* in_pAllocator, AK::IAkSourcePluginContext* in_pContext, AK::IAkPluginParam* in_pParams, AkAudioFormat& in_rFormat) override;
-
-    /// Release the resources upon termination of the plug-in.
-    AKRESULT Term(AK::IAkPluginMemAlloc* in_pAllocator) override;
-
-    /// The reset action should perform any actions required to reinitialize the
-    /// state of the plug-in to its original state (e.g. after Init() or on effect bypass).
-    AKRESULT Reset() override;
-
-    /// Plug-in information query mechanism used when the sound engine requires
-    /// information about the plug-in to determine its behavior.
-    AKRESULT GetPluginInfo(AkPluginInfo& out_rPluginInfo) override;
-
-    /// Source plug-in DSP execution.
-    void Execute(AkAudioBuffer* io_pBuffer) override;
-
-    /// This method is called to determine the approximate duration (in ms) of the source.
-    AkReal32 GetDuration() const override;
-
-private:
-    FootstepsSourceParams* m_pParams;
-    AK::IAkPluginMemAlloc* m_pAllocator;
-    AK::IAkSourcePluginContext* m_pContext;
-    AkFXDurationHandler m_durationHandler;
-
-    
-    float FadeTime = 0.5f; //if fading in and out
-    bool State = true; //if keeping track of whether model is active
-    bool StateOn = false; //if keeping track of whether model is active
-
-    //==========Helper functions================
-    Generator generator;
-    
-
-};
-
-#endif // FootstepsSource_H
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2021 Audiokinetic Inc.
+*******************************************************************************/
+
+#ifndef FootstepsSource_H
+#define FootstepsSource_H
+
+#include "FootstepsSourceParams.h"
+#include "Generator.h"
+#include "LookaheadRenderer.h"
+
+#include <AK/Plugin/PluginServices/AkFXDurationHandler.h>
+
+
+/// See https://www.audiokinetic.com/library/edge/?source=SDK&id=soundengine__plugins__source.html
+/// for the documentation about source plug-ins
+class FootstepsSource
+    : public AK::IAkSourcePlugin
+{
+public:
+    FootstepsSource();
+    ~FootstepsSource();
+
+    /// Plug-in initialization.
+    /// Prepares the plug-in for data processing, allocates memory and sets up the initial conditions.
+    AKRESULT Init(AK::IAkPluginMemAlloc* in_pAllocator, AK::IAkSourcePluginContext* in_pContext, AK::IAkPluginParam* in_pParams, AkAudioFormat& in_rFormat) override;
+
+    /// Release the resources upon termination of the plug-in.
+    AKRESULT Term(AK::IAkPluginMemAlloc* in_pAllocator) override;
+
+    /// The reset action should perform any actions required to reinitialize the
+    /// state of the plug-in to its original state (e.g. after Init() or on effect bypass).
+    AKRESULT Reset() override;
+
+    /// Plug-in information query mechanism used when the sound engine requires
+    /// information about the plug-in to determine its behavior.
+    AKRESULT GetPluginInfo(AkPluginInfo& out_rPluginInfo) override;
+
+    /// Source plug-in DSP execution.
+    void Execute(AkAudioBuffer* io_pBuffer) override;
+
+    /// This method is called to determine the approximate duration (in ms) of the source.
+    AkReal32 GetDuration() const override;
+
+    /// Skips processing of some frames when the voice is virtual playing from elapsed time.
+    /// Moves the step scheduling forward so the cadence continues when the voice becomes audible again.
+    AKRESULT TimeSkip(AkUInt32& io_uFrames) override;
+
+private:
+    FootstepsSourceParams* m_pParams;
+    AK::IAkPluginMemAlloc* m_pAllocator;
+    AK::IAkSourcePluginContext* m_pContext;
+    AkFXDurationHandler m_durationHandler;
+
+    
+    float FadeTime = 0.5f; //if fading in and out
+    bool State = true; //if keeping track of whether model is active
+    bool StateOn = false; //if keeping track of whether model is active
+
+    //==========Helper functions================
+    AkUInt32 DiffParams(const FootstepsParamSnapshot& in_params) const; // bit per PARAM_*_ID that differs from what the generator has
+    void ApplyParamChanges(const FootstepsParamSnapshot& in_params, AkUInt32 in_uChanged);
+    void StartOneShot(const FootstepsParamSnapshot& in_params); // renders a single step, then lets the duration handler end the voice
+    void ResetGenerator(const FootstepsParamSnapshot& in_params);
+    void CatchUpGenerator(const FootstepsParamSnapshot& in_params); // pending reset, invalidation, parameters and skipped frames, only while the generator is held
+    Generator* m_pGenerator; // borrowed from the GeneratorPool between Init and Term
+    LookaheadRenderer m_lookahead;
+    FootstepsParamSnapshot m_appliedParams; // last snapshot dispatched to the generator
+    bool m_bApplyAllParams; // after Init and Reset, the generator is back to its defaults
+    bool m_bResetPending; // Reset while the lookahead worker was rendering with the generator
+    bool m_bInvalidatePending; // audible parameter change, the lookahead ring is dropped once the generator is held
+    AkUInt32 m_uSkipFrames; // skipped while the lookahead worker was rendering with the generator
+    
+
+};
+
+#endif // FootstepsSource_H
@@ -1,144 +1,325 @@
-/*******************************************************************************
-The content of this file includes portions of the AUDIOKINETIC Wwise Technology
-released in source code form as part of the SDK installer package.
-
-Commercial License Usage
-
-Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
-may use this file in accordance with the end user license agreement provided
-with the software or, alternatively, in accordance with the terms contained in a
-written agreement between you and Audiokinetic Inc.
-
-Apache License Usage
-
-Alternatively, this file may be used under the Apache License, Version 2.0 (the
-"Apache License"); you may not use this file except in compliance with the
-Apache License. You may obtain a copy of the Apache License at
-http://www.apache.org/licenses/LICENSE-2.0.
-
-Unless required by applicable law or agreed to in writing, software distributed
-under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
-OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
-the specific language governing permissions and limitations under the License.
-
-  Copyright (c) 2021 Audiokinetic Inc.
-*******************************************************************************/
-
-#include "FootstepsSourceParams.h"
-
-#include <AK/Tools/Common/AkBankReadHelpers.h>
-
-FootstepsSourceParams::FootstepsSourceParams()
-{
-}
-
-FootstepsSourceParams::~FootstepsSourceParams()
-{
-}
-
-FootstepsSourceParams::FootstepsSourceParams(const FootstepsSourceParams& in_rParams)
-{
-    RTPC = in_rParams.RTPC;
-    NonRTPC = in_rParams.NonRTPC;
-    m_paramChangeHandler.SetAllParamChanges();
-}
-
-AK::IAkPluginParam* FootstepsSourceParams::Clone(AK::IAkPluginMemAlloc* in_pAllocator)
-{
-    return AK_PLUGIN_NEW(in_pAllocator, FootstepsSourceParams(*this));
-}
-
-AKRESULT FootstepsSourceParams::Init(AK::IAkPluginMemAlloc* in_pAllocator, const void* in_pParamsBlock, AkUInt32 in_ulBlockSize)
-{
-    if (in_ulBlockSize == 0)
-    {
-        // Initialize default parameters here
-        //RTPC.fDuration = 0.0f;
-        RTPC.fShoeType = 0;
-        RTPC.fSurfaceType = 0;
-        RTPC.fTerrain = 0;
-        RTPC.fPace = 60;
-        RTPC.fFirmness = 0;
-        RTPC.fSteadiness = 0.5;
-        RTPC.fAutomated = false;
-        m_paramChangeHandler.SetAllParamChanges();
-        return AK_Success;
-    }
-
-    return SetParamsBlock(in_pParamsBlock, in_ulBlockSize);
-}
-
-AKRESULT FootstepsSourceParams::Term(AK::IAkPluginMemAlloc* in_pAllocator)
-{
-    AK_PLUGIN_DELETE(in_pAllocator, this);
-    return AK_Success;
-}
-
-AKRESULT FootstepsSourceParams::SetParamsBlock(const void* in_pParamsBlock, AkUInt32 in_ulBlockSize)
-{
-    AKRESULT eResult = AK_Success;
-    AkUInt8* pParamsBlock = (AkUInt8*)in_pParamsBlock;
-
-    // Read bank data here
-    //RTPC.fDuration = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
-    RTPC.fShoeType = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
-    RTPC.fSurfaceType = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
-    RTPC.fTerrain = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
-    RTPC.fPace = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
-    RTPC.fFirmness = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
-    RTPC.fSteadiness = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
-    RTPC.fAutomated = READBANKDATA(bool, pParamsBlock, in_ulBlockSize);
-
-    CHECKBANKDATASIZE(in_ulBlockSize, eResult);
-    m_paramChangeHandler.SetAllParamChanges();
-
-    return eResult;
-}
-
-AKRESULT FootstepsSourceParams::SetParam(AkPluginParamID in_paramID, const void* in_pValue, AkUInt32 in_ulParamSize)
-{
-    AKRESULT eResult = AK_Success;
-
-    // Handle parameter change here
-    AkReal32 fval;
-    switch (in_paramID)
-    {
-    case PARAM_SHOE_ID:
-        fval = *((AkReal32*)in_pValue);
-        RTPC.fShoeType = (int)fval;
-        m_paramChangeHandler.SetParamChange(PARAM_SHOE_ID);
-        break;
-    case PARAM_SURFACE_ID:
-        fval = *((AkReal32*)in_pValue);
-        RTPC.fSurfaceType = (int)fval;
-        m_paramChangeHandler.SetParamChange(PARAM_SURFACE_ID);
-        break;
-    case PARAM_TERRAIN_ID:
-        fval = *((AkReal32*)in_pValue);
-        RTPC.fTerrain = (int)fval;
-        m_paramChangeHandler.SetParamChange(PARAM_TERRAIN_ID);
-        break;
-    case PARAM_PACE_ID:
-        RTPC.fPace = *((AkReal32*)in_pValue);
-        m_paramChangeHandler.SetParamChange(PARAM_PACE_ID);
-        break;
-    case PARAM_FIRMNESS_ID:
-        RTPC.fFirmness = *((AkReal32*)in_pValue);
-        m_paramChangeHandler.SetParamChange(PARAM_FIRMNESS_ID);
-        break;
-    case PARAM_STEADINESS_ID:
-        RTPC.fSteadiness = *((AkReal32*)in_pValue);
-        m_paramChangeHandler.SetParamChange(PARAM_STEADINESS_ID);
-        break;
-    case PARAM_AUTOMATED_ID:
-        fval = *((AkReal32*)in_pValue);
-        RTPC.fAutomated = (bool)fval;
-        m_paramChangeHandler.SetParamChange(PARAM_AUTOMATED_ID);
-        break;
-    default:
-        eResult = AK_InvalidParameter;
-        break;
-    }
-
-    return eResult;
-}
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2021 Audiokinetic Inc.
+*******************************************************************************/
+
+#include "FootstepsSourceParams.h"
+
+#include <AK/Tools/Common/AkBankReadHelpers.h>
+
+#include <cstring>
+
+FootstepsSourceParams::FootstepsSourceParams()
+    : m_batches()
+    , m_uMiddleBatch(1)
+    , m_uBackBatch(0)
+    , m_writerBatch()
+    , m_uFrontBatch(2)
+    , m_uTakenBatch(0)
+    , m_bStaged(false)
+    , m_snapshot()
+{
+}
+
+FootstepsSourceParams::~FootstepsSourceParams()
+{
+}
+
+FootstepsSourceParams::FootstepsSourceParams(const FootstepsSourceParams& in_rParams)
+    : m_batches()
+    , m_uMiddleBatch(1)
+    , m_uBackBatch(0)
+    , m_writerBatch()
+    , m_uFrontBatch(2)
+    , m_uTakenBatch(0)
+    , m_bStaged(false)
+    , m_snapshot()
+{
+    RTPC = in_rParams.RTPC;
+    NonRTPC = in_rParams.NonRTPC;
+    PublishStaged();
+}
+
+AK::IAkPluginParam* FootstepsSourceParams::Clone(AK::IAkPluginMemAlloc* in_pAllocator)
+{
+    return AK_PLUGIN_NEW(in_pAllocator, FootstepsSourceParams(*this));
+}
+
+AKRESULT FootstepsSourceParams::Init(AK::IAkPluginMemAlloc* in_pAllocator, const void* in_pParamsBlock, AkUInt32 in_ulBlockSize)
+{
+    if (in_ulBlockSize == 0)
+    {
+        // Initialize default parameters here
+        //RTPC.fDuration = 0.0f;
+        RTPC.fShoeType = 0;
+        RTPC.fSurfaceType = 0;
+        RTPC.fTerrain = 0;
+        RTPC.fPace = 60;
+        RTPC.fFirmness = 0;
+        RTPC.fSteadiness = 0.5;
+        RTPC.fAutomated = false;
+        RTPC.fCrowdSize = 1;
+        RTPC.fPaceSpread = 0.1f;
+        RTPC.fSteadinessSpread = 0.2f;
+        NonRTPC.fLookaheadTime = 0.0f;
+        NonRTPC.fOneShot = false;
+        NonRTPC.fConvolution = false;
+        RTPC.fPaceTarget = 82.0f;
+        RTPC.fPaceCurveTime = 0.0f;
+        RTPC.fFirmnessTarget = 0.3f;
+        RTPC.fFirmnessCurveTime = 0.0f;
+        NonRTPC.fCpuBudget = 0.0f;
+        NonRTPC.fMaxModes = 9;
+        NonRTPC.fRateDivisor = 1;
+        NonRTPC.fCrunch = true;
+        NonRTPC.fEnvelopeResolution = 1;
+        RTPC.fBlendSurface = 0;
+        RTPC.fSurfaceBlend = 0.0f;
+        NonRTPC.fIdleReleaseTime = 5.0f;
+        PublishStaged();
+        return AK_Success;
+    }
+
+    // Nothing reads the node before Init returns, the first snapshot is always complete
+    const AKRESULT eResult = SetParamsBlock(in_pParamsBlock, in_ulBlockSize);
+    PublishStaged();
+    return eResult;
+}
+
+AKRESULT FootstepsSourceParams::Term(AK::IAkPluginMemAlloc* in_pAllocator)
+{
+    AK_PLUGIN_DELETE(in_pAllocator, this);
+    return AK_Success;
+}
+
+AKRESULT FootstepsSourceParams::SetParamsBlock(const void* in_pParamsBlock, AkUInt32 in_ulBlockSize)
+{
+    AKRESULT eResult = AK_Success;
+    AkUInt8* pParamsBlock = (AkUInt8*)in_pParamsBlock;
+
+    // Read bank data here
+    //RTPC.fDuration = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    RTPC.fShoeType = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+    RTPC.fSurfaceType = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+    RTPC.fTerrain = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+    RTPC.fPace = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    RTPC.fFirmness = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    RTPC.fSteadiness = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    RTPC.fAutomated = READBANKDATA(bool, pParamsBlock, in_ulBlockSize);
+    RTPC.fCrowdSize = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+    RTPC.fPaceSpread = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    RTPC.fSteadinessSpread = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fLookaheadTime = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fOneShot = READBANKDATA(bool, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fConvolution = READBANKDATA(bool, pParamsBlock, in_ulBlockSize);
+    RTPC.fPaceTarget = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    RTPC.fPaceCurveTime = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    RTPC.fFirmnessTarget = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    RTPC.fFirmnessCurveTime = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fCpuBudget = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fMaxModes = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fRateDivisor = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fCrunch = READBANKDATA(bool, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fEnvelopeResolution = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    RTPC.fBlendSurface = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+    RTPC.fSurfaceBlend = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.fIdleReleaseTime = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+
+    CHECKBANKDATASIZE(in_ulBlockSize, eResult);
+    m_bStaged = true;
+
+    return eResult;
+}
+
+AKRESULT FootstepsSourceParams::SetParam(AkPluginParamID in_paramID, const void* in_pValue, AkUInt32 in_ulParamSize)
+{
+    // Published with the rest of the batch at the next buffer
+    const AKRESULT eResult = StageParam(in_paramID, in_pValue, in_ulParamSize);
+    if (eResult == AK_Success)
+        m_bStaged = true;
+    return eResult;
+}
+
+AKRESULT FootstepsSourceParams::SetParams(const FootstepsParamValue* in_pValues, AkUInt32 in_uNumValues)
+{
+    AKRESULT eResult = AK_Success;
+    std::lock_guard<std::mutex> Lock(m_writerLock);
+
+    const AkUInt32 uSequence = m_writerBatch.uSequence + 1;
+    for (AkUInt32 i = 0; i < in_uNumValues; ++i)
+    {
+        const FootstepsParamValue& Value = in_pValues[i];
+        if (Value.ID >= NUM_PARAMS || Value.pValue == nullptr || Value.uSize > sizeof(AkUInt32))
+        {
+            eResult = AK_InvalidParameter;
+            continue;
+        }
+        memcpy(&m_writerBatch.Values[Value.ID], Value.pValue, Value.uSize);
+        m_writerBatch.uSizes[Value.ID] = Value.uSize;
+        m_writerBatch.uParamSequences[Value.ID] = uSequence;
+    }
+    m_writerBatch.uSequence = uSequence;
+
+    m_batches[m_uBackBatch] = m_writerBatch;
+    m_uBackBatch = m_uMiddleBatch.exchange(m_uBackBatch | (uSequence << BATCH_SLOT_BITS), std::memory_order_acq_rel) & BATCH_SLOT_MASK;
+    return eResult;
+}
+
+AKRESULT FootstepsSourceParams::StageParam(AkPluginParamID in_paramID, const void* in_pValue, AkUInt32 in_ulParamSize)
+{
+    AKRESULT eResult = AK_Success;
+
+    // Handle parameter change here
+    AkReal32 fval;
+    switch (in_paramID)
+    {
+    case PARAM_SHOE_ID:
+        fval = *((AkReal32*)in_pValue);
+        RTPC.fShoeType = (int)fval;
+        break;
+    case PARAM_SURFACE_ID:
+        fval = *((AkReal32*)in_pValue);
+        RTPC.fSurfaceType = (int)fval;
+        break;
+    case PARAM_TERRAIN_ID:
+        fval = *((AkReal32*)in_pValue);
+        RTPC.fTerrain = (int)fval;
+        break;
+    case PARAM_PACE_ID:
+        RTPC.fPace = *((AkReal32*)in_pValue);
+        break;
+    case PARAM_FIRMNESS_ID:
+        RTPC.fFirmness = *((AkReal32*)in_pValue);
+        break;
+    case PARAM_STEADINESS_ID:
+        RTPC.fSteadiness = *((AkReal32*)in_pValue);
+        break;
+    case PARAM_AUTOMATED_ID:
+        fval = *((AkReal32*)in_pValue);
+        RTPC.fAutomated = (bool)fval;
+        break;
+    case PARAM_CROWDSIZE_ID:
+        fval = *((AkReal32*)in_pValue);
+        RTPC.fCrowdSize = (int)fval;
+        break;
+    case PARAM_PACESPREAD_ID:
+        RTPC.fPaceSpread = *((AkReal32*)in_pValue);
+        break;
+    case PARAM_STEADINESSSPREAD_ID:
+        RTPC.fSteadinessSpread = *((AkReal32*)in_pValue);
+        break;
+    case PARAM_LOOKAHEADTIME_ID:
+        NonRTPC.fLookaheadTime = *((AkReal32*)in_pValue);
+        break;
+    case PARAM_ONESHOT_ID:
+        NonRTPC.fOneShot = *((bool*)in_pValue);
+        break;
+    case PARAM_CONVOLUTION_ID:
+        NonRTPC.fConvolution = *((bool*)in_pValue);
+        break;
+    case PARAM_PACETARGET_ID:
+        RTPC.fPaceTarget = *((AkReal32*)in_pValue);
+        break;
+    case PARAM_PACECURVETIME_ID:
+        RTPC.fPaceCurveTime = *((AkReal32*)in_pValue);
+        break;
+    case PARAM_FIRMNESSTARGET_ID:
+        RTPC.fFirmnessTarget = *((AkReal32*)in_pValue);
+        break;
+    case PARAM_FIRMNESSCURVETIME_ID:
+        RTPC.fFirmnessCurveTime = *((AkReal32*)in_pValue);
+        break;
+    case PARAM_CPUBUDGET_ID:
+        NonRTPC.fCpuBudget = *((AkReal32*)in_pValue);
+        break;
+    case PARAM_MAXMODES_ID:
+        NonRTPC.fMaxModes = *((AkInt32*)in_pValue);
+        break;
+    case PARAM_RATEDIVISOR_ID:
+        NonRTPC.fRateDivisor = *((AkInt32*)in_pValue);
+        break;
+    case PARAM_CRUNCH_ID:
+        NonRTPC.fCrunch = *((bool*)in_pValue);
+        break;
+    case PARAM_ENVELOPERESOLUTION_ID:
+        NonRTPC.fEnvelopeResolution = *((AkInt32*)in_pValue);
+        break;
+    case PARAM_BLENDSURFACE_ID:
+        fval = *((AkReal32*)in_pValue);
+        RTPC.fBlendSurface = (int)fval;
+        break;
+    case PARAM_SURFACEBLEND_ID:
+        RTPC.fSurfaceBlend = *((AkReal32*)in_pValue);
+        break;
+    case PARAM_IDLERELEASETIME_ID:
+        NonRTPC.fIdleReleaseTime = *((AkReal32*)in_pValue);
+        break;
+    default:
+        eResult = AK_InvalidParameter;
+        break;
+    }
+
+    return eResult;
+}
+
+void FootstepsSourceParams::StageLatestBatch()
+{
+    // Only retried when a writer published in between, the newer batch is then taken instead
+    AkUInt32 uMiddle = m_uMiddleBatch.load(std::memory_order_acquire);
+    for (;;)
+    {
+        if ((uMiddle >> BATCH_SLOT_BITS) == ((m_uTakenBatch << BATCH_SLOT_BITS) >> BATCH_SLOT_BITS))
+            return;
+        // The front slot goes back tagged with the sequence taken, so it is not taken again
+        if (m_uMiddleBatch.compare_exchange_weak(uMiddle, m_uFrontBatch | (uMiddle & ~BATCH_SLOT_MASK), std::memory_order_acq_rel, std::memory_order_acquire))
+            break;
+    }
+
+    // Whatever was set since the last batch taken, including batches published over before they were taken
+    m_uFrontBatch = uMiddle & BATCH_SLOT_MASK;
+    const FootstepsParamBatch& Batch = m_batches[m_uFrontBatch];
+    for (AkPluginParamID ID = 0; ID < NUM_PARAMS; ++ID)
+    {
+        if (Batch.uParamSequences[ID] != 0 && (AkInt32)(Batch.uParamSequences[ID] - m_uTakenBatch) > 0)
+            StageParam(ID, &Batch.Values[ID], Batch.uSizes[ID]);
+    }
+    m_uTakenBatch = Batch.uSequence;
+    m_bStaged = true;
+}
+
+void FootstepsSourceParams::PublishStaged()
+{
+    m_snapshot.RTPC = RTPC;
+    m_snapshot.NonRTPC = NonRTPC;
+    m_snapshot.uSequence++;
+    m_bStaged = false;
+}
+
+const FootstepsParamSnapshot& FootstepsSourceParams::GetSnapshot()
+{
+    StageLatestBatch();
+    if (m_bStaged)
+        PublishStaged();
+    return m_snapshot;
+}
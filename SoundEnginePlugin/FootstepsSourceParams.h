@@ -1,90 +1,184 @@
-/*******************************************************************************
-The content of this file includes portions of the AUDIOKINETIC Wwise Technology
-released in source code form as part of the SDK installer package.
-
-Commercial License Usage
-
-Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
-may use this file in accordance with the end user license agreement provided
-with the software or, alternatively, in accordance with the terms contained in a
-written agreement between you and Audiokinetic Inc.
-
-Apache License Usage
-
-Alternatively, this file may be used under the Apache License, Version 2.0 (the
-"Apache License"); you may not use this file except in compliance with the
-Apache License. You may obtain a copy of the Apache License at
-http://www.apache.org/licenses/LICENSE-2.0.
-
-Unless required by applicable law or agreed to in writing, software distributed
-under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
-OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
-the specific language governing permissions and limitations under the License.
-
-  Copyright (c) 2021 Audiokinetic Inc.
-*******************************************************************************/
-
-#ifndef FootstepsSourceParams_H
-#define FootstepsSourceParams_H
-
-#include <AK/SoundEngine/Common/IAkPlugin.h>
-#include <AK/Plugin/PluginServices/AkFXParameterChangeHandler.h>
-
-// Add parameters IDs here, those IDs should map to the AudioEnginePropertyID
-// attributes in the xml property definition.
-static const AkPluginParamID PARAM_SHOE_ID = 0;
-static const AkPluginParamID PARAM_SURFACE_ID = 1;
-static const AkPluginParamID PARAM_TERRAIN_ID = 2;
-static const AkPluginParamID PARAM_PACE_ID = 3;
-static const AkPluginParamID PARAM_FIRMNESS_ID = 4;
-static const AkPluginParamID PARAM_STEADINESS_ID = 5;
-static const AkPluginParamID PARAM_AUTOMATED_ID = 6;
-
-static const AkUInt32 NUM_PARAMS = 7;
-
-struct FootstepsRTPCParams
-{
-    AkUInt32 fShoeType;
-    AkUInt32 fSurfaceType;
-    AkUInt32 fTerrain;
-    AkReal32 fPace;
-    AkReal32 fFirmness;
-    AkReal32 fSteadiness;
-    bool fAutomated;
-};
-
-struct FootstepsNonRTPCParams
-{
-};
-
-struct FootstepsSourceParams
-    : public AK::IAkPluginParam
-{
-    FootstepsSourceParams();
-    FootstepsSourceParams(const FootstepsSourceParams& in_rParams);
-
-    ~FootstepsSourceParams();
-
-    /// Create a duplicate of the parameter node instance in its current state.
-    IAkPluginParam* Clone(AK::IAkPluginMemAlloc* in_pAllocator) override;
-
-    /// Initialize the plug-in parameter node interface.
-    /// Initializes the internal parameter structure to default values or with the provided parameter block if it is valid.
-    AKRESULT Init(AK::IAkPluginMemAlloc* in_pAllocator, const void* in_pParamsBlock, AkUInt32 in_ulBlockSize) override;
-
-    /// Called by the sound engine when a parameter node is terminated.
-    AKRESULT Term(AK::IAkPluginMemAlloc* in_pAllocator) override;
-
-    /// Set all plug-in parameters at once using a parameter block.
-    AKRESULT SetParamsBlock(const void* in_pParamsBlock, AkUInt32 in_ulBlockSize) override;
-
-    /// Update a single parameter at a time and perform the necessary actions on the parameter changes.
-    AKRESULT SetParam(AkPluginParamID in_paramID, const void* in_pValue, AkUInt32 in_ulParamSize) override;
-
-    AK::AkFXParameterChangeHandler<NUM_PARAMS> m_paramChangeHandler;
-
-    FootstepsRTPCParams RTPC;
-    FootstepsNonRTPCParams NonRTPC;
-};
-
-#endif // FootstepsSourceParams_H
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2021 Audiokinetic Inc.
+*******************************************************************************/
+
+#ifndef FootstepsSourceParams_H
+#define FootstepsSourceParams_H
+
+#include <AK/SoundEngine/Common/IAkPlugin.h>
+
+#include <atomic>
+#include <mutex>
+
+// Add parameters IDs here, those IDs should map to the AudioEnginePropertyID
+// attributes in the xml property definition.
+static const AkPluginParamID PARAM_SHOE_ID = 0;
+static const AkPluginParamID PARAM_SURFACE_ID = 1;
+static const AkPluginParamID PARAM_TERRAIN_ID = 2;
+static const AkPluginParamID PARAM_PACE_ID = 3;
+static const AkPluginParamID PARAM_FIRMNESS_ID = 4;
+static const AkPluginParamID PARAM_STEADINESS_ID = 5;
+static const AkPluginParamID PARAM_AUTOMATED_ID = 6;
+static const AkPluginParamID PARAM_CROWDSIZE_ID = 7;
+static const AkPluginParamID PARAM_PACESPREAD_ID = 8;
+static const AkPluginParamID PARAM_STEADINESSSPREAD_ID = 9;
+static const AkPluginParamID PARAM_LOOKAHEADTIME_ID = 10;
+static const AkPluginParamID PARAM_ONESHOT_ID = 11;
+static const AkPluginParamID PARAM_CONVOLUTION_ID = 12;
+static const AkPluginParamID PARAM_PACETARGET_ID = 13;
+static const AkPluginParamID PARAM_PACECURVETIME_ID = 14;
+static const AkPluginParamID PARAM_FIRMNESSTARGET_ID = 15;
+static const AkPluginParamID PARAM_FIRMNESSCURVETIME_ID = 16;
+static const AkPluginParamID PARAM_CPUBUDGET_ID = 17;
+static const AkPluginParamID PARAM_MAXMODES_ID = 18;
+static const AkPluginParamID PARAM_RATEDIVISOR_ID = 19;
+static const AkPluginParamID PARAM_CRUNCH_ID = 20;
+static const AkPluginParamID PARAM_ENVELOPERESOLUTION_ID = 21;
+static const AkPluginParamID PARAM_BLENDSURFACE_ID = 22;
+static const AkPluginParamID PARAM_SURFACEBLEND_ID = 23;
+static const AkPluginParamID PARAM_IDLERELEASETIME_ID = 24;
+
+static const AkUInt32 NUM_PARAMS = 25;
+
+struct FootstepsRTPCParams
+{
+    AkUInt32 fShoeType;
+    AkUInt32 fSurfaceType;
+    AkUInt32 fTerrain;
+    AkReal32 fPace;
+    AkReal32 fFirmness;
+    AkReal32 fSteadiness;
+    bool fAutomated;
+    AkUInt32 fCrowdSize;
+    AkReal32 fPaceSpread;
+    AkReal32 fSteadinessSpread;
+    AkReal32 fPaceTarget; // glided to from fPace over fPaceCurveTime
+    AkReal32 fPaceCurveTime; // seconds, 0 disables the curve
+    AkReal32 fFirmnessTarget;
+    AkReal32 fFirmnessCurveTime;
+    AkUInt32 fBlendSurface; // surface fSurfaceType is blended towards
+    AkReal32 fSurfaceBlend; // 0 plays fSurfaceType, 1 plays fBlendSurface
+};
+
+struct FootstepsNonRTPCParams
+{
+    AkReal32 fLookaheadTime; // ms, 0 renders inline on the audio thread
+    bool fOneShot; // render a single step then end the voice
+    bool fConvolution; // convolve Wood, Hollow Wood and Metal with pre-rendered impulse responses, switching it on applies to the next voice
+    AkReal32 fCpuBudget; // % of each buffer's duration all footstep voices may render for, 0 never degrades them
+    // Quality tier, authored per platform
+    AkInt32 fMaxModes; // filter bank modes rendered
+    AkInt32 fRateDivisor; // the model runs at the output rate divided by this, applies to the next voice
+    bool fCrunch; // crunch grains on Concrete, Dirt and Grass
+    AkInt32 fEnvelopeResolution; // samples between two evaluations of the step envelopes
+    AkReal32 fIdleReleaseTime; // seconds before an unused ball path stops running and an unused separation delay, convolver or step cache is freed, 0 keeps them
+};
+
+// One complete set of parameter values, published at the start of a buffer and rendered by the audio thread
+struct FootstepsParamSnapshot
+{
+    FootstepsRTPCParams RTPC;
+    FootstepsNonRTPCParams NonRTPC;
+    AkUInt32 uSequence; // incremented on every publish, the same value means nothing changed
+};
+
+// Every parameter SetParams was given since the node was created, as SetParam takes them
+struct FootstepsParamBatch
+{
+    AkUInt32 uSequence; // of the last batch folded in
+    AkUInt32 uParamSequences[NUM_PARAMS]; // batch that last set each parameter, 0 if none did
+    AkUInt32 uSizes[NUM_PARAMS];
+    AkUInt32 Values[NUM_PARAMS]; // no property is wider than an AkReal32
+};
+
+// One parameter change of a batch given to SetParams, the value as SetParam takes it
+struct FootstepsParamValue
+{
+    AkPluginParamID ID;
+    const void* pValue;
+    AkUInt32 uSize;
+};
+
+struct FootstepsSourceParams
+    : public AK::IAkPluginParam
+{
+    FootstepsSourceParams();
+    FootstepsSourceParams(const FootstepsSourceParams& in_rParams);
+
+    ~FootstepsSourceParams();
+
+    /// Create a duplicate of the parameter node instance in its current state.
+    IAkPluginParam* Clone(AK::IAkPluginMemAlloc* in_pAllocator) override;
+
+    /// Initialize the plug-in parameter node interface.
+    /// Initializes the internal parameter structure to default values or with the provided parameter block if it is valid.
+    AKRESULT Init(AK::IAkPluginMemAlloc* in_pAllocator, const void* in_pParamsBlock, AkUInt32 in_ulBlockSize) override;
+
+    /// Called by the sound engine when a parameter node is terminated.
+    AKRESULT Term(AK::IAkPluginMemAlloc* in_pAllocator) override;
+
+    /// Set all plug-in parameters at once using a parameter block.
+    AKRESULT SetParamsBlock(const void* in_pParamsBlock, AkUInt32 in_ulBlockSize) override;
+
+    /// Update a single parameter at a time and perform the necessary actions on the parameter changes.
+    AKRESULT SetParam(AkPluginParamID in_paramID, const void* in_pValue, AkUInt32 in_ulParamSize) override;
+
+    /// Publishes several parameters at once, for writers off the audio thread whose changes must be rendered together.
+    /// Never waits for the audio thread, the batch is staged at the start of the next buffer.
+    AKRESULT SetParams(const FootstepsParamValue* in_pValues, AkUInt32 in_uNumValues);
+
+    /// Publishes what was staged since the last call and returns it, for the audio thread only, once per buffer.
+    /// Valid until the next call.
+    const FootstepsParamSnapshot& GetSnapshot();
+
+    // Values staged by SetParam and SetParamsBlock, and by the SetParams batches taken at the start of a buffer.
+    // The sound engine sets parameters on the audio thread, only the audio thread touches them.
+    FootstepsRTPCParams RTPC;
+    FootstepsNonRTPCParams NonRTPC;
+
+private:
+    AKRESULT StageParam(AkPluginParamID in_paramID, const void* in_pValue, AkUInt32 in_ulParamSize);
+    void StageLatestBatch();
+    void PublishStaged();
+
+    // Triple buffer between the SetParams writers and the audio thread. A writer folds its batch into m_writerBatch,
+    // copies it to the back slot and swaps that with the middle slot, tagged with the batch's sequence number. The
+    // audio thread swaps the middle slot with its front slot when the sequence moved on, then stages the parameters
+    // set since the batch it took last. Neither side ever waits for the other.
+    static const AkUInt32 BATCH_SLOT_BITS = 2;
+    static const AkUInt32 BATCH_SLOT_MASK = (1u << BATCH_SLOT_BITS) - 1;
+    FootstepsParamBatch m_batches[3];
+    std::atomic<AkUInt32> m_uMiddleBatch; // slot | sequence << BATCH_SLOT_BITS
+    AkUInt32 m_uBackBatch; // writers only
+    FootstepsParamBatch m_writerBatch; // writers only
+    std::mutex m_writerLock; // between SetParams writers, never taken by the audio thread
+    AkUInt32 m_uFrontBatch; // audio thread only
+    AkUInt32 m_uTakenBatch; // sequence of the batch the audio thread took last, the tag only keeps its low bits
+
+    bool m_bStaged; // changed since the last publish
+    FootstepsParamSnapshot m_snapshot;
+};
+
+#endif // FootstepsSourceParams_H
@@ -1,463 +1,1490 @@
-﻿#include "Generator.h"
-
-Generator::Generator()
-	: m_sampleRate(0)
-	, m_ShoeType(0)
-	, m_SurfaceType(0)
-	, m_Terrain(0)
-	, m_Pace(82.0f)
-	, m_Firmness(0.3f)
-	, m_Steadiness(0.1f)
-	, m_Automated(true)
-	, m_ShoeTypeChanged(false)
-	, m_SurfaceTypeChanged(false)
-	, m_TerrainChanged(false)
-	, m_PaceChanged(false)
-	, m_FirmnessChanged(false)
-	, m_SteadinessChanged(false)
-	, m_AutomatedChanged(false)
-{
-}
-
-Generator::~Generator()
-{
-}
-
-void Generator::PrepareModel(AkUInt32 in_sampleRate)
-{
-	//sample rate
-	m_sampleRate = in_sampleRate;
-	// init nemlib classes
-	HeelEnv = nemlib::CurveEnvelope(m_sampleRate, {}, {});
-	BallEnv = nemlib::CurveEnvelope(m_sampleRate, {}, {});
-	Noise = nemlib::WhiteNoiseGen();
-	Highpass = nemlib::BiquadFilter(m_sampleRate, 1000.0f, 1.0f, 0.0f, 1);
-	OutHP = nemlib::BiquadFilter(m_sampleRate, 100.0f, 1.0f, 0.0f, 1);
-	OutLP = nemlib::BiquadFilter(m_sampleRate, 10000.0f, 1.0f, 0.0f, 0);
-	Filters = nemlib::FilterBank(m_sampleRate, 9);
-	Filters.InitialiseFilterBank(Modes[0]);
-	Filters.Unmute(0.6f);
-	Distortion = nemlib::DistortionProcessor(200.0f);
-	CrunchBP = nemlib::BiquadFilter(m_sampleRate, 500.0f, 3.0f, 0.0f, 0);
-	CrunchEnv = nemlib::CurveEnvelope(m_sampleRate, {}, {});
-	SeparationDelay = nemlib::Delay(m_sampleRate, 0.02f);
-	CrunchTimer = nemlib::Timer(m_sampleRate, 0.1f);
-	CrunchTimer.ResumeTimer();
-
-	//model parameters
-	//ShoeType = m_pParams->RTPC.fShoe;
-	//SurfaceType = m_pParams->RTPC.fSurface;
-	//TerrainType = m_pParams->RTPC.fTerrain;
-	//Pace = m_pParams->RTPC.fPace;
-	//Steadiness = m_pParams->RTPC.fSteadiness;
-	//Firmness = m_pParams->RTPC.fFirmness;
-	//Automated = m_pParams->RTPC.fAutomated;
-
-	StepTimer = nemlib::Timer(m_sampleRate, 60.0f / m_Pace);
-
-	UpdatePaceModifiers(m_Pace);
-	UpdateShoeModifiers(m_ShoeType);
-	UpdateSurfaceModifiers(m_SurfaceType);
-	UpdateStepEnvelope();
-
-	if (m_Automated) {
-		StepTimer.ResetTimer();
-		StepTimer.ResumeTimer();
-	}
-
-	StepCounter = 0;
-}
-
-
-void Generator::UpdateStepEnvelope()
-{
-	//OutputDebugString(L"Process\n");
-	//Surface
-	VaryFilterBank();
-
-	//Automated
-	if (!m_Automated) {
-		if (StepCounter > 0) {
-			//CHECK THIS
-			UpdatePaceModifiers(60.0f / StepCounter);
-			StepTimer.SetTime(StepCounter);
-		}
-		StepCounter = 0.0f;
-	}
-	//Shoe Envelope
-	ShoeEnvelope NewShoeEnvelope = AddVariation();
-	/**
-	 TerrainType：Flat Surface or Upstairs
-	 */
-	if (m_Terrain == 0) {
-
-		float HeelGain = NewShoeEnvelope.HeelGain * HeelToBallRatio[0];
-		float HeelAttack = (NewShoeEnvelope.HeelAttack + Surface.HeelAttack) / 1000.0f;
-		float HeelDecay = (NewShoeEnvelope.HeelDecay + Surface.HeelDecay) / 1000.0f;
-		float HeelSustain = NewShoeEnvelope.HeelSustain + Surface.HeelSustain + 0.05f * nemlib::Vary(m_Firmness, m_Firmness);
-		float HeelRelease = (NewShoeEnvelope.HeelRelease + Surface.HeelRelease + 10.0f * nemlib::Vary(m_Firmness, 0.2f)) / 1000.0f;
-		float BallGain = NewShoeEnvelope.BallGain * HeelToBallRatio[1];
-		float BallAttack = (NewShoeEnvelope.BallAttack + Surface.BallAttack) / 1000.0f;
-		float BallSustain = NewShoeEnvelope.BallSustain + Surface.BallSustain;
-		float BallDecay = (NewShoeEnvelope.BallDecay + Surface.BallDecay) / 1000.0f;
-		float BallRelease = (NewShoeEnvelope.BallRelease + Surface.BallRelease) / 1000.0f;
-		float StepSeparation = NewShoeEnvelope.StepSeparation * (1.0f + RollSpeedPercentage / 10.0f) * (1.5f - 0.5f * m_Firmness) / 1000.0f;
-		HeelEnv.SetValues({ 0.0f, HeelGain, HeelSustain, 0.0f });
-		BallEnv.SetValues({ 0.0f, BallGain, BallSustain, 0.0f });
-		HeelEnv.SetTimes({ HeelAttack, HeelDecay, HeelRelease });
-		BallEnv.SetTimes({ BallAttack, BallDecay, BallRelease });
-		HeelEnv.ResetEnvelope();
-		BallEnv.ResetEnvelope();
-		SeparationDelay.SetDelay(StepSeparation);
-	}
-
-	else {
-
-		float BallGain = NewShoeEnvelope.BallGain * HeelToBallRatio[1];
-		float BallSustain = (NewShoeEnvelope.BallSustain + Surface.BallSustain) / 1000.0f;
-		float BallAttack = NewShoeEnvelope.BallAttack / 1000.0f;
-		float BallDecay = (NewShoeEnvelope.BallDecay + Surface.BallDecay) / 1000.0f;
-		float BallRelease = (NewShoeEnvelope.BallRelease + Surface.BallRelease) / 1000.0f;
-		HeelEnv.SetValues({ 0.0f, BallGain, BallSustain, 0.0f });
-		HeelEnv.SetTimes({ BallAttack, BallDecay, BallRelease });
-		HeelEnv.ResetEnvelope();
-	}
-}
-
-float Generator::IncrementTheModelChannel()
-{
-	if (m_Automated) {
-		if (StepTimer.checkTime() == true) {
-			UpdateStepEnvelope();
-			StepTimer.SetTime(nemlib::Vary(60.0f / m_Pace, m_Steadiness));
-			StepTimer.ResetTimer();
-			StepTimer.ResumeTimer();
-		}
-	}
-	else {
-		StepCounter += 1.0f / (float)m_sampleRate;
-	}
-
-	if (CrunchFlag) {
-		if (CrunchTimer.checkTime() == true) {
-			CrunchLoop();
-		}
-	}
-
-	float NoiseSample = Noise.NextSample();
-	float FilteredNoise = FiltersOut * Filters.ProcessSample(NoiseSample);
-	float Crunch = CrunchOut * CrunchEnv.GetNextEnvelopePoint() * CrunchBP.ProcessSample(Distortion.ProcessSample(NoiseSample));
-	float HeelOut = HeelEnv.GetNextEnvelopePoint() * (FilteredNoise + Crunch);
-	float BallOut = SeparationDelay.ProcessSample(Highpass.ProcessSample(BallEnv.GetNextEnvelopePoint() * (FilteredNoise + Crunch)));
-
-	LastOut = OutLP.ProcessSample(OutHP.ProcessSample(40.0f * (HeelOut + BallOut)));
-
-	float OutputSample = nemlib::Clamp(0.8f * LastOut, -0.5f, 0.5f);
-
-	return OutputSample;
-}
-
-void Generator::ExcuteModel(AkReal32* pBuf, AkUInt16 in_uValidFrames)
-{
-	//==========Ramp Block==========
-	//shoe
-	if (m_ShoeTypeChanged)
-	{
-		m_ShoeTypeChanged = false; 
-		//ParamChanged();
-	}
-	//surface
-	if (m_SurfaceTypeChanged)
-	{
-		m_SurfaceTypeChanged = false;
-		//ParamChanged();
-	}
-	//terrain
-	if (m_TerrainChanged)
-	{
-		m_TerrainChanged = false;
-		//ParamChanged();
-	}
-	//pace
-	AkReal32 m_PaceBegin = m_Pace, m_PaceEnd = 0.0f, m_PaceStep = 0.0f;
-	if (m_PaceChanged)
-	{
-		m_PaceEnd = m_Pace;
-		m_PaceStep = ((m_PaceEnd - m_PaceBegin) / in_uValidFrames);
-		m_PaceChanged = false;
-	}
-	//firmness
-	AkReal32 m_FirmnessBegin = m_Firmness, m_FirmnessEnd = 0.0f, m_FirmnessStep = 0.0f;
-	if (m_FirmnessChanged)
-	{
-		m_FirmnessEnd = m_Firmness;
-		m_FirmnessStep = ((m_FirmnessEnd - m_FirmnessBegin) / in_uValidFrames);
-		m_FirmnessChanged = false;
-		//ParamChanged();
-	}
-	//steadiness
-	AkReal32 m_SteadinessBegin = m_Steadiness, m_SteadinessEnd = 0.0f, m_SteadinessStep = 0.0f;
-	if (m_SteadinessChanged)
-	{
-		m_SteadinessBegin = m_Steadiness;
-		m_SteadinessEnd = m_Steadiness;
-		m_SteadinessStep = ((m_SteadinessEnd - m_SteadinessBegin) / in_uValidFrames);
-		m_SteadinessChanged = false;
-		//ParamChanged();
-	}
-	//automated
-	if (m_AutomatedChanged) m_AutomatedChanged = false;
-
-	//
-	//==========Output==========
-	AkUInt16 uFramesProduced = 0;
-	//OutputDebugString(L"Process\n");
-	while (uFramesProduced < in_uValidFrames)
-	{
-		m_Pace = m_PaceBegin;
-		m_Firmness = m_FirmnessBegin;
-		m_Steadiness = m_SteadinessBegin;
-
-
-		*pBuf++ = IncrementTheModelChannel();
-
-		m_PaceBegin += m_PaceStep;
-		m_FirmnessBegin += m_FirmnessStep;
-		m_SteadinessBegin += m_SteadinessStep;
-
-		++uFramesProduced;
-
-	}
-
-	m_Pace = m_PaceBegin;
-	m_Firmness = m_FirmnessBegin;
-	m_Steadiness = m_SteadinessBegin;
-
-}
-
-void Generator::SetShoeType(AkInt32 in_ShoeType)
-{
-	if (m_sampleRate > 0)
-	{
-		m_ShoeType = in_ShoeType;
-		UpdateShoeModifiers(m_ShoeType);
-		m_ShoeTypeChanged = true;
-	}
-}
-
-void Generator::SetSurfaceType(AkInt32 in_SurfaceType)
-{
-	if (m_sampleRate > 0)
-	{
-		m_SurfaceType = in_SurfaceType;
-		m_SurfaceTypeChanged = true;
-	}
-}
-
-void Generator::SetTerrain(AkInt32 in_Terrain)
-{
-	if (m_sampleRate > 0)
-	{
-		m_Terrain = in_Terrain;
-		//UpdateStepEnvelope();
-		m_TerrainChanged = true;
-	}
-}
-
-void Generator::SetPace(AkReal32 in_Pace)
-{
-	if (m_sampleRate > 0)
-	{
-		m_Pace = in_Pace;
-		UpdatePaceModifiers(m_Pace);
-		m_PaceChanged = true;
-	}
-}
-
-void Generator::SetFirmness(AkReal32 in_Firmness)
-{
-	if (m_sampleRate > 0)
-	{
-		m_Firmness = 1.0f - in_Firmness;
-		m_FirmnessChanged = true;
-	}
-}
-
-void Generator::SetSteadiness(AkReal32 in_Steadiness)
-{
-	if (m_sampleRate > 0)
-	{
-		m_Steadiness = in_Steadiness;
-		m_SteadinessChanged = true;
-	}
-}
-
-void Generator::SetAutomeated(bool in_Automated)
-{
-	if (m_sampleRate > 0)
-	{
-		m_Automated = in_Automated;
-
-		//UpdateStepEnvelope();
-		//StepTimer.SetTime(60.0f / m_Pace);
-		//StepTimer.ResetTimer();
-		//StepTimer.ResumeTimer();
-		m_AutomatedChanged = true;
-	}
-}
-
-
-void Generator::UpdatePaceModifiers(float Pace)
-{
-	if (m_Pace < 75.0f) { // Creeping
-		RollSpeedPercentage = 22.0f - (4.0f / 15.0f) * Pace;
-		HeelToBallRatio[0] = 0.5f;
-		HeelToBallRatio[1] = 0.4f;
-	}
-	else if (m_Pace < 120.0f) { // Walking
-		RollSpeedPercentage = (255.0f - Pace) / 90.0f;
-		HeelToBallRatio[0] = 1.0f;
-		HeelToBallRatio[1] = 0.8f;
-	}
-	else { // Running
-		RollSpeedPercentage = 1.5f;
-		HeelToBallRatio[0] = 1.0f;
-		HeelToBallRatio[1] = 0.63f;
-	}
-}
-
-void Generator::UpdateShoeModifiers(int ShoeType)
-{
-	switch (ShoeType) {
-	case 0:  // TRAINER
-		Shoe = { 1.0f, 1.0f, 0.0f, 10.0f, 0.1f, 40.0f, 0.5f, 1.0f, 0.0f, 20.0f, 0.1f };
-		break;
-	case 1:  // HIGH HEEL
-		Shoe = { 1.0f, 0.1f, 0.0f, 1.0f, 0.1f, 20.0f, 0.8f, 2.0f, 0.0f, 5.0f, 0.1f };
-		break;
-	case 2:  // OXFORD
-		Shoe = { 1.0f, 0.1f, 0.0f, 3.0f, 0.1f, 40.0f, 1.0f, 1.0f, 0.2f, 5.0f, 20.0f };
-		break;
-	case 3: // WORK BOOT
-		Shoe = { 1.0f, 1.27f, 0.0f, 21.4f, 0.1f, 40.0f, 0.429f, 12.7f, 0.0f, 37.5f, 0.1f };
-		break;
-	default:
-		Shoe = { 1.0f, 1.0f, 0.0f, 10.0f, 0.1f, 40.0f, 0.5f, 1.0f, 0.0f, 20.0f, 0.1f };
-	}
-}
-
-void Generator::UpdateSurfaceModifiers(int SurfaceType)
-{
-	CrunchFlag = false;
-	switch (SurfaceType) {
-	case 0:  // WOOD
-		Filters.InitialiseFilterBank(Modes[0]);
-		FiltersOut = 1.6f;
-		Surface = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
-		break;
-	case 1:  // CONCRETE
-		Filters.InitialiseFilterBank(Modes[1]);
-		FiltersOut = 0.8f;
-		CrunchFlag = true;
-		Freq1 = 1000.0f;
-		Freq2 = 200.0f;
-		Delay1 = 20.0f;
-		Delay2 = 4.0f;
-		CrunchOut = 0.1f;
-		Surface = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
-		break;
-	case 2: // DIRT
-		Filters.InitialiseFilterBank(Modes[2]);
-		FiltersOut = 0.1f;
-		CrunchFlag = true;
-		Freq1 = 200.0f;
-		Freq2 = 50.0f;
-		Delay1 = 20.0f;
-		Delay2 = 4.0f;
-		CrunchOut = 0.25f;
-		Surface = { 20.0f, 0.0f, 3.0f, 20.0f, 5.0f, 0.15f, 3.0f, 20.0f };
-		break;
-	case 3: // GRASS
-		Filters.InitialiseFilterBank(Modes[3]);
-		FiltersOut = 0.1f;
-		CrunchFlag = true;
-		Freq1 = 1500.0f;
-		Freq2 = 800.0f;
-		Delay1 = 20.0f;
-		Delay2 = 4.0f;
-		CrunchOut = 0.005f;
-		Surface = { 50.0f, 0.0f, 10.0f, 20.0f, 5.0f, 0.15f, 50.0f, 20.0f };
-		break;
-	case 4: // HOLLOW WOOD
-		Filters.InitialiseFilterBank(Modes[4]);
-		FiltersOut = 0.6f;
-		Surface = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
-		break;
-	case 5: // METAL
-		Filters.InitialiseFilterBank(Modes[5]);
-		FiltersOut = 0.6f;
-		Surface = { 0.0f, 0.1f, 0.0f, 10.0f, 0.0f, 0.1f, 0.0f, 10.0f };
-		break;
-	default:
-		Surface = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
-	}
-	if (CrunchFlag) {
-		CrunchLoop();
-	}
-}
-
-void Generator::CrunchLoop()
-{
-	CrunchBP.SetFrequency((float(rand()) / float(RAND_MAX)) * (Freq1 - Freq2) + Freq1);
-	CrunchBP.SetQFactor((float(rand()) / float(RAND_MAX)) * 7.0f + 3.0f);
-	CrunchEnv.ResetEnvelope();
-	CrunchEnv.SetValues({ 0.0f, (float(rand()) / float(RAND_MAX)) + 0.7f, 0.0f });
-	CrunchEnv.SetTimes({ (float(rand()) / float(RAND_MAX)) * 0.0001f + 0.0001f, (float(rand()) / float(RAND_MAX)) * 0.0342f + 0.0102f });
-	CrunchTimer.SetTime((Delay1 + (float(rand()) / float(RAND_MAX)) * (Delay1 - Delay2)) / 1000.0f);
-	CrunchTimer.ResetTimer();
-}
-
-void Generator::VaryFilterBank()
-{
-	switch (m_SurfaceType) {
-	case 0: //wood
-		Filters.VaryParameters(Modes[0]);
-		break;
-	case 1: //concrete
-		Filters.VaryParameters(Modes[1]);
-		break;
-	case 2: // dirt
-		Filters.VaryParameters(Modes[2]);
-		break;
-	case 3: // grass
-		Filters.VaryParameters(Modes[3]);
-		break;
-	case 4: // hollow wood
-		Filters.VaryParameters(Modes[4]);
-		break;
-	case 5: // metal
-		Filters.VaryParameters(Modes[5]);
-		break;
-	default:
-		break;
-	}
-}
-
-ShoeEnvelope Generator::AddVariation()
-{
-	ShoeEnvelope NewShoeEnvelope = {
-	nemlib::Vary(Shoe.HeelGain, 0.02f),
-	nemlib::Vary(Shoe.HeelAttack, 0.05f),
-	nemlib::Vary(Shoe.HeelSustain, 0.01f),
-	nemlib::Vary(Shoe.HeelDecay, 0.1f),
-	nemlib::Vary(Shoe.HeelRelease, 0.05f),
-	nemlib::Vary(Shoe.StepSeparation, 0.05f),
-	nemlib::Vary(Shoe.BallGain, 0.15f),
-	nemlib::Vary(Shoe.BallAttack, 0.1f),
-	nemlib::Vary(Shoe.BallSustain, 0.01f),
-	nemlib::Vary(Shoe.BallDecay, 0.1f),
-	nemlib::Vary(Shoe.BallRelease, 0.05f)
-	};
-	return NewShoeEnvelope;
-}
-
+﻿#include "Generator.h"
+#include "SignalGraph.h"
+
+#include <type_traits>
+
+// The per-sample components hold no heap memory, so voices stay compact and cheap to copy
+static_assert(std::is_trivially_copyable<nemlib::CurveEnvelope>::value, "CurveEnvelope must stay trivially copyable");
+static_assert(std::is_trivially_copyable<nemlib::FilterBank>::value, "FilterBank must stay trivially copyable");
+static_assert(std::is_trivially_copyable<nemlib::BiquadFilter>::value, "BiquadFilter must stay trivially copyable");
+static_assert(std::is_trivially_copyable<nemlib::Timer>::value, "Timer must stay trivially copyable");
+static_assert(std::is_trivially_copyable<nemlib::GrainPlayer>::value, "GrainPlayer must stay trivially copyable");
+
+// Resonant modes of each surface, the filter bank is varied around them on every step
+const nemlib::Mode Generator::Modes[NUM_SURFACES] = {
+	{ // Wood
+		9,
+		{ 0, 2, 2, 2, 2, 2, 2, 2, 2 },
+		{ 80.0f, 95.0f, 134.0f, 139.0f, 154.0f, 201.0f, 123.0f, 156.0f, 189.0f },
+		{ 20.0f, 20.0f, 20.0f, 20.0f, 20.0f, 15.0f, 10.0f, 20.0f, 20.0f },
+		{ 0.2f, 0.1f, 0.1f, 0.1f, 0.1f, 0.2f, 0.2f, 0.2f, 0.2f }
+	},
+	{ // Concrete
+		5,
+		{ 0, 2, 2, 2, 2 },
+		{ 140.0f, 234.0f, 380.0f, 1450.0f, 2156.0f },
+		{ 10.0f, 10.0f, 10.0f, 10.0f, 10.0f },
+		{ 0.1f, 0.2f, 0.1f, 0.05f, 0.05f }
+	},
+	{ // Dirt
+		4,
+		{ 2, 2, 2, 0 } ,
+		{ 180.0f, 300.0f, 650.0f, 2200.0f },
+		{ 2.0f, 2.0f, 2.0f, 1.0f },
+		{ 0.6f, 0.1f, 0.1f, 0.1f }
+	},
+	{ // Grass
+		3,
+		{ 1, 2, 0 },
+		{ 890.0f, 2023.0f, 3000.0f },
+		{ 3.5f, 2.0f, 2.0f },
+		{ 0.05f, 0.05f, 0.05f }
+	},
+	{ // Hollow Wood
+		4,
+		{ 2, 2, 2, 2},
+		{ 109.0f, 230.0f, 352.0f, 413.0f },
+		{ 10.0f, 10.0f, 10.0f, 10.0f },
+		{ 1.0f, 1.0f, 1.0f, 1.0f }
+	},
+	{ // Metal
+		7,
+		{ 2, 2, 2, 2, 2, 2, 2 },
+		{ 124.0f,  218.0f,  615.0f,  1098.0f,  1250.0f,  1764.0f,  2682.0f },
+		{ 2.0f, 60.0f, 60.0f, 60.0f, 60.0f, 60.0f, 60.0f },
+		{ 1.0f, 0.80f, 0.65f, 0.50f, 0.35f, 0.20f, 0.05f }
+	}
+};
+
+// Envelope modifiers, levels and crunch of each surface, in the same order as Modes
+const SurfaceProfile Generator::SurfaceProfiles[NUM_SURFACES] = {
+	{ { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f }, 1.6f, true, false, 0.0f, 0.0f, 0.0f }, // Wood
+	{ { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f }, 0.8f, false, true, 0.1f, 20.0f, 4.0f }, // Concrete
+	{ { 20.0f, 0.0f, 3.0f, 20.0f, 5.0f, 0.15f, 3.0f, 20.0f }, 0.1f, false, true, 0.25f, 20.0f, 4.0f }, // Dirt
+	{ { 50.0f, 0.0f, 10.0f, 20.0f, 5.0f, 0.15f, 50.0f, 20.0f }, 0.1f, false, true, 0.005f, 20.0f, 4.0f }, // Grass
+	{ { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f }, 0.6f, true, false, 0.0f, 0.0f, 0.0f }, // Hollow Wood
+	{ { 0.0f, 0.1f, 0.0f, 10.0f, 0.0f, 0.1f, 0.0f, 10.0f }, 0.6f, true, false, 0.0f, 0.0f, 0.0f } // Metal
+};
+
+static float Lerp(float in_From, float in_To, float in_Amount)
+{
+	return in_From + (in_To - in_From) * in_Amount;
+}
+
+// Idle counters saturate instead of wrapping after a day of rendering
+static AkUInt32 AddIdleFrames(AkUInt32 in_uIdleFrames, AkUInt32 in_uFrames)
+{
+	return in_uIdleFrames > 0xFFFFFFFF - in_uFrames ? 0xFFFFFFFF : in_uIdleFrames + in_uFrames;
+}
+
+// Signal paths RenderFused has a graph for
+enum FusedPath : int {
+	FUSED_PATH_NONE = 0, // rendered one sample at a time
+	FUSED_PATH_HEEL, // ball path idle
+	FUSED_PATH_BALL // ball through the high pass and separation delay
+};
+
+Generator::Generator()
+	: m_sampleRate(0)
+	, m_outputRate(0)
+	, m_RateDivisor(1)
+	, m_ShoeType(0)
+	, m_SurfaceType(0)
+	, m_Terrain(0)
+	, m_Pace(82.0f)
+	, m_Firmness(0.3f)
+	, m_Steadiness(0.1f)
+	, m_Automated(true)
+	, m_CrowdSize(1)
+	, m_PaceSpread(0.1f)
+	, m_SteadinessSpread(0.2f)
+	, m_Convolution(false)
+	, m_BlendSurface(0)
+	, m_SurfaceBlend(0.0f)
+{
+}
+
+Generator::~Generator()
+{
+}
+
+bool Generator::PrepareModel(AkUInt32 in_sampleRate, AK::IAkPluginMemAlloc* in_pAllocator, AkInt32 in_RateDivisor)
+{
+	//sample rate
+	m_outputRate = in_sampleRate;
+	m_RateDivisor = nemlib::Clamp((int)in_RateDivisor, 1, (int)MAX_RATE_DIVISOR);
+	m_sampleRate = m_outputRate / m_RateDivisor;
+	// White noise at a lower rate packs the same power in less bandwidth, keep the resonators and grains at the same level
+	NoiseGain = 1.0f / sqrtf((float)m_RateDivisor);
+	// buffers go back to their arenas before these are reused, the delay and convolver are prepared again by PrepareSubsystems
+	SeparationDelay = nemlib::Delay();
+	Convolver.Release();
+	std::fill(std::begin(ImpulseBanks), std::end(ImpulseBanks), nullptr);
+	ConvolutionArena.Release();
+	StepCache.Release();
+	CacheArena.Release();
+	if (MemAllocator.GetPluginAllocator() != in_pAllocator) {
+		CoreArena.Release();
+		MemAllocator.SetPluginAllocator(in_pAllocator);
+	}
+	// init nemlib classes
+	HeelEnv = nemlib::CurveEnvelope(m_sampleRate, {}, {});
+	BallEnv = nemlib::CurveEnvelope(m_sampleRate, {}, {});
+	Noise = nemlib::WhiteNoiseGen();
+	Noise.SetSeed(Rng.NextUInt());
+	VariationRng.SetSeed(Rng.NextUInt());
+	Highpass = nemlib::BiquadFilter(m_sampleRate, 1000.0f, 1.0f, 0.0f, 1);
+	OutHP = nemlib::BiquadFilter(m_sampleRate, 100.0f, 1.0f, 0.0f, 1);
+	OutLP = nemlib::BiquadFilter(m_sampleRate, 10000.0f, 1.0f, 0.0f, 0);
+	Filters = nemlib::FilterBank(m_sampleRate, 9);
+	ResetFilterVariations();
+	CrunchBank = nullptr;
+	// The ball path stays dormant until the first step with a ball
+	BallPathActive = false;
+	BallPathIdleFrames = 0;
+	ConvolverIdleFrames = 0;
+	StepCacheIdleFrames = 0;
+
+	ResetModel();
+	return true;
+}
+
+void Generator::PrepareSubsystems(const GeneratorSubsystems& in_Subsystems)
+{
+	SetIdleReleaseTime(in_Subsystems.IdleReleaseTime);
+	ReleaseIdleSubsystems();
+
+	// Out of memory is not fatal, the voice does without
+	if (in_Subsystems.Terrain == 0 && (in_Subsystems.CrowdSize <= 1 || in_Subsystems.OneShot)) {
+		PrepareBallPath();
+	}
+	RequestCrunchBank(in_Subsystems.SurfaceType);
+	RequestCrunchBank(in_Subsystems.BlendSurface);
+	if (in_Subsystems.Convolution) {
+		PrepareConvolver();
+	}
+	if (in_Subsystems.StepCache) {
+		PrepareStepCache();
+	}
+}
+
+void Generator::ReleaseIdleSubsystems()
+{
+	if (IdleReleaseFrames == 0) {
+		return;
+	}
+	// Each is prepared again by the next PrepareSubsystems that needs it, the separation delay also by PrepareBallPath
+	if (SeparationDelay.IsAllocated() && !BallPathActive && BallPathIdleFrames >= IdleReleaseFrames) {
+		SeparationDelay = nemlib::Delay();
+		CoreArena.Release();
+	}
+	if (Convolver.IsPrepared() && ImpulseBank == nullptr && !Convolver.IsActive() && ConvolverIdleFrames >= IdleReleaseFrames) {
+		Convolver.Release();
+		std::fill(std::begin(ImpulseBanks), std::end(ImpulseBanks), nullptr);
+		ConvolutionArena.Release();
+	}
+	if (StepCache.Size() > 0 && QualityLevel < GENERATOR_QUALITY_CACHED_STEPS && !CachePlayer.IsPlaying() && StepCacheIdleFrames >= IdleReleaseFrames) {
+		StepCache.Release();
+		StepCacheValid = false;
+		StepCacheRecording = false;
+		CacheArena.Release();
+	}
+}
+
+void Generator::ResetModel()
+{
+	FOOTSTEPS_TRACE(Trace, TRACE_EVENT_RESET, (AkUInt64)m_outputRate);
+	//default parameters, the owner re-applies its own afterwards
+	m_ShoeType = 0;
+	m_SurfaceType = 0;
+	m_Terrain = 0;
+	m_Pace = 82.0f;
+	m_Firmness = 0.3f;
+	m_Steadiness = 0.1f;
+	m_Automated = true;
+	m_CrowdSize = 1;
+	m_PaceSpread = 0.1f;
+	m_SteadinessSpread = 0.2f;
+	m_Convolution = false;
+	m_BlendSurface = 0;
+	m_SurfaceBlend = 0.0f;
+	PaceCurve.Stop();
+	FirmnessCurve.Stop();
+	QualityLevel = GENERATOR_QUALITY_FULL;
+	Tier = { nemlib::MAX_FILTERBANK_FILTERS, true, 1 };
+	IdleReleaseFrames = (AkUInt32)(DEFAULT_IDLE_RELEASE_TIME * (float)m_outputRate);
+	Filters.SetMaxActiveFilters(GetMaxModes());
+	HeelEnv.SetResolution(Tier.EnvelopeResolution);
+	BallEnv.SetResolution(Tier.EnvelopeResolution);
+	CachePlayer.Stop();
+	StepCacheValid = false;
+	StepCacheRecording = false;
+	SynthesisActive = true;
+	SynthesisDrainFrames = 0;
+	UpsamplePrevious = 0.0f;
+	UpsampleCurrent = 0.0f;
+	UpsamplePhase = 0;
+
+	// clear filter and delay state left by a previous voice
+	Highpass.ResetFilter();
+	OutHP.ResetFilter();
+	OutLP.ResetFilter();
+	CrunchGrains.Stop();
+	Convolver.Reset();
+	SeparationDelay.Clear(MAX_STEP_SEPARATION);
+	Filters.InitialiseFilterBank(Modes[0]);
+	Filters.Unmute(FILTER_BANK_GAIN);
+	SurfaceBlended = false;
+	SurfaceBlendChanged = false;
+	CrunchBlend = 0.0f;
+	CrunchOut = 0.0f;
+	FiltersOut = 1.0f;
+	LastOut = 0.0f;
+	CrunchTimer = nemlib::Timer(m_sampleRate, 0.1f);
+	CrunchTimer.ResumeTimer();
+
+	StepTimer = nemlib::Timer(m_sampleRate, 60.0f / m_Pace);
+
+	UpdatePaceModifiers(m_Pace);
+	UpdateShoeModifiers(m_ShoeType);
+	UpdateSurfaceModifiers(m_SurfaceType);
+	UpdateStepEnvelope();
+
+	if (m_Automated) {
+		StepTimer.ResetTimer();
+		StepTimer.ResumeTimer();
+	}
+
+	StepCounter = 0;
+	OneShot = false;
+
+	NumWalkers = 0;
+	SetCrowdSize(m_CrowdSize);
+}
+
+void Generator::SetSeed(AkUInt32 in_Seed)
+{
+	Rng.SetSeed(in_Seed);
+}
+
+StepShape Generator::UpdateStepEnvelope()
+{
+	//Surface
+	VaryFilterBank();
+
+	//Automated
+	if (!m_Automated) {
+		if (StepCounter > 0) {
+			//CHECK THIS
+			UpdatePaceModifiers(60.0f / StepCounter);
+			StepTimer.SetTime(StepCounter);
+		}
+		StepCounter = 0.0f;
+	}
+	//Shoe Envelope
+	StepShape Step = MakeStepShape();
+	HeelEnv.SetValues({ 0.0f, Step.HeelGain, Step.HeelSustain, 0.0f });
+	HeelEnv.SetTimes({ Step.HeelAttack, Step.HeelDecay, Step.HeelRelease });
+	HeelEnv.ResetEnvelope();
+	if (Step.HasBall) {
+		BallEnv.SetValues({ 0.0f, Step.BallGain, Step.BallSustain, 0.0f });
+		BallEnv.SetTimes({ Step.BallAttack, Step.BallDecay, Step.BallRelease });
+		BallEnv.ResetEnvelope();
+		WakeBallPath(Step.StepSeparation);
+	}
+	// Every step lands with a grain, the rest follow from CrunchTimer while the envelopes last
+	if (UseCrunch()) {
+		CrunchLoop();
+	}
+	return Step;
+}
+
+float Generator::TriggerOneShot()
+{
+	// A single walker taking a single step, the step timer stays paused afterwards
+	OneShot = true;
+	NumWalkers = 0;
+	StepTimer.PauseTimer();
+	FOOTSTEPS_TRACE(Trace, TRACE_EVENT_STEP, 0);
+	StepShape Step = UpdateStepEnvelope();
+
+	float HeelLength = Step.HeelAttack + Step.HeelDecay + Step.HeelRelease;
+	float BallLength = Step.HasBall ? Step.StepSeparation + Step.BallAttack + Step.BallDecay + Step.BallRelease : 0.0f;
+	float RingTime = ONE_SHOT_RING_TIME;
+	if (ImpulseBank != nullptr) {
+		RingTime += (float)(ImpulseBank->GetLength() + Convolver.GetLatency()) / (float)m_sampleRate;
+	}
+	return std::max(HeelLength, BallLength) + RingTime;
+}
+
+StepShape Generator::MakeStepShape()
+{
+	ShoeEnvelope NewShoeEnvelope = AddVariation();
+	StepShape Step = {};
+	/**
+	 TerrainType：Flat Surface or Upstairs
+	 */
+	if (m_Terrain == 0) {
+
+		Step.HeelGain = NewShoeEnvelope.HeelGain * HeelToBallRatio[0];
+		Step.HeelAttack = (NewShoeEnvelope.HeelAttack + Surface.HeelAttack) / 1000.0f;
+		Step.HeelDecay = (NewShoeEnvelope.HeelDecay + Surface.HeelDecay) / 1000.0f;
+		Step.HeelSustain = NewShoeEnvelope.HeelSustain + Surface.HeelSustain + 0.05f * nemlib::Vary(m_Firmness, m_Firmness, Rng);
+		Step.HeelRelease = (NewShoeEnvelope.HeelRelease + Surface.HeelRelease + 10.0f * nemlib::Vary(m_Firmness, 0.2f, Rng)) / 1000.0f;
+		Step.BallGain = NewShoeEnvelope.BallGain * HeelToBallRatio[1];
+		Step.BallAttack = (NewShoeEnvelope.BallAttack + Surface.BallAttack) / 1000.0f;
+		Step.BallSustain = NewShoeEnvelope.BallSustain + Surface.BallSustain;
+		Step.BallDecay = (NewShoeEnvelope.BallDecay + Surface.BallDecay) / 1000.0f;
+		Step.BallRelease = (NewShoeEnvelope.BallRelease + Surface.BallRelease) / 1000.0f;
+		Step.StepSeparation = NewShoeEnvelope.StepSeparation * (1.0f + RollSpeedPercentage / 10.0f) * (1.5f - 0.5f * m_Firmness) / 1000.0f;
+		Step.HasBall = true;
+	}
+
+	else {
+		// Upstairs steps only land on the ball of the foot, which is played through the heel envelope
+		Step.HeelGain = NewShoeEnvelope.BallGain * HeelToBallRatio[1];
+		Step.HeelSustain = (NewShoeEnvelope.BallSustain + Surface.BallSustain) / 1000.0f;
+		Step.HeelAttack = NewShoeEnvelope.BallAttack / 1000.0f;
+		Step.HeelDecay = (NewShoeEnvelope.BallDecay + Surface.BallDecay) / 1000.0f;
+		Step.HeelRelease = (NewShoeEnvelope.BallRelease + Surface.BallRelease) / 1000.0f;
+		Step.HasBall = false;
+	}
+	return Step;
+}
+
+float Generator::IncrementTheModelChannel()
+{
+	if (NumWalkers > 0) {
+		return IncrementTheCrowdChannel();
+	}
+
+	ScheduleSample();
+	FOOTSTEPS_PROFILE_LAP(Profiler, PROFILE_STAGE_SCHEDULING);
+	return SynthesizeSample();
+}
+
+bool Generator::ScheduleSample()
+{
+	bool Stepped = false;
+	if (m_Automated) {
+		if (StepTimer.checkTime() == true) {
+			TriggerStep();
+			Stepped = true;
+		}
+	}
+	else {
+		StepCounter += 1.0f / (float)m_sampleRate;
+	}
+
+	// Grains are only scheduled under a step, the crunch is silent between them anyway
+	if (UseCrunch() && (HeelEnv.IsActive() || BallEnv.IsActive())) {
+		if (CrunchTimer.checkTime() == true) {
+			CrunchLoop();
+		}
+	}
+	return Stepped;
+}
+
+float Generator::SynthesizeSample()
+{
+	// In convolution mode the surface resonance is applied after the envelopes, by the convolver
+	float NoiseSample = NoiseGain * Noise.NextSample();
+	FOOTSTEPS_PROFILE_LAP(Profiler, PROFILE_STAGE_NOISE);
+	float FilteredNoise = FiltersOut * (ImpulseBank != nullptr ? FILTER_BANK_GAIN * NoiseSample : Filters.ProcessSample(NoiseSample));
+	FOOTSTEPS_PROFILE_LAP(Profiler, PROFILE_STAGE_FILTERBANK);
+	float Crunch = NoiseGain * CrunchOut * CrunchGrains.ProcessSample();
+	FOOTSTEPS_PROFILE_LAP(Profiler, PROFILE_STAGE_CRUNCH);
+	float HeelGain = HeelEnv.GetNextEnvelopePoint();
+	float BallGain = BallEnv.GetNextEnvelopePoint();
+	FOOTSTEPS_PROFILE_LAP(Profiler, PROFILE_STAGE_ENVELOPES);
+	float HeelOut = HeelGain * (FilteredNoise + Crunch);
+	float BallOut = 0.0f;
+	if (BallPathActive) {
+		BallOut = SeparationDelay.ProcessSample(Highpass.ProcessSample(BallGain * (FilteredNoise + Crunch)));
+	}
+	FOOTSTEPS_PROFILE_LAP(Profiler, PROFILE_STAGE_SEPARATION);
+	float StepOut = HeelOut + BallOut;
+	if (ImpulseBank != nullptr) {
+		StepOut = Convolver.ProcessSample(StepOut);
+	}
+	else if (Convolver.IsActive()) {
+		StepOut += Convolver.ProcessSample(0.0f);
+	}
+	FOOTSTEPS_PROFILE_LAP(Profiler, PROFILE_STAGE_CONVOLVER);
+
+	LastOut = OutLP.ProcessSample(OutHP.ProcessSample(40.0f * StepOut));
+
+	float OutputSample = nemlib::Clamp(0.8f * LastOut, -0.5f, 0.5f);
+	FOOTSTEPS_PROFILE_LAP(Profiler, PROFILE_STAGE_OUTPUT);
+
+	return OutputSample;
+}
+
+int Generator::GetFusedPath() const
+{
+#if FOOTSTEPS_PROFILE_STAGES
+	// The stage laps need the samples one at a time
+	return FUSED_PATH_NONE;
+#else
+	if (m_RateDivisor != 1 || NumWalkers > 0 || !SynthesisActive || QualityLevel >= GENERATOR_QUALITY_CACHED_STEPS
+		|| StepCacheRecording || CachePlayer.IsPlaying() || ImpulseBank != nullptr || Convolver.IsActive()) {
+		return FUSED_PATH_NONE;
+	}
+	return BallPathActive ? FUSED_PATH_BALL : FUSED_PATH_HEEL;
+#endif
+}
+
+AkUInt32 Generator::RenderFused(AkReal32* pBuf, AkUInt32 in_uFrames)
+{
+	// SynthesizeSample() as a graph, the same operations in the same order so both render the same samples.
+	// Only called while GetFusedPath() has a path
+	const int Path = GetFusedPath();
+	auto Excitation = nemlib::Parameter(FiltersOut) * (nemlib::Parameter(NoiseGain) * nemlib::Generate(Noise) >> nemlib::Process(Filters))
+		+ nemlib::Parameter(NoiseGain) * nemlib::Parameter(CrunchOut) * nemlib::Play(CrunchGrains);
+	auto Heel = nemlib::Envelope(HeelEnv) * nemlib::Input();
+	auto Output = 40.0f * nemlib::Input() >> nemlib::Process(OutHP) >> nemlib::Process(OutLP) >> nemlib::Store(LastOut)
+		>> 0.8f * nemlib::Input() >> nemlib::Limit(-0.5f, 0.5f);
+
+	// Steps are triggered between samples, one that changes the path ends the run
+	auto Control = [this, Path]() {
+		const bool Continue = !ScheduleSample() || GetFusedPath() == Path;
+		FOOTSTEPS_TRACE_NEXT_FRAME(Trace);
+		return Continue;
+	};
+	int Frames = 0;
+	if (Path == FUSED_PATH_BALL) {
+		auto Ball = nemlib::Envelope(BallEnv) * nemlib::Input() >> nemlib::Process(Highpass) >> nemlib::Process(SeparationDelay);
+		auto Graph = Excitation >> (Heel + Ball) >> Output;
+		Frames = nemlib::RenderGraph(Graph, pBuf, (int)in_uFrames, Control);
+	}
+	else {
+		auto Graph = Excitation >> (Heel + nemlib::Constant(0.0f)) >> Output;
+		Frames = nemlib::RenderGraph(Graph, pBuf, (int)in_uFrames, Control);
+	}
+	if (Frames < (int)in_uFrames) {
+		// Already scheduled
+		pBuf[Frames++] = SynthesizeSample();
+	}
+	return (AkUInt32)Frames;
+}
+
+float Generator::IncrementTheCrowdChannel()
+{
+	// Every walker only contributes envelope gain, the excitation and resonators are shared
+	float HeelGain = 0.0f;
+	float BallGain = 0.0f;
+	bool StepActive = false;
+	for (int i = 0; i < NumWalkers; i++) {
+		CrowdWalker& Walker = Walkers[i];
+		// Like the single walker, a crowd that is not automated only lets the steps in flight play out
+		if (m_Automated && Walker.StepTimer.checkTime() == true) {
+			TriggerWalkerStep(Walker);
+		}
+		if (Walker.BallTimer.checkTime() == true) {
+			TriggerWalkerBall(Walker);
+		}
+		StepActive = StepActive || Walker.HeelEnv.IsActive() || Walker.BallEnv.IsActive();
+		HeelGain += Walker.HeelEnv.GetNextEnvelopePoint();
+		BallGain += Walker.BallEnv.GetNextEnvelopePoint();
+	}
+	FOOTSTEPS_PROFILE_LAP(Profiler, PROFILE_STAGE_ENVELOPES);
+
+	if (UseCrunch() && StepActive) {
+		if (CrunchTimer.checkTime() == true) {
+			CrunchLoop();
+		}
+	}
+	FOOTSTEPS_PROFILE_LAP(Profiler, PROFILE_STAGE_SCHEDULING);
+
+	float NoiseSample = NoiseGain * Noise.NextSample();
+	FOOTSTEPS_PROFILE_LAP(Profiler, PROFILE_STAGE_NOISE);
+	float FilteredNoise = FiltersOut * (ImpulseBank != nullptr ? FILTER_BANK_GAIN * NoiseSample : Filters.ProcessSample(NoiseSample));
+	FOOTSTEPS_PROFILE_LAP(Profiler, PROFILE_STAGE_FILTERBANK);
+	float Crunch = NoiseGain * CrunchOut * CrunchGrains.ProcessSample();
+	FOOTSTEPS_PROFILE_LAP(Profiler, PROFILE_STAGE_CRUNCH);
+	float HeelOut = HeelGain * (FilteredNoise + Crunch);
+	// The ball onsets are already delayed per walker, so the shared ball path has no separation delay
+	float BallOut = Highpass.ProcessSample(BallGain * (FilteredNoise + Crunch));
+	FOOTSTEPS_PROFILE_LAP(Profiler, PROFILE_STAGE_SEPARATION);
+	float StepOut = HeelOut + BallOut;
+	if (ImpulseBank != nullptr) {
+		StepOut = Convolver.ProcessSample(StepOut);
+	}
+	else if (Convolver.IsActive()) {
+		StepOut += Convolver.ProcessSample(0.0f);
+	}
+	FOOTSTEPS_PROFILE_LAP(Profiler, PROFILE_STAGE_CONVOLVER);
+
+	LastOut = OutLP.ProcessSample(OutHP.ProcessSample(40.0f * CrowdGain * StepOut));
+
+	float OutputSample = nemlib::Clamp(0.8f * LastOut, -0.5f, 0.5f);
+	FOOTSTEPS_PROFILE_LAP(Profiler, PROFILE_STAGE_OUTPUT);
+
+	return OutputSample;
+}
+
+void Generator::TriggerStep()
+{
+	if (StepCacheRecording) {
+		FinishStepRecording();
+	}
+	if (QualityLevel >= GENERATOR_QUALITY_CACHED_STEPS && StepCacheValid) {
+		TriggerCachedStep();
+	}
+	else {
+		FOOTSTEPS_TRACE(Trace, TRACE_EVENT_STEP, 0);
+		BeginStepRecording();
+		UpdateStepEnvelope();
+	}
+	StepTimer.SetTime(nemlib::Vary(60.0f / m_Pace, m_Steadiness, Rng));
+	StepTimer.ResetTimer();
+	StepTimer.ResumeTimer();
+}
+
+void Generator::Advance(AkUInt32 in_uFrames)
+{
+	// Jump to the next frame on which a step timer fires and play that frame's events like the render
+	// path does, so steps land on the same frames. Crunch grains are not scheduled while skipping,
+	// they only texture the steps and resume with the next audible one.
+	UpdateCurves(in_uFrames);
+
+	// The model frames the render would have started over these output frames. What is left of a model frame
+	// carries over in UpsamplePhase, so skips that are not a multiple of the divisor keep the steps on time
+	const AkUInt32 uDivisor = (AkUInt32)m_RateDivisor;
+	const AkUInt32 uPhase = (AkUInt32)UpsamplePhase;
+	const AkUInt32 uFirstFrame = (uDivisor - uPhase) % uDivisor;
+	const AkUInt32 uModelFrames = in_uFrames > uFirstFrame ? (in_uFrames - uFirstFrame + uDivisor - 1) / uDivisor : 0;
+	AkUInt32 uFramesLeft = uModelFrames;
+	while (uFramesLeft > 0) {
+		const AkUInt32 uNextEvent = FramesToNextEvent();
+		AkUInt32 uSkip = uNextEvent == NO_PENDING_EVENT ? uFramesLeft : std::min(uFramesLeft, uNextEvent);
+		SkipFrames(uSkip);
+		uFramesLeft -= uSkip;
+		if (uFramesLeft == 0) {
+			break;
+		}
+		FOOTSTEPS_TRACE_FRAME(Trace, uFirstFrame + (uModelFrames - uFramesLeft) * uDivisor);
+
+		if (NumWalkers > 0) {
+			for (int i = 0; i < NumWalkers; i++) {
+				CrowdWalker& Walker = Walkers[i];
+				if (m_Automated && Walker.StepTimer.checkTime() == true) {
+					TriggerWalkerStep(Walker);
+				}
+				if (Walker.BallTimer.checkTime() == true) {
+					TriggerWalkerBall(Walker);
+				}
+				Walker.HeelEnv.GetNextEnvelopePoint();
+				Walker.BallEnv.GetNextEnvelopePoint();
+			}
+		}
+		else {
+			if (m_Automated && StepTimer.checkTime() == true) {
+				TriggerStep();
+			}
+			HeelEnv.GetNextEnvelopePoint();
+			BallEnv.GetNextEnvelopePoint();
+		}
+		uFramesLeft--;
+	}
+
+	if (!m_Automated && NumWalkers == 0) {
+		StepCounter += (float)uModelFrames / (float)m_sampleRate;
+	}
+	Noise.Skip(uModelFrames);
+#if FOOTSTEPS_TRACE_EVENTS
+	Trace.Skip(in_uFrames);
+#endif
+
+	CountIdleFrames(in_uFrames);
+
+	// The filters and delay still hold audio from before the skip
+	RestartSignalPath();
+	CachePlayer.Stop();
+	StepCacheRecording = false;
+	UpsamplePrevious = 0.0f;
+	UpsampleCurrent = 0.0f;
+	UpsamplePhase = (int)((uPhase + in_uFrames) % uDivisor);
+}
+
+void Generator::RestartSignalPath()
+{
+	// Restart the filters and delay silent and fade the filter bank back in
+	Highpass.ResetFilter();
+	OutHP.ResetFilter();
+	OutLP.ResetFilter();
+	CrunchGrains.Stop();
+	Convolver.Reset();
+	Filters.FadeIn();
+	SeparationDelay.Clear(MAX_STEP_SEPARATION);
+	LastOut = 0.0f;
+}
+
+AkUInt32 Generator::FramesToNextEvent() const
+{
+	int Frames = -1;
+	auto Earliest = [&Frames](const nemlib::Timer& Timer) {
+		int TimerFrames = Timer.SamplesToCompletion();
+		if (TimerFrames >= 0 && (Frames < 0 || TimerFrames < Frames)) {
+			Frames = TimerFrames;
+		}
+	};
+
+	if (NumWalkers > 0) {
+		for (int i = 0; i < NumWalkers; i++) {
+			if (m_Automated) {
+				Earliest(Walkers[i].StepTimer);
+			}
+			Earliest(Walkers[i].BallTimer);
+		}
+	}
+	else if (m_Automated) {
+		Earliest(StepTimer);
+	}
+	return Frames < 0 ? NO_PENDING_EVENT : (AkUInt32)Frames;
+}
+
+void Generator::SkipFrames(AkUInt32 in_uFrames)
+{
+	int Frames = (int)in_uFrames;
+	if (NumWalkers > 0) {
+		for (int i = 0; i < NumWalkers; i++) {
+			if (m_Automated) {
+				Walkers[i].StepTimer.Advance(Frames);
+			}
+			Walkers[i].BallTimer.Advance(Frames);
+			Walkers[i].HeelEnv.Advance(Frames);
+			Walkers[i].BallEnv.Advance(Frames);
+		}
+	}
+	else {
+		if (m_Automated) {
+			StepTimer.Advance(Frames);
+		}
+		HeelEnv.Advance(Frames);
+		BallEnv.Advance(Frames);
+	}
+}
+
+void Generator::UpdateCurves(AkUInt32 in_uFrames)
+{
+	// Control rate, the pace and firmness are only read when a step is triggered
+	const float Seconds = (float)in_uFrames / (float)m_outputRate;
+	if (PaceCurve.IsActive()) {
+		m_Pace = PaceCurve.Advance(Seconds);
+		UpdatePaceModifiers(m_Pace);
+	}
+	if (FirmnessCurve.IsActive()) {
+		m_Firmness = 1.0f - FirmnessCurve.Advance(Seconds);
+	}
+}
+
+float Generator::RenderSample()
+{
+	float OutputSample = SynthesisActive ? IncrementTheModelChannel() : IncrementTheCachedChannel();
+	if (StepCacheRecording) {
+		StepCache[StepCacheLength++] = OutputSample;
+		if (StepCacheLength == StepCache.Size()) {
+			FinishStepRecording();
+		}
+	}
+	if (CachePlayer.IsPlaying()) {
+		OutputSample += CachePlayer.ProcessSample();
+	}
+	return OutputSample;
+}
+
+void Generator::ExcuteModel(AkReal32* pBuf, AkUInt16 in_uValidFrames)
+{
+#if FOOTSTEPS_PROFILE_STAGES
+	Profiler.BeginBuffer();
+#endif
+#if FOOTSTEPS_TRACE_EVENTS
+	Trace.BeginBuffer();
+#endif
+	// The setters apply parameters between buffers, so the per-buffer work is kept to moving counters and
+	// small buffers cost about as much per frame as large ones
+	UpdateCurves(in_uValidFrames);
+	// Keeps the trig of the filter variations out of the step onsets and the sample loop
+	RefillFilterVariation();
+
+	//==========Output==========
+	AkUInt16 uFramesProduced = 0;
+	// Runs of plain synthesis go through the fused graph, the rest is rendered one sample at a time
+	while (uFramesProduced < in_uValidFrames)
+	{
+		FOOTSTEPS_TRACE_FRAME(Trace, uFramesProduced);
+		if (GetFusedPath() != FUSED_PATH_NONE) {
+			const AkUInt16 uFused = (AkUInt16)RenderFused(pBuf, in_uValidFrames - uFramesProduced);
+			pBuf += uFused;
+			uFramesProduced += uFused;
+			continue;
+		}
+
+		float OutputSample;
+		if (m_RateDivisor == 1) {
+			OutputSample = RenderSample();
+		}
+		else {
+			if (UpsamplePhase == 0) {
+				UpsamplePrevious = UpsampleCurrent;
+				UpsampleCurrent = RenderSample();
+			}
+			OutputSample = UpsamplePrevious + (UpsampleCurrent - UpsamplePrevious) * (float)UpsamplePhase / (float)m_RateDivisor;
+			if (++UpsamplePhase == m_RateDivisor) {
+				UpsamplePhase = 0;
+			}
+		}
+		*pBuf++ = OutputSample;
+		++uFramesProduced;
+	}
+
+	CountIdleFrames(in_uValidFrames);
+
+	if (SynthesisDrainFrames > 0) {
+		if (SynthesisDrainFrames <= in_uValidFrames) {
+			SynthesisActive = false;
+			SynthesisDrainFrames = 0;
+		}
+		else {
+			SynthesisDrainFrames -= in_uValidFrames;
+		}
+	}
+
+#if FOOTSTEPS_PROFILE_STAGES
+	Profiler.EndBuffer(in_uValidFrames);
+#endif
+#if FOOTSTEPS_TRACE_EVENTS
+	Trace.EndBuffer(in_uValidFrames);
+#endif
+}
+
+void Generator::SetShoeType(AkInt32 in_ShoeType)
+{
+	if (m_sampleRate > 0)
+	{
+		m_ShoeType = in_ShoeType;
+		FOOTSTEPS_TRACE(Trace, TRACE_EVENT_SHOE, (AkUInt64)m_ShoeType);
+		UpdateShoeModifiers(m_ShoeType);
+		InvalidateStepCache();
+	}
+}
+
+void Generator::SetSurfaceType(AkInt32 in_SurfaceType)
+{
+	if (m_sampleRate > 0)
+	{
+		m_SurfaceType = in_SurfaceType;
+		FOOTSTEPS_TRACE(Trace, TRACE_EVENT_SURFACE, (AkUInt64)m_SurfaceType);
+		RequestCrunchBank(m_SurfaceType);
+		UpdateSurfaceModifiers(m_SurfaceType);
+	}
+}
+
+void Generator::SetBlendSurface(AkInt32 in_BlendSurface)
+{
+	if (m_sampleRate > 0)
+	{
+		m_BlendSurface = in_BlendSurface;
+		RequestCrunchBank(m_BlendSurface);
+		SurfaceBlendChanged = true;
+	}
+}
+
+void Generator::SetSurfaceBlend(AkReal32 in_SurfaceBlend)
+{
+	if (m_sampleRate > 0)
+	{
+		m_SurfaceBlend = nemlib::Clamp(in_SurfaceBlend, 0.0f, 1.0f);
+		SurfaceBlendChanged = true;
+	}
+}
+
+void Generator::SetTerrain(AkInt32 in_Terrain)
+{
+	if (m_sampleRate > 0)
+	{
+		m_Terrain = in_Terrain;
+		//UpdateStepEnvelope();
+		InvalidateStepCache();
+	}
+}
+
+void Generator::SetPace(AkReal32 in_Pace)
+{
+	if (m_sampleRate > 0)
+	{
+		m_Pace = in_Pace;
+		UpdatePaceModifiers(m_Pace);
+		PaceCurve.Stop();
+	}
+}
+
+void Generator::SetFirmness(AkReal32 in_Firmness)
+{
+	if (m_sampleRate > 0)
+	{
+		m_Firmness = 1.0f - in_Firmness;
+		FirmnessCurve.Stop();
+	}
+}
+
+void Generator::SetSteadiness(AkReal32 in_Steadiness)
+{
+	if (m_sampleRate > 0)
+	{
+		m_Steadiness = in_Steadiness;
+	}
+}
+
+void Generator::SetAutomeated(bool in_Automated)
+{
+	if (m_sampleRate > 0)
+	{
+		m_Automated = in_Automated;
+
+		//UpdateStepEnvelope();
+		//StepTimer.SetTime(60.0f / m_Pace);
+		//StepTimer.ResetTimer();
+		//StepTimer.ResumeTimer();
+	}
+}
+
+
+void Generator::SetCrowdSize(AkInt32 in_CrowdSize)
+{
+	if (m_sampleRate > 0)
+	{
+		m_CrowdSize = nemlib::Clamp((int)in_CrowdSize, 1, MAX_CROWD_WALKERS);
+		// A crowd of one is rendered by the regular single walker path
+		int NewNumWalkers = (m_CrowdSize > 1 && !OneShot) ? m_CrowdSize : 0;
+		for (int i = NumWalkers; i < NewNumWalkers; i++) {
+			SpawnWalker(Walkers[i]);
+		}
+		NumWalkers = NewNumWalkers;
+		CrowdGain = 1.0f / sqrt((float)m_CrowdSize);
+	}
+}
+
+void Generator::SetPaceSpread(AkReal32 in_PaceSpread)
+{
+	if (m_sampleRate > 0)
+	{
+		m_PaceSpread = in_PaceSpread;
+		for (int i = 0; i < NumWalkers; i++) {
+			Walkers[i].PaceScale = nemlib::Vary(1.0f, m_PaceSpread, Rng);
+		}
+	}
+}
+
+void Generator::SetSteadinessSpread(AkReal32 in_SteadinessSpread)
+{
+	if (m_sampleRate > 0)
+	{
+		m_SteadinessSpread = in_SteadinessSpread;
+		for (int i = 0; i < NumWalkers; i++) {
+			Walkers[i].SteadinessScale = nemlib::Vary(1.0f, m_SteadinessSpread, Rng);
+		}
+	}
+}
+
+void Generator::SetConvolution(bool in_Convolution)
+{
+	if (m_sampleRate > 0)
+	{
+		m_Convolution = in_Convolution;
+		SelectImpulseBank();
+		InvalidateStepCache();
+	}
+}
+
+void Generator::SetQualityLevel(AkInt32 in_Level)
+{
+	if (m_sampleRate > 0)
+	{
+		int Level = nemlib::Clamp((int)in_Level, (int)GENERATOR_QUALITY_FULL, NUM_GENERATOR_QUALITIES - 1);
+		if (Level >= GENERATOR_QUALITY_CACHED_STEPS && StepCache.Size() == 0) {
+			Level = GENERATOR_QUALITY_NO_CRUNCH;
+		}
+		if (Level == QualityLevel) {
+			return;
+		}
+		QualityLevel = Level;
+		Filters.SetMaxActiveFilters(GetMaxModes());
+		if (Level < GENERATOR_QUALITY_CACHED_STEPS) {
+			// The cache is kept for the next time, steps in flight from it play to their end
+			StepCacheRecording = false;
+			ResumeSynthesis();
+		}
+	}
+}
+
+void Generator::SetTier(const GeneratorTier& in_Tier)
+{
+	if (m_sampleRate > 0)
+	{
+		Tier = in_Tier;
+		Tier.EnvelopeResolution = std::max((int)Tier.EnvelopeResolution, 1);
+		Filters.SetMaxActiveFilters(GetMaxModes());
+		HeelEnv.SetResolution(Tier.EnvelopeResolution);
+		BallEnv.SetResolution(Tier.EnvelopeResolution);
+		for (int i = 0; i < NumWalkers; i++) {
+			SetEnvelopeResolution(Walkers[i]);
+		}
+	}
+}
+
+void Generator::SetIdleReleaseTime(AkReal32 in_Seconds)
+{
+	if (m_sampleRate > 0)
+	{
+		IdleReleaseFrames = (AkUInt32)(std::max(in_Seconds, 0.0f) * (float)m_outputRate);
+	}
+}
+
+int Generator::GetMaxModes() const
+{
+	const int MaxModes = nemlib::Clamp((int)Tier.MaxModes, 1, nemlib::MAX_FILTERBANK_FILTERS);
+	return QualityLevel >= GENERATOR_QUALITY_REDUCED_MODES ? std::min(MaxModes, REDUCED_FILTERBANK_MODES) : MaxModes;
+}
+
+void Generator::SetEnvelopeResolution(CrowdWalker& Walker) const
+{
+	Walker.HeelEnv.SetResolution(Tier.EnvelopeResolution);
+	Walker.BallEnv.SetResolution(Tier.EnvelopeResolution);
+}
+
+void Generator::SetPaceCurve(AkReal32 in_Target, AkReal32 in_Time)
+{
+	SetPaceCurve(&in_Target, &in_Time, 1);
+}
+
+void Generator::SetPaceCurve(const AkReal32* in_pValues, const AkReal32* in_pTimes, AkInt32 in_NumPoints)
+{
+	if (m_sampleRate > 0)
+	{
+		PaceCurve.Start(m_Pace, in_pValues, in_pTimes, in_NumPoints);
+	}
+}
+
+void Generator::SetFirmnessCurve(AkReal32 in_Target, AkReal32 in_Time)
+{
+	SetFirmnessCurve(&in_Target, &in_Time, 1);
+}
+
+void Generator::SetFirmnessCurve(const AkReal32* in_pValues, const AkReal32* in_pTimes, AkInt32 in_NumPoints)
+{
+	if (m_sampleRate > 0)
+	{
+		FirmnessCurve.Start(1.0f - m_Firmness, in_pValues, in_pTimes, in_NumPoints);
+	}
+}
+
+void Generator::SpawnWalker(CrowdWalker& Walker)
+{
+	Walker.HeelEnv = nemlib::CurveEnvelope(m_sampleRate, {}, {});
+	Walker.BallEnv = nemlib::CurveEnvelope(m_sampleRate, {}, {});
+	SetEnvelopeResolution(Walker);
+	Walker.PaceScale = nemlib::Vary(1.0f, m_PaceSpread, Rng);
+	Walker.SteadinessScale = nemlib::Vary(1.0f, m_SteadinessSpread, Rng);
+	Walker.BallTimer = nemlib::Timer(m_sampleRate, 0.0f);
+	// Start each walker at a random point of its first stride so the crowd doesn't march in step
+	Walker.StepTimer = nemlib::Timer(m_sampleRate, Rng.NextFloat() * 60.0f / (m_Pace * Walker.PaceScale));
+	Walker.StepTimer.ResumeTimer();
+}
+
+void Generator::TriggerWalkerStep(CrowdWalker& Walker)
+{
+	// While a step is recorded the other walkers pause, so it is recorded on its own
+	const bool Cached = QualityLevel >= GENERATOR_QUALITY_CACHED_STEPS && StepCacheValid;
+	if (Cached || StepCacheRecording) {
+		if (Cached) {
+			TriggerCachedStep();
+		}
+		Walker.StepTimer.SetTime(nemlib::Vary(60.0f / (m_Pace * Walker.PaceScale), m_Steadiness * Walker.SteadinessScale, Rng));
+		Walker.StepTimer.ResetTimer();
+		Walker.StepTimer.ResumeTimer();
+		return;
+	}
+	FOOTSTEPS_TRACE(Trace, TRACE_EVENT_STEP, (AkUInt64)(&Walker - Walkers) + 1);
+	BeginStepRecording();
+	// The walkers share the filter bank, retuning it under another walker's step would bend that step's pitch.
+	// It is only varied when the others are silent, or to glide to a new surface blend
+	bool OthersActive = false;
+	for (int i = 0; i < NumWalkers; i++) {
+		if (&Walkers[i] != &Walker && (Walkers[i].HeelEnv.IsActive() || Walkers[i].BallEnv.IsActive())) {
+			OthersActive = true;
+			break;
+		}
+	}
+	if (!OthersActive || SurfaceBlendChanged) {
+		VaryFilterBank();
+	}
+	StepShape Step = MakeStepShape();
+	Walker.HeelEnv.SetValues({ 0.0f, Step.HeelGain, Step.HeelSustain, 0.0f });
+	Walker.HeelEnv.SetTimes({ Step.HeelAttack, Step.HeelDecay, Step.HeelRelease });
+	Walker.HeelEnv.ResetEnvelope();
+	Walker.PendingStep = Step;
+	if (UseCrunch()) {
+		CrunchLoop();
+	}
+	if (Step.HasBall) {
+		Walker.BallTimer.SetTime(Step.StepSeparation);
+		Walker.BallTimer.ResetTimer();
+		Walker.BallTimer.ResumeTimer();
+	}
+	Walker.StepTimer.SetTime(nemlib::Vary(60.0f / (m_Pace * Walker.PaceScale), m_Steadiness * Walker.SteadinessScale, Rng));
+	Walker.StepTimer.ResetTimer();
+	Walker.StepTimer.ResumeTimer();
+}
+
+void Generator::TriggerWalkerBall(CrowdWalker& Walker)
+{
+	FOOTSTEPS_TRACE(Trace, TRACE_EVENT_BALL, (AkUInt64)(&Walker - Walkers) + 1);
+	const StepShape& Step = Walker.PendingStep;
+	Walker.BallEnv.SetValues({ 0.0f, Step.BallGain, Step.BallSustain, 0.0f });
+	Walker.BallEnv.SetTimes({ Step.BallAttack, Step.BallDecay, Step.BallRelease });
+	Walker.BallEnv.ResetEnvelope();
+	Walker.BallTimer.PauseTimer();
+}
+
+void Generator::UpdatePaceModifiers(float Pace)
+{
+	if (m_Pace < 75.0f) { // Creeping
+		RollSpeedPercentage = 22.0f - (4.0f / 15.0f) * Pace;
+		HeelToBallRatio[0] = 0.5f;
+		HeelToBallRatio[1] = 0.4f;
+	}
+	else if (m_Pace < 120.0f) { // Walking
+		RollSpeedPercentage = (255.0f - Pace) / 90.0f;
+		HeelToBallRatio[0] = 1.0f;
+		HeelToBallRatio[1] = 0.8f;
+	}
+	else { // Running
+		RollSpeedPercentage = 1.5f;
+		HeelToBallRatio[0] = 1.0f;
+		HeelToBallRatio[1] = 0.63f;
+	}
+}
+
+void Generator::UpdateShoeModifiers(int ShoeType)
+{
+	switch (ShoeType) {
+	case 0:  // TRAINER
+		Shoe = { 1.0f, 1.0f, 0.0f, 10.0f, 0.1f, 40.0f, 0.5f, 1.0f, 0.0f, 20.0f, 0.1f };
+		break;
+	case 1:  // HIGH HEEL
+		Shoe = { 1.0f, 0.1f, 0.0f, 1.0f, 0.1f, 20.0f, 0.8f, 2.0f, 0.0f, 5.0f, 0.1f };
+		break;
+	case 2:  // OXFORD
+		Shoe = { 1.0f, 0.1f, 0.0f, 3.0f, 0.1f, 40.0f, 1.0f, 1.0f, 0.2f, 5.0f, 20.0f };
+		break;
+	case 3: // WORK BOOT
+		Shoe = { 1.0f, 1.27f, 0.0f, 21.4f, 0.1f, 40.0f, 0.429f, 12.7f, 0.0f, 37.5f, 0.1f };
+		break;
+	default:
+		Shoe = { 1.0f, 1.0f, 0.0f, 10.0f, 0.1f, 40.0f, 0.5f, 1.0f, 0.0f, 20.0f, 0.1f };
+	}
+}
+
+void Generator::UpdateSurfaceModifiers(int SurfaceType)
+{
+	ModelSurface = SurfaceType;
+	if (SurfaceBlended || IsBlendingSurfaces()) {
+		// The filter bank glides from the blend it holds on the next step instead of restarting
+		SurfaceBlendChanged = true;
+	}
+	else {
+		CrunchFlag = false;
+		ResonantFlag = false;
+		Surface = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+		if (SurfaceType >= 0 && SurfaceType < NUM_SURFACES) {
+			const SurfaceProfile& Profile = SurfaceProfiles[SurfaceType];
+			Filters.InitialiseFilterBank(Modes[SurfaceType]);
+			Surface = Profile.Envelope;
+			FiltersOut = Profile.FiltersOut;
+			ResonantFlag = Profile.Resonant;
+			CrunchFlag = Profile.Crunch;
+			if (Profile.Crunch) {
+				CrunchOut = Profile.CrunchOut;
+				Delay1 = Profile.CrunchDelay1;
+				Delay2 = Profile.CrunchDelay2;
+			}
+		}
+		ResetFilterVariations();
+		SelectImpulseBank();
+		InvalidateStepCache();
+	}
+	if (UseCrunch()) {
+		CrunchLoop();
+	}
+}
+
+bool Generator::IsBlendingSurfaces() const
+{
+	return m_SurfaceBlend > 0.0f && m_BlendSurface != m_SurfaceType && m_BlendSurface >= 0 && m_BlendSurface < NUM_SURFACES;
+}
+
+void Generator::UpdateSurfaceBlend()
+{
+	SurfaceBlendChanged = false;
+	if (m_SurfaceType < 0 || m_SurfaceType >= NUM_SURFACES) {
+		return;
+	}
+	const bool Blending = IsBlendingSurfaces();
+	const int ToSurface = Blending ? m_BlendSurface : m_SurfaceType;
+	const float Amount = Blending ? m_SurfaceBlend : 0.0f;
+	const SurfaceProfile& From = SurfaceProfiles[m_SurfaceType];
+	const SurfaceProfile& To = SurfaceProfiles[ToSurface];
+
+	// One filter bank renders the blend, its filters keep ringing while their modes move
+	nemlib::BlendModes(Modes[m_SurfaceType], Modes[ToSurface], Amount, BlendedModes);
+	Filters.MorphFilterBank(BlendedModes);
+	Surface.HeelAttack = Lerp(From.Envelope.HeelAttack, To.Envelope.HeelAttack, Amount);
+	Surface.HeelSustain = Lerp(From.Envelope.HeelSustain, To.Envelope.HeelSustain, Amount);
+	Surface.HeelDecay = Lerp(From.Envelope.HeelDecay, To.Envelope.HeelDecay, Amount);
+	Surface.HeelRelease = Lerp(From.Envelope.HeelRelease, To.Envelope.HeelRelease, Amount);
+	Surface.BallAttack = Lerp(From.Envelope.BallAttack, To.Envelope.BallAttack, Amount);
+	Surface.BallSustain = Lerp(From.Envelope.BallSustain, To.Envelope.BallSustain, Amount);
+	Surface.BallDecay = Lerp(From.Envelope.BallDecay, To.Envelope.BallDecay, Amount);
+	Surface.BallRelease = Lerp(From.Envelope.BallRelease, To.Envelope.BallRelease, Amount);
+	FiltersOut = Lerp(From.FiltersOut, To.FiltersOut, Amount);
+	ResonantFlag = From.Resonant;
+
+	// A surface without crunch fades the grains out and takes the timing of the other one
+	CrunchFlag = From.Crunch || (Amount > 0.0f && To.Crunch);
+	CrunchBlend = 0.0f;
+	if (CrunchFlag) {
+		const SurfaceProfile& FromCrunch = From.Crunch ? From : To;
+		const SurfaceProfile& ToCrunch = To.Crunch ? To : From;
+		CrunchOut = Lerp(From.CrunchOut, To.CrunchOut, Amount);
+		Delay1 = Lerp(FromCrunch.CrunchDelay1, ToCrunch.CrunchDelay1, Amount);
+		Delay2 = Lerp(FromCrunch.CrunchDelay2, ToCrunch.CrunchDelay2, Amount);
+		CrunchBlend = !From.Crunch ? 1.0f : (To.Crunch ? Amount : 0.0f);
+	}
+
+	SurfaceBlended = Amount > 0.0f;
+	ResetFilterVariations();
+	SelectImpulseBank();
+	InvalidateStepCache();
+}
+
+void Generator::CrunchLoop()
+{
+	// Overlap a random pre-rendered grain, at a random level, with the ones still playing
+	if (CrunchBank != nullptr && CrunchBank->IsReady()) {
+		int Length = 0;
+		// While blending, grains come from either surface in proportion
+		int GrainSurface = ModelSurface;
+		if (CrunchBlend >= 1.0f || (CrunchBlend > 0.0f && Rng.NextFloat() < CrunchBlend)) {
+			GrainSurface = m_BlendSurface;
+		}
+		const float* Grain = CrunchBank->GetGrain(GrainSurface, (int)(Rng.NextFloat() * CRUNCH_GRAINS_PER_SURFACE), Length);
+		CrunchGrains.Trigger(Grain, Length, Rng.NextFloat() + 0.7f);
+		FOOTSTEPS_TRACE(Trace, TRACE_EVENT_CRUNCH_GRAIN, (AkUInt64)GrainSurface);
+	}
+	CrunchTimer.SetTime((Delay1 + Rng.NextFloat() * (Delay1 - Delay2)) / 1000.0f);
+	CrunchTimer.ResetTimer();
+}
+
+void Generator::VaryFilterBank()
+{
+	if (SurfaceBlendChanged) {
+		UpdateSurfaceBlend();
+	}
+	// A bank still being built when the surface was selected takes over from the filter bank between steps
+	if (ImpulseBank == nullptr && m_Convolution && ResonantFlag && !SurfaceBlended) {
+		SelectImpulseBank();
+		if (ImpulseBank != nullptr) {
+			InvalidateStepCache();
+		}
+	}
+	// Convolved surfaces pick one of their pre-rendered variations instead
+	if (ImpulseBank != nullptr) {
+		Convolver.SetImpulse(&ImpulseBank->GetVariation((int)(VariationRng.NextFloat() * IMPULSE_VARIATIONS)));
+		return;
+	}
+	// Only the first step after the modes change draws its own variation, the others are copied
+	if (NumFilterVariations == 0 && !RefillFilterVariation()) {
+		return;
+	}
+	const int Index = (int)(VariationRng.NextFloat() * NumFilterVariations);
+	Filters.ApplyVariation(FilterVariations[Index]);
+	UsedFilterVariations |= 1u << Index;
+}
+
+const nemlib::Mode* Generator::GetVariedModes() const
+{
+	if (SurfaceBlended) {
+		return &BlendedModes;
+	}
+	if (m_SurfaceType >= 0 && m_SurfaceType < NUM_SURFACES) {
+		return &Modes[m_SurfaceType];
+	}
+	return nullptr;
+}
+
+void Generator::ResetFilterVariations()
+{
+	NumFilterVariations = 0;
+	UsedFilterVariations = 0;
+}
+
+bool Generator::RefillFilterVariation()
+{
+	// Nothing to draw for convolved surfaces, nor for a blend about to be replaced on the next step
+	const nemlib::Mode* VariedModes = GetVariedModes();
+	if (VariedModes == nullptr || ImpulseBank != nullptr || SurfaceBlendChanged) {
+		return false;
+	}
+	// Fills the pool first, then draws again the oldest variation a step has used
+	int Index = NumFilterVariations;
+	if (Index < FILTERBANK_VARIATIONS) {
+		++NumFilterVariations;
+	}
+	else {
+		if (UsedFilterVariations == 0) {
+			return false;
+		}
+		Index = 0;
+		while ((UsedFilterVariations & (1u << Index)) == 0) {
+			++Index;
+		}
+		UsedFilterVariations &= ~(1u << Index);
+	}
+	Filters.ComputeVariation(*VariedModes, VariationRng, FilterVariations[Index]);
+	return true;
+}
+
+void Generator::SelectImpulseBank()
+{
+	// Only looks the bank up, PrepareConvolver requested it. Until it is built the voice keeps rendering with the filter bank
+	const SurfaceImpulseBank* Bank = nullptr;
+	// Blends are rendered by the filter bank, the impulses only hold single surfaces
+	if (m_Convolution && ResonantFlag && !SurfaceBlended && ModelSurface >= 0 && ModelSurface < NUM_SURFACES) {
+		Bank = ImpulseBanks[ModelSurface];
+		if (Bank != nullptr && !Bank->IsReady()) {
+			Bank = nullptr;
+		}
+	}
+	if (Bank != nullptr) {
+		Convolver.SetImpulse(&Bank->GetVariation(0));
+	}
+	else if (ImpulseBank != nullptr) {
+		// Back to the filter bank, which fades in while the convolver rings out
+		Filters.FadeIn();
+	}
+	ImpulseBank = Bank;
+}
+
+bool Generator::PrepareConvolver()
+{
+	// A voice is always convolved at its own rate, so the convolver is only allocated once
+	if (Convolver.IsPrepared()) {
+		return true;
+	}
+	const int MaxPartitions = SurfaceImpulseBank::GetMaxPartitions(m_sampleRate);
+	if (!ConvolutionArena.Reserve(MemAllocator, nemlib::PartitionedConvolver::GetRequiredBytes(IMPULSE_BLOCK_SIZE, MaxPartitions))
+		|| !Convolver.Prepare(IMPULSE_BLOCK_SIZE, MaxPartitions, ConvolutionArena)) {
+		return false;
+	}
+	// Every surface the voice can switch to, requested by the first voice prepared at this rate and shared by the others
+	for (int i = 0; i < NUM_SURFACES; i++) {
+		if (SurfaceProfiles[i].Resonant) {
+			ImpulseBanks[i] = SurfaceImpulseBank::Request(MemAllocator.GetPluginAllocator(), m_sampleRate, i, Modes[i]);
+		}
+	}
+	return true;
+}
+
+bool Generator::NeedsBallPath() const
+{
+	// Upstairs and crowd steps have no separation
+	return m_Terrain == 0 && NumWalkers == 0;
+}
+
+void Generator::PrepareBallPath()
+{
+	if (!NeedsBallPath() || SeparationDelay.IsAllocated()) {
+		return;
+	}
+	if (!CoreArena.Reserve(MemAllocator, nemlib::Delay::GetRequiredBytes(m_sampleRate, MAX_STEP_SEPARATION))) {
+		return;
+	}
+	SeparationDelay = nemlib::Delay(m_sampleRate, 0.02f, MAX_STEP_SEPARATION, CoreArena);
+	// ResetModel already shaped the first step, its ball still plays
+	if (BallEnv.IsActive()) {
+		WakeBallPath(BallSeparation);
+	}
+}
+
+void Generator::RequestCrunchBank(int SurfaceType)
+{
+	// Requested by the first voice on a crunchy surface at this rate and built by the lookahead worker, no grain
+	// plays until it is ready
+	if (CrunchBank == nullptr && SurfaceType >= 0 && SurfaceType < NUM_SURFACES && SurfaceProfiles[SurfaceType].Crunch) {
+		CrunchBank = CrunchGrainBank::Request(MemAllocator.GetPluginAllocator(), m_sampleRate);
+	}
+}
+
+void Generator::WakeBallPath(float Separation)
+{
+	// Voices that never step with a ball leave the ball path dormant
+	BallSeparation = Separation;
+	if (!SeparationDelay.IsAllocated()) {
+		return;
+	}
+	BallPathActive = true;
+	BallPathIdleFrames = 0;
+	SeparationDelay.SetDelay(Separation);
+}
+
+void Generator::CountIdleFrames(AkUInt32 in_uFrames)
+{
+	// The ball rings on in the delay for up to MAX_STEP_SEPARATION after its envelope ends
+	if (BallPathActive && NumWalkers == 0 && BallEnv.IsActive()) {
+		BallPathIdleFrames = 0;
+	}
+	else {
+		BallPathIdleFrames = AddIdleFrames(BallPathIdleFrames, in_uFrames);
+		if (BallPathActive && IdleReleaseFrames > 0
+			&& BallPathIdleFrames >= std::max(IdleReleaseFrames, (AkUInt32)(MAX_STEP_SEPARATION * (float)m_outputRate))) {
+			BallPathActive = false;
+		}
+	}
+	// Nothing is freed here, ReleaseIdleSubsystems does outside the render path
+	ConvolverIdleFrames = (ImpulseBank != nullptr || Convolver.IsActive()) ? 0 : AddIdleFrames(ConvolverIdleFrames, in_uFrames);
+	StepCacheIdleFrames = (QualityLevel >= GENERATOR_QUALITY_CACHED_STEPS || CachePlayer.IsPlaying()) ? 0 : AddIdleFrames(StepCacheIdleFrames, in_uFrames);
+}
+
+bool Generator::PrepareStepCache()
+{
+	// Allocated by PrepareSubsystems, then kept until ReleaseIdleSubsystems or the next PrepareModel
+	if (StepCache.Size() > 0) {
+		return true;
+	}
+	const int Length = (int)(STEP_CACHE_TIME * (float)m_sampleRate);
+	if (!CacheArena.Reserve(MemAllocator, nemlib::Arena::SliceBytes((size_t)Length * sizeof(float)))) {
+		return false;
+	}
+	return StepCache.Allocate(Length, CacheArena);
+}
+
+void Generator::InvalidateStepCache()
+{
+	// The recording no longer matches the shoe or surface, synthesize again until a new step is recorded
+	StepCacheValid = false;
+	StepCacheRecording = false;
+	ResumeSynthesis();
+}
+
+void Generator::BeginStepRecording()
+{
+	// Grains still playing read from the cache, wait for them to end before overwriting it
+	if (QualityLevel < GENERATOR_QUALITY_CACHED_STEPS || StepCacheValid || StepCacheRecording || CachePlayer.IsPlaying()) {
+		return;
+	}
+	// A crowd only records a step that starts in silence, so it holds a single walker
+	for (int i = 0; i < NumWalkers; i++) {
+		if (Walkers[i].HeelEnv.IsActive() || Walkers[i].BallEnv.IsActive()) {
+			return;
+		}
+	}
+	StepCacheLength = 0;
+	StepCacheRecording = StepCache.Size() > 0;
+}
+
+void Generator::FinishStepRecording()
+{
+	// Fade the end out, the recording may have been cut short by the next step
+	const int FadeLength = std::min(StepCacheLength, (int)(STEP_CACHE_FADE_TIME * (float)m_sampleRate));
+	for (int i = 0; i < FadeLength; i++) {
+		StepCache[StepCacheLength - 1 - i] *= (float)i / (float)FadeLength;
+	}
+	StepCacheRecording = false;
+	StepCacheValid = StepCacheLength > 0;
+}
+
+void Generator::TriggerCachedStep()
+{
+	FOOTSTEPS_TRACE(Trace, TRACE_EVENT_CACHED_STEP, 0);
+	// Only the level varies, in crowd mode the recording may hold the tail of other walkers' steps too
+	CachePlayer.Trigger(StepCache.Data(), StepCacheLength, nemlib::Vary(1.0f, 0.15f, Rng));
+	if (SynthesisActive && SynthesisDrainFrames == 0) {
+		float DrainTime = STEP_CACHE_TIME;
+		if (ImpulseBank != nullptr) {
+			DrainTime += (float)(ImpulseBank->GetLength() + Convolver.GetLatency()) / (float)m_sampleRate;
+		}
+		SynthesisDrainFrames = (AkUInt32)(DrainTime * (float)m_outputRate);
+	}
+}
+
+float Generator::IncrementTheCachedChannel()
+{
+	// Only the step scheduling is left, the steps themselves are played by CachePlayer
+	if (NumWalkers > 0) {
+		if (m_Automated) {
+			for (int i = 0; i < NumWalkers; i++) {
+				if (Walkers[i].StepTimer.checkTime() == true) {
+					TriggerWalkerStep(Walkers[i]);
+				}
+			}
+		}
+	}
+	else if (m_Automated) {
+		if (StepTimer.checkTime() == true) {
+			TriggerStep();
+		}
+	}
+	else {
+		StepCounter += 1.0f / (float)m_sampleRate;
+	}
+	return 0.0f;
+}
+
+void Generator::ResumeSynthesis()
+{
+	SynthesisDrainFrames = 0;
+	if (!SynthesisActive) {
+		// Stopped in the middle of the last tail
+		RestartSignalPath();
+		SynthesisActive = true;
+	}
+}
+
+GeneratorMemoryFootprint Generator::GetMemoryFootprint() const
+{
+	GeneratorMemoryFootprint Footprint = {};
+	Footprint.Object = sizeof(Generator);
+	const char* pObject = (const char*)this;
+	Footprint.HotState = (size_t)((const char*)&Walkers[0] - (const char*)&Noise);
+	Footprint.Walkers = sizeof(Walkers);
+	Footprint.Subsystems = (size_t)((const char*)&Rng - (const char*)&Convolver);
+	Footprint.Configuration = (size_t)(pObject + sizeof(Generator) - (const char*)&Rng);
+	Footprint.SeparationDelay = SeparationDelay.GetMemoryBytes();
+	Footprint.Convolver = Convolver.GetMemoryBytes();
+	Footprint.StepCache = StepCache.GetBytes();
+	Footprint.ArenaReserved = CoreArena.GetCapacity() + ConvolutionArena.GetCapacity() + CacheArena.GetCapacity();
+	Footprint.ArenaOverflow = CoreArena.GetOverflow() + ConvolutionArena.GetOverflow() + CacheArena.GetOverflow();
+	Footprint.Total = Footprint.Object + Footprint.ArenaReserved + Footprint.ArenaOverflow;
+	return Footprint;
+}
+
+ShoeEnvelope Generator::AddVariation()
+{
+	ShoeEnvelope NewShoeEnvelope = {
+	nemlib::Vary(Shoe.HeelGain, 0.02f, Rng),
+	nemlib::Vary(Shoe.HeelAttack, 0.05f, Rng),
+	nemlib::Vary(Shoe.HeelSustain, 0.01f, Rng),
+	nemlib::Vary(Shoe.HeelDecay, 0.1f, Rng),
+	nemlib::Vary(Shoe.HeelRelease, 0.05f, Rng),
+	nemlib::Vary(Shoe.StepSeparation, 0.05f, Rng),
+	nemlib::Vary(Shoe.BallGain, 0.15f, Rng),
+	nemlib::Vary(Shoe.BallAttack, 0.1f, Rng),
+	nemlib::Vary(Shoe.BallSustain, 0.01f, Rng),
+	nemlib::Vary(Shoe.BallDecay, 0.1f, Rng),
+	nemlib::Vary(Shoe.BallRelease, 0.05f, Rng)
+	};
+	return NewShoeEnvelope;
+}
+
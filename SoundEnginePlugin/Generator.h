@@ -1,166 +1,400 @@
-#pragma once
-
-#include "FootstepsLibrary.h"
-#include <AK/SoundEngine/Common/AkCommonDefs.h>
-//#include <Windows.h>
-
-// Struct for Shoe envelope modifiers
-struct ShoeEnvelope {
-    float HeelGain;
-    float HeelAttack;
-    float HeelSustain;
-    float HeelDecay;
-    float HeelRelease;
-    float StepSeparation;
-    float BallGain;
-    float BallAttack;
-    float BallSustain;
-    float BallDecay;
-    float BallRelease;
-};
-
-// Struct for Surface envelope modifiers
-struct SurfaceEnvelope {
-    float HeelAttack;
-    float HeelSustain;
-    float HeelDecay;
-    float HeelRelease;
-    float BallAttack;
-    float BallSustain;
-    float BallDecay;
-    float BallRelease;
-};
-
-class Generator
-{
-public:
-	Generator();
-	~Generator();
-
-    //Model Step
-	void PrepareModel(AkUInt32 in_sampleRate);
-	void UpdateStepEnvelope();
-	float IncrementTheModelChannel();
-    void ExcuteModel(AkReal32* pBuf, AkUInt16 in_uValidFrames);
-
-    //Set Parameters
-    void SetShoeType(AkInt32 in_ShoeType);
-    void SetSurfaceType(AkInt32 in_SurfaceType);
-    void SetTerrain(AkInt32 in_Terrain);
-    void SetPace(AkReal32 in_Pace);
-    void SetFirmness(AkReal32 in_Firmness);
-    void SetSteadiness(AkReal32 in_Steadiness);
-    void SetAutomeated(bool in_Automated);
-
-	//Model Parameters Update
-	void UpdatePaceModifiers(float Pace);
-	void UpdateShoeModifiers(int ShoeType);
-	void UpdateSurfaceModifiers(int SurfaceType);
-
-	void CrunchLoop();
-	void VaryFilterBank();
-
-    ShoeEnvelope AddVariation();
-
-    //
-    AkInt32 m_sampleRate;//sample rate
-    AkInt32 m_ShoeType;
-    AkInt32 m_SurfaceType;
-    AkInt32 m_Terrain;
-    AkReal32 m_Pace;
-    AkReal32 m_Firmness;
-    AkReal32 m_Steadiness;
-    bool m_Automated;
-
-private:
-
-    //Changed Parameters
-    bool m_ShoeTypeChanged;
-    bool m_SurfaceTypeChanged;
-    bool m_TerrainChanged;
-    bool m_PaceChanged;
-    bool m_FirmnessChanged;
-    bool m_SteadinessChanged;
-    bool m_AutomatedChanged;
-    // Library Components
-    nemlib::CurveEnvelope HeelEnv;
-    nemlib::CurveEnvelope BallEnv;
-    nemlib::WhiteNoiseGen Noise;
-    nemlib::BiquadFilter Highpass;
-    nemlib::FilterBank Filters;
-    nemlib::DistortionProcessor Distortion;
-    nemlib::BiquadFilter CrunchBP;
-    nemlib::CurveEnvelope CrunchEnv;
-    nemlib::Delay SeparationDelay;
-    nemlib::Timer StepTimer;
-    nemlib::Timer CrunchTimer;
-    nemlib::BiquadFilter OutHP;
-    nemlib::BiquadFilter OutLP;
-    // Model Variables
-    //float Pace = 82.0f;
-    //float Steadiness = 0.1f;
-    //float Firmness = 0.3f;
-    //bool Automated = false;
-    ShoeEnvelope Shoe = { 1.0f, 1.0f, 0.0f, 10.0f, 0.1f, 40.0f, 0.5f, 1.0f, 0.0f, 20.0f, 0.1f };
-    SurfaceEnvelope Surface = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
-    //int SurfaceType;
-    //int ShoeType;
-    //int TerrainType = 0;
-    // Helper variables
-    bool CrunchFlag = false;
-    float RollSpeedPercentage = 1.92f;
-    std::vector<float> HeelToBallRatio = { 0.8f, 0.5f };
-    float CrunchOut = 0.0f;
-    float FiltersOut = 1.0f;
-    float StepCounter = 0.0f;
-    float Freq1 = 0.0f;
-    float Freq2 = 0.0f;
-    float Delay1 = 0.0f;
-    float Delay2 = 0.0f;
-    float LastOut = 0.0f;
-    // Constants
-    std::vector<nemlib::Mode> Modes = {
-        { // Wood
-            9,
-            { 0, 2, 2, 2, 2, 2, 2, 2, 2 },
-            { 80.0f, 95.0f, 134.0f, 139.0f, 154.0f, 201.0f, 123.0f, 156.0f, 189.0f },
-            { 20.0f, 20.0f, 20.0f, 20.0f, 20.0f, 15.0f, 10.0f, 20.0f, 20.0f },
-            { 0.2f, 0.1f, 0.1f, 0.1f, 0.1f, 0.2f, 0.2f, 0.2f, 0.2f }
-        },
-        { // Concrete
-            5,
-            { 0, 2, 2, 2, 2 },
-            { 140.0f, 234.0f, 380.0f, 1450.0f, 2156.0f },
-            { 10.0f, 10.0f, 10.0f, 10.0f, 10.0f },
-            { 0.1f, 0.2f, 0.1f, 0.05f, 0.05f }
-        },
-        { // Dirt
-            4,
-            { 2, 2, 2, 0 } ,
-            { 180.0f, 300.0f, 650.0f, 2200.0f },
-            { 2.0f, 2.0f, 2.0f, 1.0f },
-            { 0.6f, 0.1f, 0.1f, 0.1f }
-        },
-        { // Grass
-            3,
-            { 1, 2, 0 },
-            { 890.0f, 2023.0f, 3000.0f },
-            { 3.5f, 2.0f, 2.0f },
-            { 0.05f, 0.05f, 0.05f }
-        },
-        { // Hollow Wood
-            4,
-            { 2, 2, 2, 2},
-            { 109.0f, 230.0f, 352.0f, 413.0f },
-            { 10.0f, 10.0f, 10.0f, 10.0f },
-            { 1.0f, 1.0f, 1.0f, 1.0f }
-        },
-        { // Metal
-            7,
-            { 2, 2, 2, 2, 2, 2, 2 },
-            { 124.0f,  218.0f,  615.0f,  1098.0f,  1250.0f,  1764.0f,  2682.0f },
-            { 2.0f, 60.0f, 60.0f, 60.0f, 60.0f, 60.0f, 60.0f },
-            { 1.0f, 0.80f, 0.65f, 0.50f, 0.35f, 0.20f, 0.05f }
-        }
-    };
-};
\ No newline at end of file
+#pragma once
+
+#include "FootstepsLibrary.h"
+#include "CrunchGrains.h"
+#include "SurfaceImpulses.h"
+#include "StageProfiler.h"
+#include "TraceRing.h"
+#include "PluginAllocator.h"
+#include <AK/SoundEngine/Common/AkCommonDefs.h>
+//#include <Windows.h>
+
+// Struct for Shoe envelope modifiers
+struct ShoeEnvelope {
+    float HeelGain;
+    float HeelAttack;
+    float HeelSustain;
+    float HeelDecay;
+    float HeelRelease;
+    float StepSeparation;
+    float BallGain;
+    float BallAttack;
+    float BallSustain;
+    float BallDecay;
+    float BallRelease;
+};
+
+// Struct for Surface envelope modifiers
+struct SurfaceEnvelope {
+    float HeelAttack;
+    float HeelSustain;
+    float HeelDecay;
+    float HeelRelease;
+    float BallAttack;
+    float BallSustain;
+    float BallDecay;
+    float BallRelease;
+};
+
+// Everything a surface sets up besides its modes
+struct SurfaceProfile {
+    SurfaceEnvelope Envelope;
+    float FiltersOut; // filter bank level
+    bool Resonant; // convolved in convolution mode
+    bool Crunch;
+    float CrunchOut; // crunch grain level
+    float CrunchDelay1; // ms, grains follow each other after Delay1 + random * (Delay1 - Delay2)
+    float CrunchDelay2;
+};
+
+// Struct for the envelope shape of a single step, after variation
+struct StepShape {
+    float HeelGain;
+    float HeelAttack;
+    float HeelSustain;
+    float HeelDecay;
+    float HeelRelease;
+    float BallGain;
+    float BallAttack;
+    float BallSustain;
+    float BallDecay;
+    float BallRelease;
+    float StepSeparation;
+    bool HasBall;
+};
+
+// Time rendered after the envelopes of a one-shot step have ended, lets the output filters settle
+const float ONE_SHOT_RING_TIME = 0.02f;
+
+// Longest delay between heel and ball, the length of SeparationDelay and the part cleared when the model restarts
+const float MAX_STEP_SEPARATION = 0.25f;
+
+// Returned by Generator::FramesToNextEvent when no timer is running
+const AkUInt32 NO_PENDING_EVENT = 0xFFFFFFFF;
+
+// Seconds the ball high pass and separation delay keep running once the voice stops using them, also how long the
+// separation delay, the convolver and the step cache go unused before ReleaseIdleSubsystems frees them
+const float DEFAULT_IDLE_RELEASE_TIME = 5.0f;
+
+// Output gain of the filter bank, also applied to the convolved surfaces so both renderers match
+const float FILTER_BANK_GAIN = 0.6f;
+
+// Cheaper ways of rendering a voice, each level keeps the savings of the levels before it
+enum GeneratorQuality : int {
+    GENERATOR_QUALITY_FULL = 0,
+    GENERATOR_QUALITY_REDUCED_MODES, // filter bank limited to its first REDUCED_FILTERBANK_MODES modes
+    GENERATOR_QUALITY_NO_CRUNCH, // no crunch grains
+    GENERATOR_QUALITY_CACHED_STEPS, // steps replay a recorded step instead of being synthesized
+    NUM_GENERATOR_QUALITIES
+};
+
+// Fixed cost settings of a voice, authored per platform. The rate divisor is given to PrepareModel
+struct GeneratorTier {
+    AkInt32 MaxModes; // filter bank modes rendered, up to MAX_FILTERBANK_FILTERS
+    bool Crunch; // crunch grains on the surfaces that have them
+    AkInt32 EnvelopeResolution; // samples between two evaluations of the step envelopes, ramped in between
+};
+
+// What a voice starts with, PrepareSubsystems only allocates the parts of the model these need
+struct GeneratorSubsystems {
+    bool Convolution; // resonant surfaces are convolved
+    bool StepCache; // the voice may be switched to GENERATOR_QUALITY_CACHED_STEPS
+    bool OneShot; // a single step, rendered by the single walker path whatever the crowd size
+    AkInt32 Terrain; // flat steps delay their ball by the step separation
+    AkInt32 CrowdSize;
+    AkInt32 SurfaceType; // crunchy surfaces request the crunch grains
+    AkInt32 BlendSurface;
+    AkReal32 IdleReleaseTime; // see SetIdleReleaseTime
+};
+
+// Largest divisor of the output rate the model can run at
+const AkInt32 MAX_RATE_DIVISOR = 4;
+
+// Modes the filter bank keeps from GENERATOR_QUALITY_REDUCED_MODES
+const int REDUCED_FILTERBANK_MODES = 3;
+
+// Randomized filter bank variations of the current modes a voice keeps, drawn between buffers. A step only copies one in
+const int FILTERBANK_VARIATIONS = 8;
+
+// Output recorded from a step's trigger for GENERATOR_QUALITY_CACHED_STEPS, also how long the synthesis
+// keeps running once steps come from the cache, so the last synthesized step rings out
+const float STEP_CACHE_TIME = 0.4f;
+const float STEP_CACHE_FADE_TIME = 0.005f;
+
+// Bytes held by one Generator, per component
+struct GeneratorMemoryFootprint {
+    size_t Object; // the Generator itself, with its filter bank, envelopes and crowd walkers
+    // Parts of Object, in declaration order
+    size_t HotState; // per-sample state rendered from on every sample
+    size_t Walkers; // crowd walkers, only touched in crowd mode
+    size_t Subsystems; // convolver and debug state
+    size_t Configuration; // only read when a step is triggered or a parameter changes
+    size_t SeparationDelay;
+    size_t Convolver;
+    size_t StepCache;
+    size_t ArenaReserved; // blocks held by the arenas, used or not
+    size_t ArenaOverflow; // buffers that did not fit in their arena
+    size_t Total; // Object + ArenaReserved + ArenaOverflow
+};
+
+// Maximum number of walkers a single crowd-mode instance can simulate
+const int MAX_CROWD_WALKERS = 16;
+
+// Per-walker state for crowd mode. Walkers only own their step scheduling and envelopes,
+// the noise, filter bank and crunch grains are shared by the whole crowd.
+struct CrowdWalker {
+    nemlib::Timer StepTimer;
+    nemlib::Timer BallTimer; // delays the ball envelope by the step separation
+    nemlib::CurveEnvelope HeelEnv;
+    nemlib::CurveEnvelope BallEnv;
+    StepShape PendingStep; // ball part of the last step, applied when BallTimer fires
+    float PaceScale = 1.0f;
+    float SteadinessScale = 1.0f;
+};
+
+class Generator
+{
+public:
+	Generator();
+	~Generator();
+
+    //Model Step
+	// Buffers come from in_pAllocator, the global heap without one. The model runs at in_sampleRate / in_RateDivisor
+	// and is interpolated back up to in_sampleRate. False if out of memory
+	bool PrepareModel(AkUInt32 in_sampleRate, AK::IAkPluginMemAlloc* in_pAllocator = nullptr, AkInt32 in_RateDivisor = 1);
+	void SetSeed(AkUInt32 in_Seed); // before PrepareModel, makes the render reproducible
+	void ResetModel(); // back to the just-prepared state without reallocating
+	// After PrepareModel or ResetModel, before rendering. Frees the subsystems left idle by the previous voice, then
+	// allocates the separation delay, convolver and step cache in_Subsystems need and requests the crunch grains.
+	// Without the convolver the voice renders with the filter bank, without the step cache it never caches steps
+	void PrepareSubsystems(const GeneratorSubsystems& in_Subsystems);
+	// Outside the render path, from PrepareSubsystems, a reset or the GeneratorPool. Gives the arenas of the
+	// separation delay, convolver and step cache back once they went unused for the idle release time
+	void ReleaseIdleSubsystems();
+	// Between buffers once the terrain or crowd size changed, allocates the separation delay if a flat single walker
+	// now needs it and PrepareSubsystems did not. Without it, out of memory, the ball stays silent
+	void PrepareBallPath();
+	StepShape UpdateStepEnvelope();
+	float TriggerOneShot(); // single step with no follow-up, returns its length in seconds
+	float IncrementTheModelChannel();
+	float IncrementTheCrowdChannel();
+	float RenderSample(); // one sample at the model's rate
+    void ExcuteModel(AkReal32* pBuf, AkUInt16 in_uValidFrames);
+    void Advance(AkUInt32 in_uFrames); // moves the step scheduling forward without rendering, for virtual voices
+
+    //Set Parameters
+    void SetShoeType(AkInt32 in_ShoeType);
+    void SetSurfaceType(AkInt32 in_SurfaceType);
+    void SetTerrain(AkInt32 in_Terrain);
+    void SetPace(AkReal32 in_Pace);
+    void SetFirmness(AkReal32 in_Firmness);
+    void SetSteadiness(AkReal32 in_Steadiness);
+    void SetAutomeated(bool in_Automated);
+    void SetCrowdSize(AkInt32 in_CrowdSize);
+    void SetPaceSpread(AkReal32 in_PaceSpread);
+    void SetSteadinessSpread(AkReal32 in_SteadinessSpread);
+    void SetConvolution(bool in_Convolution);
+    // Blends the surface towards in_BlendSurface by in_SurfaceBlend (0-1), re-evaluated on the next step
+    void SetBlendSurface(AkInt32 in_BlendSurface);
+    void SetSurfaceBlend(AkReal32 in_SurfaceBlend);
+    void SetQualityLevel(AkInt32 in_Level); // GeneratorQuality, steps down to NO_CRUNCH without a prepared step cache
+    AkInt32 GetQualityLevel() const { return QualityLevel; }
+    void SetTier(const GeneratorTier& in_Tier);
+    // The ball path stops running after in_Seconds unused, and ReleaseIdleSubsystems frees what went unused that long.
+    // 0 keeps everything running and allocated
+    void SetIdleReleaseTime(AkReal32 in_Seconds);
+
+    //Parameter curves, glide from the current value and are evaluated once per buffer
+    void SetPaceCurve(AkReal32 in_Target, AkReal32 in_Time);
+    void SetPaceCurve(const AkReal32* in_pValues, const AkReal32* in_pTimes, AkInt32 in_NumPoints);
+    void SetFirmnessCurve(AkReal32 in_Target, AkReal32 in_Time);
+    void SetFirmnessCurve(const AkReal32* in_pValues, const AkReal32* in_pTimes, AkInt32 in_NumPoints);
+
+	//Model Parameters Update
+	void UpdatePaceModifiers(float Pace);
+	void UpdateShoeModifiers(int ShoeType);
+	void UpdateSurfaceModifiers(int SurfaceType);
+	void UpdateSurfaceBlend();
+	bool IsBlendingSurfaces() const;
+
+	void CrunchLoop();
+	bool UseCrunch() const { return CrunchFlag && Tier.Crunch && QualityLevel < GENERATOR_QUALITY_NO_CRUNCH; }
+	int GetMaxModes() const;
+	void SetEnvelopeResolution(CrowdWalker& Walker) const;
+	void VaryFilterBank();
+	const nemlib::Mode* GetVariedModes() const;
+	void ResetFilterVariations();
+	bool RefillFilterVariation();
+	void SelectImpulseBank();
+	bool PrepareConvolver();
+	bool NeedsBallPath() const;
+	void RequestCrunchBank(int SurfaceType);
+	void WakeBallPath(float Separation);
+	void CountIdleFrames(AkUInt32 in_uFrames);
+
+	// The two halves of IncrementTheModelChannel, shared with the fused render
+	bool ScheduleSample(); // true when a step was triggered
+	float SynthesizeSample();
+	int GetFusedPath() const;
+	AkUInt32 RenderFused(AkReal32* pBuf, AkUInt32 in_uFrames);
+
+    ShoeEnvelope AddVariation();
+    StepShape MakeStepShape();
+
+    void TriggerStep();
+
+    //Step cache
+    bool PrepareStepCache();
+    void InvalidateStepCache();
+    void BeginStepRecording();
+    void FinishStepRecording();
+    void TriggerCachedStep();
+    float IncrementTheCachedChannel();
+    void ResumeSynthesis();
+    void RestartSignalPath();
+
+    //Crowd
+    void SpawnWalker(CrowdWalker& Walker);
+    void TriggerWalkerStep(CrowdWalker& Walker);
+    void TriggerWalkerBall(CrowdWalker& Walker);
+
+    //Virtual voice
+    AkUInt32 FramesToNextEvent() const; // NO_PENDING_EVENT when no timer runs
+    void SkipFrames(AkUInt32 in_uFrames);
+    void UpdateCurves(AkUInt32 in_uFrames);
+
+    GeneratorMemoryFootprint GetMemoryFootprint() const;
+
+#if FOOTSTEPS_PROFILE_STAGES
+    StageProfiler& GetProfiler() { return Profiler; }
+#endif
+#if FOOTSTEPS_TRACE_EVENTS
+    TraceRing& GetTrace() { return Trace; }
+#endif
+
+    //
+    AkInt32 m_sampleRate;//sample rate the model runs at
+    AkInt32 m_outputRate; // rate ExcuteModel writes at
+    AkInt32 m_RateDivisor; // m_outputRate / m_sampleRate
+    AkInt32 m_ShoeType;
+    AkInt32 m_SurfaceType;
+    AkInt32 m_Terrain;
+    AkReal32 m_Pace;
+    AkReal32 m_Firmness;
+    AkReal32 m_Steadiness;
+    bool m_Automated;
+    AkInt32 m_CrowdSize;
+    AkReal32 m_PaceSpread;
+    AkReal32 m_SteadinessSpread;
+    bool m_Convolution;
+    AkInt32 m_BlendSurface;
+    AkReal32 m_SurfaceBlend;
+
+private:
+
+    // Every buffer of the voice is carved from these arenas. Declared first so they are destroyed last
+    PluginAllocator MemAllocator;
+    nemlib::Arena CoreArena; // separation delay, only reserved while flat single walker steps need it
+    nemlib::Arena ConvolutionArena; // convolver, only reserved once convolution is used
+    nemlib::Arena CacheArena; // step cache, only reserved once the voice renders cached steps
+
+    // Per-sample state, packed at the front of the object so a voice renders from as few cache lines as possible
+    nemlib::WhiteNoiseGen Noise;
+    nemlib::CurveEnvelope HeelEnv;
+    nemlib::CurveEnvelope BallEnv;
+    nemlib::Timer StepTimer;
+    nemlib::Timer CrunchTimer;
+    nemlib::GrainPlayer CrunchGrains;
+    nemlib::BiquadFilter Highpass;
+    nemlib::BiquadFilter OutHP;
+    nemlib::BiquadFilter OutLP;
+    nemlib::Delay SeparationDelay;
+    nemlib::FilterBank Filters;
+    float CrunchOut = 0.0f;
+    float FiltersOut = 1.0f;
+    float LastOut = 0.0f;
+    float StepCounter = 0.0f;
+    float CrowdGain = 1.0f;
+    float NoiseGain = 1.0f;
+    int NumWalkers = 0;
+    bool CrunchFlag = false;
+    bool BallPathActive = false; // high pass and separation delay run, from the first step with a ball until idle
+    bool OneShot = false; // set by TriggerOneShot until the next ResetModel
+
+    // Cached steps, the synthesis stops once the last synthesized step has rung out
+    nemlib::GrainPlayer CachePlayer;
+    int QualityLevel = GENERATOR_QUALITY_FULL;
+    int StepCacheLength = 0; // samples recorded so far
+    bool StepCacheRecording = false;
+    bool StepCacheValid = false;
+    bool SynthesisActive = true;
+    AkUInt32 SynthesisDrainFrames = 0; // output frames left before the synthesis stops, 0 while not draining
+    nemlib::Buffer<float> StepCache; // output of one whole step, at the voice's level
+
+    // Back to the output rate, the model's output is interpolated one model sample late
+    float UpsamplePrevious = 0.0f;
+    float UpsampleCurrent = 0.0f;
+    int UpsamplePhase = 0;
+    GeneratorTier Tier = { nemlib::MAX_FILTERBANK_FILTERS, true, 1 };
+
+    // Output frames each subsystem has gone unused for, carried over to the next voice of a pooled Generator
+    AkUInt32 IdleReleaseFrames = 0; // 0 keeps them running and allocated
+    AkUInt32 BallPathIdleFrames = 0;
+    AkUInt32 ConvolverIdleFrames = 0;
+    AkUInt32 StepCacheIdleFrames = 0;
+    float BallSeparation = 0.0f; // of the last step with a ball, set on the delay if it is allocated under that step
+
+    // Crowd Walkers, only touched in crowd mode
+    CrowdWalker Walkers[MAX_CROWD_WALKERS];
+
+    // Resonant surfaces in convolution mode, prepared by PrepareSubsystems
+    nemlib::PartitionedConvolver Convolver;
+    const SurfaceImpulseBank* ImpulseBank = nullptr; // set while the current surface is convolved
+
+#if FOOTSTEPS_PROFILE_STAGES
+    StageProfiler Profiler;
+#endif
+#if FOOTSTEPS_TRACE_EVENTS
+    TraceRing Trace;
+#endif
+
+    // Configuration, only read when a step is triggered or a parameter changes
+    nemlib::Random Rng; // per-voice random stream, so the model can be rendered off the audio thread
+    nemlib::ControlCurve PaceCurve;
+    nemlib::ControlCurve FirmnessCurve; // in parameter units, m_Firmness holds the inverse
+    // Model Variables
+    //float Pace = 82.0f;
+    //float Steadiness = 0.1f;
+    //float Firmness = 0.3f;
+    //bool Automated = false;
+    ShoeEnvelope Shoe = { 1.0f, 1.0f, 0.0f, 10.0f, 0.1f, 40.0f, 0.5f, 1.0f, 0.0f, 20.0f, 0.1f };
+    SurfaceEnvelope Surface = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    //int SurfaceType;
+    //int ShoeType;
+    //int TerrainType = 0;
+    // Helper variables
+    float RollSpeedPercentage = 1.92f;
+    float HeelToBallRatio[2] = { 0.8f, 0.5f };
+    const CrunchGrainBank* CrunchBank = nullptr; // shared by every voice at this sample rate, may not be built yet
+    int ModelSurface = 0; // surface the modifiers were last set up for
+    nemlib::Mode BlendedModes = {}; // modes the filter bank glides to while two surfaces are blended
+    float CrunchBlend = 0.0f; // chance a crunch grain comes from m_BlendSurface
+    bool SurfaceBlended = false; // the filter bank holds a blend, surface changes glide instead of restarting it
+    bool SurfaceBlendChanged = false;
+    bool ResonantFlag = false;
+    float Delay1 = 0.0f;
+    float Delay2 = 0.0f;
+    // Constants, shared by every voice
+    static const int NUM_SURFACES = 6;
+    static const nemlib::Mode Modes[NUM_SURFACES];
+    static const SurfaceProfile SurfaceProfiles[NUM_SURFACES];
+    // Banks of every resonant surface, requested with the convolver by PrepareSubsystems and used once built
+    const SurfaceImpulseBank* ImpulseBanks[NUM_SURFACES] = {};
+    // Variations of the current modes, the first NumFilterVariations are drawn. The ones steps have used are drawn
+    // again between buffers, one per buffer. Both these and the convolved variations come from VariationRng, so the
+    // steps' other draws do not depend on how often the filter bank is varied
+    nemlib::Random VariationRng;
+    nemlib::FilterBankVariation FilterVariations[FILTERBANK_VARIATIONS];
+    int NumFilterVariations = 0;
+    AkUInt32 UsedFilterVariations = 0; // one bit per variation
+};
@@ -0,0 +1,126 @@
+#include "GeneratorPool.h"
+#include "SharedBank.h"
+#include "../FootstepsConfig.h"
+
+#include <mutex>
+
+namespace
+{
+    const AkUInt32 MAX_POOL_OUTPUT_RATES = 4;
+    // Buckets, one per sample rate and rate divisor. Generators of a combination beyond these are freed instead of pooled
+    const AkUInt32 MAX_POOL_SAMPLE_RATES = MAX_POOL_OUTPUT_RATES * MAX_RATE_DIVISOR;
+    const AkUInt32 MAX_POOLED_GENERATORS = 32;
+
+    struct Bucket
+    {
+        AkUInt32 uSampleRate;
+        AkInt32 iRateDivisor;
+        AkUInt32 uNumGenerators;
+        Generator* pGenerators[MAX_POOLED_GENERATORS];
+    };
+
+    std::mutex s_PoolLock;
+    Bucket s_Buckets[MAX_POOL_SAMPLE_RATES] = {};
+    bool s_bTermCallbackRegistered = false;
+
+    Bucket* FindBucket(AkUInt32 in_uSampleRate, AkInt32 in_iRateDivisor, bool in_bCreate)
+    {
+        Bucket* pFree = nullptr;
+        for (AkUInt32 i = 0; i < MAX_POOL_SAMPLE_RATES; ++i)
+        {
+            if (s_Buckets[i].uSampleRate == in_uSampleRate && s_Buckets[i].iRateDivisor == in_iRateDivisor)
+                return &s_Buckets[i];
+            if (pFree == nullptr && s_Buckets[i].uNumGenerators == 0)
+                pFree = &s_Buckets[i];
+        }
+        if (!in_bCreate || pFree == nullptr)
+            return nullptr;
+
+        pFree->uSampleRate = in_uSampleRate;
+        pFree->iRateDivisor = in_iRateDivisor;
+        return pFree;
+    }
+
+    void OnSoundEngineTerm(AK::IAkGlobalPluginContext* in_pContext, AkGlobalCallbackLocation in_eLocation, void* in_pCookie)
+    {
+        GeneratorPool::Clear(in_pContext->GetAllocator());
+        // The banks the Generators shared, no voice is left to use them
+        SharedBank::Clear();
+        std::lock_guard<std::mutex> Lock(s_PoolLock);
+        s_bTermCallbackRegistered = false;
+    }
+}
+
+Generator* GeneratorPool::Acquire(AK::IAkPluginMemAlloc* in_pAllocator, AK::IAkGlobalPluginContext* in_pGlobalContext, AkUInt32 in_uSampleRate, AkInt32 in_iRateDivisor)
+{
+    {
+        std::lock_guard<std::mutex> Lock(s_PoolLock);
+        if (!s_bTermCallbackRegistered && in_pGlobalContext != nullptr)
+        {
+            s_bTermCallbackRegistered = in_pGlobalContext->RegisterGlobalCallback(
+                AkPluginTypeSource,
+                FootstepsConfig::CompanyID,
+                FootstepsConfig::PluginID,
+                OnSoundEngineTerm,
+                AkGlobalCallbackLocation_Term) == AK_Success;
+        }
+
+        Bucket* pBucket = FindBucket(in_uSampleRate, in_iRateDivisor, false);
+        if (pBucket != nullptr && pBucket->uNumGenerators > 0)
+        {
+            Generator* pGenerator = pBucket->pGenerators[--pBucket->uNumGenerators];
+            pGenerator->ResetModel();
+            return pGenerator;
+        }
+    }
+
+    //Pool empty for this rate, pay for a full preparation
+    Generator* pGenerator = AK_PLUGIN_NEW(in_pAllocator, Generator());
+    if (pGenerator == nullptr)
+        return nullptr;
+    if (!pGenerator->PrepareModel(in_uSampleRate, in_pAllocator, in_iRateDivisor))
+    {
+        AK_PLUGIN_DELETE(in_pAllocator, pGenerator);
+        return nullptr;
+    }
+    return pGenerator;
+}
+
+void GeneratorPool::Release(AK::IAkPluginMemAlloc* in_pAllocator, Generator* in_pGenerator)
+{
+    if (in_pGenerator == nullptr)
+        return;
+
+    //A pooled Generator only keeps the subsystems its last voice used recently
+    in_pGenerator->ReleaseIdleSubsystems();
+
+    {
+        std::lock_guard<std::mutex> Lock(s_PoolLock);
+        // Without the Term callback nothing would free the pool on shutdown
+        if (s_bTermCallbackRegistered)
+        {
+            Bucket* pBucket = FindBucket(in_pGenerator->m_outputRate, in_pGenerator->m_RateDivisor, true);
+            if (pBucket != nullptr && pBucket->uNumGenerators < MAX_POOLED_GENERATORS)
+            {
+                pBucket->pGenerators[pBucket->uNumGenerators++] = in_pGenerator;
+                return;
+            }
+        }
+    }
+
+    AK_PLUGIN_DELETE(in_pAllocator, in_pGenerator);
+}
+
+void GeneratorPool::Clear(AK::IAkPluginMemAlloc* in_pAllocator)
+{
+    std::lock_guard<std::mutex> Lock(s_PoolLock);
+    for (AkUInt32 i = 0; i < MAX_POOL_SAMPLE_RATES; ++i)
+    {
+        while (s_Buckets[i].uNumGenerators > 0)
+        {
+            AK_PLUGIN_DELETE(in_pAllocator, s_Buckets[i].pGenerators[--s_Buckets[i].uNumGenerators]);
+        }
+        s_Buckets[i].uSampleRate = 0;
+        s_Buckets[i].iRateDivisor = 0;
+    }
+}
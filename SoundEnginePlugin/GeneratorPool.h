@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Generator.h"
+#include <AK/SoundEngine/Common/IAkPlugin.h>
+
+// Process-wide pool of prepared Generators, keyed by sample rate and rate divisor.
+// Term() hands its Generator back instead of freeing it, so the next voice started at the same
+// rate only pays for ResetModel() instead of PrepareModel()'s allocations and coefficient setup.
+// The pooled Generators are freed when the sound engine terminates.
+class GeneratorPool
+{
+public:
+    // Returns a Generator prepared for in_uSampleRate and in_iRateDivisor, nullptr if out of memory
+    static Generator* Acquire(AK::IAkPluginMemAlloc* in_pAllocator, AK::IAkGlobalPluginContext* in_pGlobalContext, AkUInt32 in_uSampleRate, AkInt32 in_iRateDivisor = 1);
+    // Keeps in_pGenerator for a later Acquire(), or frees it if its bucket is full. Its idle subsystems are freed first
+    static void Release(AK::IAkPluginMemAlloc* in_pAllocator, Generator* in_pGenerator);
+    // Frees every pooled Generator
+    static void Clear(AK::IAkPluginMemAlloc* in_pAllocator);
+};
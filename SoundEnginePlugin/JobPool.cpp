@@ -0,0 +1,118 @@
+#include "JobPool.h"
+
+JobPool::JobPool(AkUInt32 in_uNumThreads)
+    : m_uNumThreads(in_uNumThreads > 0 ? in_uNumThreads : 1)
+    , m_Queues(m_uNumThreads)
+    , m_uGeneration(0)
+    , m_bStop(false)
+    , m_pJob(nullptr)
+    , m_uPending(0)
+{
+    for (AkUInt32 i = 1; i < m_uNumThreads; ++i)
+    {
+        m_Threads.emplace_back(&JobPool::WorkerLoop, this, i);
+    }
+}
+
+JobPool::~JobPool()
+{
+    {
+        std::lock_guard<std::mutex> Lock(m_WakeLock);
+        m_bStop = true;
+    }
+    m_Wake.notify_all();
+    for (std::thread& Thread : m_Threads)
+    {
+        Thread.join();
+    }
+}
+
+void JobPool::Run(AkUInt32 in_uNumJobs, const std::function<void(AkUInt32)>& in_Job)
+{
+    if (in_uNumJobs == 0)
+        return;
+
+    m_pJob = &in_Job;
+    m_uPending.store(in_uNumJobs);
+
+    // Contiguous blocks keep neighbouring jobs on the same core until stealing kicks in
+    for (AkUInt32 w = 0; w < m_uNumThreads; ++w)
+    {
+        AkUInt32 uBegin = (AkUInt32)((AkUInt64)in_uNumJobs * w / m_uNumThreads);
+        AkUInt32 uEnd = (AkUInt32)((AkUInt64)in_uNumJobs * (w + 1) / m_uNumThreads);
+        std::lock_guard<std::mutex> Lock(m_Queues[w].Lock);
+        for (AkUInt32 i = uBegin; i < uEnd; ++i)
+        {
+            m_Queues[w].Jobs.push_back(i);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock(m_WakeLock);
+        ++m_uGeneration;
+    }
+    m_Wake.notify_all();
+
+    Work(0);
+
+    std::unique_lock<std::mutex> Lock(m_WakeLock);
+    m_Done.wait(Lock, [this] { return m_uPending.load() == 0; });
+}
+
+void JobPool::WorkerLoop(AkUInt32 in_uWorker)
+{
+    AkUInt64 uSeenGeneration = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> Lock(m_WakeLock);
+            m_Wake.wait(Lock, [&] { return m_bStop || m_uGeneration != uSeenGeneration; });
+            if (m_bStop)
+                return;
+            uSeenGeneration = m_uGeneration;
+        }
+        Work(in_uWorker);
+    }
+}
+
+void JobPool::Work(AkUInt32 in_uWorker)
+{
+    AkUInt32 uJob;
+    while (PopOrSteal(in_uWorker, uJob))
+    {
+        (*m_pJob)(uJob);
+        if (m_uPending.fetch_sub(1) == 1)
+        {
+            std::lock_guard<std::mutex> Lock(m_WakeLock);
+            m_Done.notify_all();
+        }
+    }
+}
+
+bool JobPool::PopOrSteal(AkUInt32 in_uWorker, AkUInt32& out_uJob)
+{
+    {
+        JobQueue& Own = m_Queues[in_uWorker];
+        std::lock_guard<std::mutex> Lock(Own.Lock);
+        if (!Own.Jobs.empty())
+        {
+            out_uJob = Own.Jobs.back();
+            Own.Jobs.pop_back();
+            return true;
+        }
+    }
+
+    for (AkUInt32 i = 1; i < m_uNumThreads; ++i)
+    {
+        JobQueue& Victim = m_Queues[(in_uWorker + i) % m_uNumThreads];
+        std::lock_guard<std::mutex> Lock(Victim.Lock);
+        if (!Victim.Jobs.empty())
+        {
+            out_uJob = Victim.Jobs.front();
+            Victim.Jobs.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
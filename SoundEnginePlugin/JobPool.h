@@ -0,0 +1,87 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkCommonDefs.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+// Bytes a cache line holds on the targets we ship on
+const size_t CACHE_LINE_SIZE = 64;
+
+// std::allocator only honours alignas beyond alignof(std::max_align_t) from C++17 on. This one starts every
+// allocation on a cache line whatever the standard, for containers of cache-line aligned elements
+template <typename T>
+struct CacheLineAllocator
+{
+    typedef T value_type;
+
+    CacheLineAllocator() {}
+    template <typename U>
+    CacheLineAllocator(const CacheLineAllocator<U>&) {}
+
+    T* allocate(size_t in_uCount)
+    {
+        // The pointer operator new returned is kept just before the aligned block
+        char* pBlock = static_cast<char*>(::operator new(in_uCount * sizeof(T) + CACHE_LINE_SIZE + sizeof(void*)));
+        char* pAligned = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(pBlock + sizeof(void*)) + CACHE_LINE_SIZE - 1) & ~(uintptr_t)(CACHE_LINE_SIZE - 1));
+        reinterpret_cast<void**>(pAligned)[-1] = pBlock;
+        return reinterpret_cast<T*>(pAligned);
+    }
+
+    void deallocate(T* in_pMemory, size_t)
+    {
+        ::operator delete(reinterpret_cast<void**>(in_pMemory)[-1]);
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const CacheLineAllocator<T>&, const CacheLineAllocator<U>&) { return true; }
+template <typename T, typename U>
+bool operator!=(const CacheLineAllocator<T>&, const CacheLineAllocator<U>&) { return false; }
+
+// Fork-join pool of worker threads with one job queue per worker.
+// Each worker drains its own queue from the back and steals from the front of the others once
+// it runs dry, so uneven jobs (e.g. voices with different surfaces) still keep every core busy.
+class JobPool
+{
+public:
+    // in_uNumThreads includes the calling thread, which takes part in every Run()
+    JobPool(AkUInt32 in_uNumThreads);
+    ~JobPool();
+
+    AkUInt32 GetNumThreads() const { return m_uNumThreads; }
+
+    // Calls in_Job(i) for every i in [0, in_uNumJobs) and returns once they have all completed
+    void Run(AkUInt32 in_uNumJobs, const std::function<void(AkUInt32)>& in_Job);
+
+private:
+    struct alignas(CACHE_LINE_SIZE) JobQueue
+    {
+        std::mutex Lock;
+        std::deque<AkUInt32> Jobs;
+    };
+
+    void WorkerLoop(AkUInt32 in_uWorker);
+    void Work(AkUInt32 in_uWorker);
+    bool PopOrSteal(AkUInt32 in_uWorker, AkUInt32& out_uJob);
+
+    AkUInt32 m_uNumThreads;
+    std::vector<JobQueue, CacheLineAllocator<JobQueue>> m_Queues;
+    std::vector<std::thread> m_Threads;
+
+    std::mutex m_WakeLock;
+    std::condition_variable m_Wake;
+    std::condition_variable m_Done;
+    AkUInt64 m_uGeneration;
+    bool m_bStop;
+
+    const std::function<void(AkUInt32)>* m_pJob;
+    std::atomic<AkUInt32> m_uPending;
+};
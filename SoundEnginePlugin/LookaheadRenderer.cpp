@@ -0,0 +1,294 @@
+#include "LookaheadRenderer.h"
+#include "GeneratorPool.h"
+#include "SharedBank.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    const AkUInt32 MAX_LOOKAHEAD_VOICES = 256;
+    const AkUInt32 LOOKAHEAD_CHUNK_FRAMES = 256;
+
+    // Who holds the slot's Generator, every hand-over is a single compare and swap
+    enum LookaheadSlotState : AkUInt32
+    {
+        SLOT_FREE = 0,
+        SLOT_HELD, // the voice renders or changes the Generator, the worker leaves it alone
+        SLOT_LENT, // the worker may start a chunk
+        SLOT_RENDERING, // the worker renders a chunk
+        SLOT_RENDERING_RETURN, // same, the voice asked for the Generator back at the end of the chunk
+        SLOT_RENDERING_RETIRE // same, the voice is gone and the worker frees the slot at the end of the chunk
+    };
+}
+
+// Lives in a static table rather than in the voice, so the worker can finish a chunk after the voice's Term
+struct LookaheadSlot
+{
+    std::atomic<AkUInt32> uState{ SLOT_FREE };
+    // Set by the voice while it holds the free slot, constant until it is freed
+    Generator* pGenerator = nullptr;
+    AK::IAkPluginMemAlloc* pAllocator = nullptr;
+    AkReal32* pRing = nullptr;
+    AkUInt32 uCapacity = 0; // power of two
+    std::atomic<AkUInt32> uTarget{ 0 };
+    std::atomic<AkUInt32> uReadPos{ 0 };
+    std::atomic<AkUInt32> uWritePos{ 0 };
+};
+
+namespace
+{
+    LookaheadSlot s_Slots[MAX_LOOKAHEAD_VOICES];
+
+    // Started and stopped off the audio thread, by the registration and termination callbacks
+    std::mutex s_WorkerLock;
+    std::thread s_WorkerThread;
+    std::atomic<bool> s_bWorkerRunning(false);
+    std::atomic<bool> s_bWorkerStop(false);
+
+    void FreeSlot(LookaheadSlot& io_Slot)
+    {
+        AK_PLUGIN_FREE(io_Slot.pAllocator, io_Slot.pRing);
+        io_Slot.pRing = nullptr;
+        io_Slot.pGenerator = nullptr;
+        io_Slot.pAllocator = nullptr;
+        io_Slot.uState.store(SLOT_FREE, std::memory_order_release);
+    }
+
+    bool RenderAhead(LookaheadSlot& io_Slot)
+    {
+        const AkUInt32 uWritePos = io_Slot.uWritePos.load(std::memory_order_relaxed);
+        const AkUInt32 uFilled = uWritePos - io_Slot.uReadPos.load(std::memory_order_acquire);
+        if (uFilled + LOOKAHEAD_CHUNK_FRAMES > io_Slot.uTarget.load(std::memory_order_relaxed))
+            return false;
+
+        // Chunks never straddle the end of the ring since the capacity is a multiple of the chunk size
+        io_Slot.pGenerator->ExcuteModel(io_Slot.pRing + (uWritePos & (io_Slot.uCapacity - 1)), (AkUInt16)LOOKAHEAD_CHUNK_FRAMES);
+
+        io_Slot.uWritePos.store(uWritePos + LOOKAHEAD_CHUNK_FRAMES, std::memory_order_release);
+        return true;
+    }
+
+    void WorkerLoop()
+    {
+        while (!s_bWorkerStop.load(std::memory_order_acquire))
+        {
+            bool bDidWork = false;
+            for (AkUInt32 i = 0; i < MAX_LOOKAHEAD_VOICES; ++i)
+            {
+                LookaheadSlot& Slot = s_Slots[i];
+                AkUInt32 uState = SLOT_LENT;
+                if (!Slot.uState.compare_exchange_strong(uState, SLOT_RENDERING, std::memory_order_acquire, std::memory_order_relaxed))
+                    continue;
+
+                bDidWork |= RenderAhead(Slot);
+
+                // The voice may have asked for the Generator back or gone away during the chunk
+                uState = SLOT_RENDERING;
+                if (Slot.uState.compare_exchange_strong(uState, SLOT_LENT, std::memory_order_release, std::memory_order_acquire))
+                    continue;
+                if (uState == SLOT_RENDERING_RETURN)
+                {
+                    Slot.uState.store(SLOT_HELD, std::memory_order_release);
+                }
+                else
+                {
+                    GeneratorPool::Release(Slot.pAllocator, Slot.pGenerator);
+                    FreeSlot(Slot);
+                }
+            }
+
+            // Banks voices requested since the last loop, they play without them until then
+            SharedBank::BuildRequested();
+
+            if (!bDidWork)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+LookaheadRenderer::LookaheadRenderer()
+    : m_pSlot(nullptr)
+    , m_uSampleRate(0)
+{
+}
+
+LookaheadRenderer::~LookaheadRenderer()
+{
+}
+
+void LookaheadRenderer::StartWorker()
+{
+    std::lock_guard<std::mutex> Lock(s_WorkerLock);
+    if (s_bWorkerRunning.load(std::memory_order_relaxed))
+        return;
+
+    s_bWorkerStop.store(false, std::memory_order_relaxed);
+    s_WorkerThread = std::thread(WorkerLoop);
+    s_bWorkerRunning.store(true, std::memory_order_release);
+    SharedBank::SetBuilderRunning(true);
+}
+
+void LookaheadRenderer::StopWorker()
+{
+    std::lock_guard<std::mutex> Lock(s_WorkerLock);
+    if (!s_bWorkerRunning.load(std::memory_order_relaxed))
+        return;
+
+    // Voices are terminated before the sound engine, the worker has no slot left to render
+    s_bWorkerRunning.store(false, std::memory_order_relaxed);
+    SharedBank::SetBuilderRunning(false);
+    s_bWorkerStop.store(true, std::memory_order_release);
+    s_WorkerThread.join();
+}
+
+AKRESULT LookaheadRenderer::Init(AK::IAkPluginMemAlloc* in_pAllocator, Generator* in_pGenerator, AkUInt32 in_uSampleRate)
+{
+    m_uSampleRate = in_uSampleRate;
+    if (!s_bWorkerRunning.load(std::memory_order_acquire))
+        return AK_Success;
+
+    LookaheadSlot* pSlot = nullptr;
+    for (AkUInt32 i = 0; i < MAX_LOOKAHEAD_VOICES && pSlot == nullptr; ++i)
+    {
+        AkUInt32 uState = SLOT_FREE;
+        if (s_Slots[i].uState.compare_exchange_strong(uState, SLOT_HELD, std::memory_order_acquire, std::memory_order_relaxed))
+            pSlot = &s_Slots[i];
+    }
+    if (pSlot == nullptr)
+        return AK_Success;
+
+    AkUInt32 uMaxFrames = (AkUInt32)(MAX_LOOKAHEAD_TIME * (AkReal32)in_uSampleRate);
+    AkUInt32 uCapacity = LOOKAHEAD_CHUNK_FRAMES;
+    while (uCapacity < uMaxFrames)
+        uCapacity <<= 1;
+
+    pSlot->pRing = (AkReal32*)AK_PLUGIN_ALLOC(in_pAllocator, uCapacity * sizeof(AkReal32));
+    if (pSlot->pRing == nullptr)
+    {
+        pSlot->uState.store(SLOT_FREE, std::memory_order_release);
+        return AK_InsufficientMemory;
+    }
+    pSlot->pGenerator = in_pGenerator;
+    pSlot->pAllocator = in_pAllocator;
+    pSlot->uCapacity = uCapacity;
+    pSlot->uTarget.store(0, std::memory_order_relaxed);
+    pSlot->uReadPos.store(0, std::memory_order_relaxed);
+    pSlot->uWritePos.store(0, std::memory_order_relaxed);
+    m_pSlot = pSlot;
+    return AK_Success;
+}
+
+bool LookaheadRenderer::Term(AK::IAkPluginMemAlloc* in_pAllocator)
+{
+    if (m_pSlot == nullptr)
+        return true;
+
+    LookaheadSlot& Slot = *m_pSlot;
+    m_pSlot = nullptr;
+    AkUInt32 uState = Slot.uState.load(std::memory_order_acquire);
+    for (;;)
+    {
+        if (uState == SLOT_HELD || uState == SLOT_LENT)
+        {
+            if (Slot.uState.compare_exchange_weak(uState, SLOT_HELD, std::memory_order_acquire, std::memory_order_acquire))
+            {
+                FreeSlot(Slot);
+                return true;
+            }
+        }
+        else if (Slot.uState.compare_exchange_weak(uState, SLOT_RENDERING_RETIRE, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            return false;
+        }
+    }
+}
+
+void LookaheadRenderer::SetLookaheadTime(AkReal32 in_fTime)
+{
+    if (m_pSlot == nullptr)
+        return;
+    AkUInt32 uFrames = (AkUInt32)(std::max(in_fTime, 0.0f) * (AkReal32)m_uSampleRate);
+    m_pSlot->uTarget.store(std::min(uFrames, m_pSlot->uCapacity), std::memory_order_relaxed);
+}
+
+bool LookaheadRenderer::IsEnabled() const
+{
+    return m_pSlot != nullptr && m_pSlot->uTarget.load(std::memory_order_relaxed) >= LOOKAHEAD_CHUNK_FRAMES;
+}
+
+bool LookaheadRenderer::IsLent() const
+{
+    return m_pSlot != nullptr && m_pSlot->uState.load(std::memory_order_acquire) != SLOT_HELD;
+}
+
+void LookaheadRenderer::Lend()
+{
+    if (m_pSlot != nullptr)
+        m_pSlot->uState.store(SLOT_LENT, std::memory_order_release);
+}
+
+bool LookaheadRenderer::Reclaim()
+{
+    if (m_pSlot == nullptr)
+        return true;
+
+    AkUInt32 uState = m_pSlot->uState.load(std::memory_order_acquire);
+    for (;;)
+    {
+        switch (uState)
+        {
+        case SLOT_HELD:
+            return true;
+        case SLOT_LENT:
+            if (m_pSlot->uState.compare_exchange_weak(uState, SLOT_HELD, std::memory_order_acquire, std::memory_order_acquire))
+                return true;
+            break;
+        case SLOT_RENDERING:
+            if (m_pSlot->uState.compare_exchange_weak(uState, SLOT_RENDERING_RETURN, std::memory_order_acq_rel, std::memory_order_acquire))
+                return false;
+            break;
+        default:
+            return false;
+        }
+    }
+}
+
+void LookaheadRenderer::Clear()
+{
+    if (m_pSlot != nullptr)
+        m_pSlot->uReadPos.store(m_pSlot->uWritePos.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+AkUInt32 LookaheadRenderer::Read(AkReal32* out_pBuf, AkUInt32 in_uFrames)
+{
+    if (m_pSlot == nullptr)
+        return 0;
+
+    LookaheadSlot& Slot = *m_pSlot;
+    const AkUInt32 uReadPos = Slot.uReadPos.load(std::memory_order_relaxed);
+    const AkUInt32 uFrames = std::min(in_uFrames, Slot.uWritePos.load(std::memory_order_acquire) - uReadPos);
+
+    const AkUInt32 uIndex = uReadPos & (Slot.uCapacity - 1);
+    const AkUInt32 uFirst = std::min(uFrames, Slot.uCapacity - uIndex);
+    memcpy(out_pBuf, Slot.pRing + uIndex, uFirst * sizeof(AkReal32));
+    memcpy(out_pBuf + uFirst, Slot.pRing, (uFrames - uFirst) * sizeof(AkReal32));
+
+    Slot.uReadPos.store(uReadPos + uFrames, std::memory_order_release);
+    return uFrames;
+}
+
+AkUInt32 LookaheadRenderer::Skip(AkUInt32 in_uFrames)
+{
+    if (m_pSlot == nullptr)
+        return 0;
+
+    LookaheadSlot& Slot = *m_pSlot;
+    const AkUInt32 uReadPos = Slot.uReadPos.load(std::memory_order_relaxed);
+    const AkUInt32 uFrames = std::min(in_uFrames, Slot.uWritePos.load(std::memory_order_acquire) - uReadPos);
+    Slot.uReadPos.store(uReadPos + uFrames, std::memory_order_release);
+    return uFrames;
+}
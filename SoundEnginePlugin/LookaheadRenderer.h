@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Generator.h"
+#include <AK/SoundEngine/Common/IAkPlugin.h>
+#include <atomic>
+
+// Longest lookahead a renderer can be configured with, in seconds
+const AkReal32 MAX_LOOKAHEAD_TIME = 0.5f;
+
+struct LookaheadSlot;
+
+// Renders an automated Generator ahead of time on the shared lookahead worker thread.
+// The worker is started when the plug-in is registered with the sound engine and stopped when the sound engine
+// terminates, voices only claim one of its slots. It also builds the SharedBanks voices request. The worker is
+// the single producer of the slot's ring and the audio thread its single consumer.
+// The Generator is handed back and forth through the slot's state without locking, the audio thread never waits
+// for the worker. It lends the Generator with Lend() and takes it back with Reclaim() before rendering or changing
+// it. A parameter change makes what the worker rendered stale: the voice drops the ring with Clear() as soon as it
+// holds the Generator again, renders inline with the new parameters and only lends it again once they settle.
+class LookaheadRenderer
+{
+public:
+    LookaheadRenderer();
+    ~LookaheadRenderer();
+
+    // From the plug-in's registration and sound engine termination callbacks
+    static void StartWorker();
+    static void StopWorker();
+
+    // Allocates the ring and claims a slot. Without a worker or a free slot the voice renders inline
+    AKRESULT Init(AK::IAkPluginMemAlloc* in_pAllocator, Generator* in_pGenerator, AkUInt32 in_uSampleRate);
+    // Releases the slot. False if the worker is rendering the Generator right now, it then frees the ring and
+    // hands the Generator back to the GeneratorPool itself
+    bool Term(AK::IAkPluginMemAlloc* in_pAllocator);
+
+    //Audio thread
+    void SetLookaheadTime(AkReal32 in_fTime);
+    bool IsEnabled() const;
+    // True while the worker may be using the Generator
+    bool IsLent() const;
+    // Hands the Generator to the worker, only while the voice holds it
+    void Lend();
+    // Takes the Generator back, true if the voice holds it. False while the worker renders a chunk with it,
+    // the worker then hands it back when the chunk is done
+    bool Reclaim();
+    // Drops what was rendered ahead, only while the voice holds the Generator
+    void Clear();
+    // Copy or drop up to in_uFrames rendered frames, return how many
+    AkUInt32 Read(AkReal32* out_pBuf, AkUInt32 in_uFrames);
+    AkUInt32 Skip(AkUInt32 in_uFrames);
+
+private:
+    LookaheadSlot* m_pSlot; // nullptr when rendering inline
+    AkUInt32 m_uSampleRate;
+};
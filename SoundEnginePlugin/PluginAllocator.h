@@ -0,0 +1,37 @@
+#pragma once
+
+#include "FootstepsLibrary.h"
+#include <AK/SoundEngine/Common/IAkPlugin.h>
+
+// nemlib allocator backed by the sound engine's plug-in allocator, so the model's buffers show up in
+// the Wwise memory profiler. Without a plug-in allocator it uses the global heap, for offline tools.
+class PluginAllocator : public nemlib::Allocator
+{
+public:
+    explicit PluginAllocator(AK::IAkPluginMemAlloc* in_pAllocator = nullptr)
+        : m_pAllocator(in_pAllocator)
+    {
+    }
+
+    void* Allocate(size_t in_uBytes) override
+    {
+        if (m_pAllocator == nullptr)
+            return nemlib::Allocator::Default().Allocate(in_uBytes);
+        return AK_PLUGIN_ALLOC(m_pAllocator, in_uBytes);
+    }
+
+    void Free(void* in_pMemory) override
+    {
+        if (m_pAllocator == nullptr)
+            nemlib::Allocator::Default().Free(in_pMemory);
+        else
+            AK_PLUGIN_FREE(m_pAllocator, in_pMemory);
+    }
+
+    AK::IAkPluginMemAlloc* GetPluginAllocator() const { return m_pAllocator; }
+    // Only while nothing allocated through the previous allocator is left
+    void SetPluginAllocator(AK::IAkPluginMemAlloc* in_pAllocator) { m_pAllocator = in_pAllocator; }
+
+private:
+    AK::IAkPluginMemAlloc* m_pAllocator;
+};
@@ -0,0 +1,128 @@
+#include "SharedBank.h"
+
+#include <thread>
+
+namespace
+{
+    // Newest bank first. Banks are pushed with a compare and swap and never unlinked while voices may use them
+    std::atomic<SharedBank*> s_pBanks(nullptr);
+    // Set when a bank is pushed, so the worker only walks the list when there is something to build
+    std::atomic<bool> s_bBuildPending(false);
+    std::atomic<bool> s_bBuilderRunning(false);
+    // Threads walking the list in BuildRequested(), Clear() waits for them before freeing the banks
+    std::atomic<AkUInt32> s_uBuilders(0);
+}
+
+SharedBank::SharedBank(AK::IAkPluginMemAlloc* in_pAllocator, SharedBankKind in_eKind, AkUInt32 in_uSampleRate, AkUInt32 in_uVariant)
+    : m_Allocator(in_pAllocator)
+    , m_uSampleRate(in_uSampleRate)
+    , m_uVariant(in_uVariant)
+    , m_eKind(in_eKind)
+    , m_uState(BANK_REQUESTED)
+    , m_pNext(nullptr)
+{
+}
+
+SharedBank::~SharedBank()
+{
+}
+
+void SharedBank::BuildRequested()
+{
+    if (!s_bBuildPending.exchange(false, std::memory_order_acquire))
+        return;
+
+    // Sequentially consistent with Clear(), which either sees this walk or empties the list before it starts
+    s_uBuilders.fetch_add(1);
+    for (SharedBank* pBank = s_pBanks.load(); pBank != nullptr; pBank = pBank->m_pNext)
+        TryBuild(pBank);
+    s_uBuilders.fetch_sub(1);
+}
+
+void SharedBank::SetBuilderRunning(bool in_bRunning)
+{
+    s_bBuilderRunning.store(in_bRunning, std::memory_order_release);
+    // Whatever was requested before the worker started is built by its first loop
+    if (in_bRunning)
+        s_bBuildPending.store(true, std::memory_order_release);
+}
+
+void SharedBank::Clear()
+{
+    SharedBank* pBank = s_pBanks.exchange(nullptr);
+    // The worker may still be building a bank if it is stopped by a later Term callback
+    while (s_uBuilders.load() > 0)
+        std::this_thread::yield();
+
+    while (pBank != nullptr)
+    {
+        SharedBank* pNext = pBank->m_pNext;
+        Destroy(pBank);
+        pBank = pNext;
+    }
+    s_bBuildPending.store(false, std::memory_order_relaxed);
+}
+
+SharedBank* SharedBank::Find(SharedBankKind in_eKind, AkUInt32 in_uSampleRate, AkUInt32 in_uVariant)
+{
+    for (SharedBank* pBank = s_pBanks.load(std::memory_order_acquire); pBank != nullptr; pBank = pBank->m_pNext)
+    {
+        if (pBank->m_eKind == in_eKind && pBank->m_uSampleRate == in_uSampleRate && pBank->m_uVariant == in_uVariant)
+            return pBank;
+    }
+    return nullptr;
+}
+
+SharedBank* SharedBank::Add(SharedBank* in_pBank)
+{
+    if (in_pBank == nullptr)
+        return nullptr;
+
+    SharedBank* pHead = s_pBanks.load(std::memory_order_acquire);
+    do
+    {
+        // Another voice may have requested the same bank since the caller looked
+        SharedBank* pExisting = Find(in_pBank->m_eKind, in_pBank->m_uSampleRate, in_pBank->m_uVariant);
+        if (pExisting != nullptr)
+        {
+            Destroy(in_pBank);
+            return pExisting;
+        }
+        in_pBank->m_pNext = pHead;
+    } while (!s_pBanks.compare_exchange_weak(pHead, in_pBank, std::memory_order_acq_rel, std::memory_order_acquire));
+
+    s_bBuildPending.store(true, std::memory_order_release);
+    return in_pBank;
+}
+
+void SharedBank::Destroy(SharedBank* in_pBank)
+{
+    // The bank's buffers go back to m_Allocator while it is destructed
+    PluginAllocator Allocator = in_pBank->m_Allocator;
+    in_pBank->~SharedBank();
+    Allocator.Free(in_pBank);
+}
+
+SharedBank* SharedBank::Settle(SharedBank* in_pBank)
+{
+    if (in_pBank == nullptr || s_bBuilderRunning.load(std::memory_order_acquire))
+        return in_pBank;
+
+    if (!TryBuild(in_pBank))
+    {
+        while (in_pBank->m_uState.load(std::memory_order_acquire) == BANK_BUILDING)
+            std::this_thread::yield();
+    }
+    return in_pBank;
+}
+
+bool SharedBank::TryBuild(SharedBank* in_pBank)
+{
+    AkUInt32 uState = BANK_REQUESTED;
+    if (!in_pBank->m_uState.compare_exchange_strong(uState, BANK_BUILDING, std::memory_order_acquire, std::memory_order_relaxed))
+        return false;
+
+    const bool bBuilt = in_pBank->Build();
+    in_pBank->m_uState.store(bBuilt ? BANK_READY : BANK_FAILED, std::memory_order_release);
+    return true;
+}
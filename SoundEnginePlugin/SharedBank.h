@@ -0,0 +1,85 @@
+#pragma once
+
+#include "PluginAllocator.h"
+#include <AK/SoundEngine/Common/AkCommonDefs.h>
+#include <atomic>
+#include <new>
+#include <utility>
+
+// Kinds of process-wide banks, part of the key banks are looked up by
+enum SharedBankKind : AkUInt32
+{
+    SHARED_BANK_CRUNCH_GRAINS,
+    SHARED_BANK_SURFACE_IMPULSES
+};
+
+// Process-wide table shared by every voice, such as the crunch grains or the impulse responses of a surface.
+// Banks are keyed by kind, sample rate and variant and kept in a list that only grows, so the banks handed out
+// stay where they are. Voices request a bank without locking or waiting, which is safe on the audio thread, and
+// keep rendering without it until it is ready. Requested banks are built by the lookahead worker. Without the
+// worker, as in the offline tools, they are built by the thread that requests them before it gets them back.
+// A bank and everything it holds come from the plug-in allocator of the voice that requested it, and every bank
+// is freed when the sound engine terminates.
+class SharedBank
+{
+public:
+    // Builds every requested bank. Off the audio thread, from the lookahead worker's loop
+    static void BuildRequested();
+    // From the lookahead worker's start and stop
+    static void SetBuilderRunning(bool in_bRunning);
+    // Frees every bank, from the sound engine's Term callback once no voice is left
+    static void Clear();
+
+    // False while the bank is being built, and for good if it ran out of memory
+    bool IsReady() const { return m_uState.load(std::memory_order_acquire) == BANK_READY; }
+
+protected:
+    SharedBank(AK::IAkPluginMemAlloc* in_pAllocator, SharedBankKind in_eKind, AkUInt32 in_uSampleRate, AkUInt32 in_uVariant);
+    virtual ~SharedBank();
+
+    // Renders the bank's content into memory from m_Allocator, false if out of memory
+    virtual bool Build() = 0;
+
+    // Returns the bank with that key, requesting a BankType made from the key and in_Args if there is none yet.
+    // nullptr if out of memory. The bank derived from SharedBank befriends it to be made here
+    template <typename BankType, typename... ArgTypes>
+    static const BankType* Request(AK::IAkPluginMemAlloc* in_pAllocator, SharedBankKind in_eKind, AkUInt32 in_uSampleRate, AkUInt32 in_uVariant, ArgTypes&&... in_Args)
+    {
+        SharedBank* pBank = Find(in_eKind, in_uSampleRate, in_uVariant);
+        if (pBank == nullptr)
+        {
+            void* pMemory = PluginAllocator(in_pAllocator).Allocate(sizeof(BankType));
+            if (pMemory != nullptr)
+                pBank = Add(new (pMemory) BankType(in_pAllocator, in_uSampleRate, in_uVariant, std::forward<ArgTypes>(in_Args)...));
+        }
+        return static_cast<const BankType*>(Settle(pBank));
+    }
+
+    PluginAllocator m_Allocator;
+    const AkUInt32 m_uSampleRate;
+    const AkUInt32 m_uVariant;
+
+private:
+    enum BankState : AkUInt32
+    {
+        BANK_REQUESTED,
+        BANK_BUILDING,
+        BANK_READY,
+        BANK_FAILED
+    };
+
+    // The bank with that key if it was already requested, nullptr otherwise. Never locks
+    static SharedBank* Find(SharedBankKind in_eKind, AkUInt32 in_uSampleRate, AkUInt32 in_uVariant);
+    // Pushes in_pBank on the list, or destroys it and returns the bank added with the same key in the meantime
+    static SharedBank* Add(SharedBank* in_pBank);
+    // Destructs in_pBank and gives its memory back to the allocator it came from
+    static void Destroy(SharedBank* in_pBank);
+    // Without the worker, builds in_pBank or waits for the thread building it. Returns in_pBank
+    static SharedBank* Settle(SharedBank* in_pBank);
+    // Builds in_pBank if nobody else started, true if it did
+    static bool TryBuild(SharedBank* in_pBank);
+
+    const SharedBankKind m_eKind;
+    std::atomic<AkUInt32> m_uState;
+    SharedBank* m_pNext;
+};
@@ -0,0 +1,172 @@
+/*
+* NEMISINDO LIBRARY - SIGNAL GRAPHS
+*
+* Compile-time composition of nemlib classes into a single per-sample function. A graph is built from nodes
+* that all take one sample in and give one sample out:
+* Input() : the sample going in
+* Constant(v), Parameter(v) : a fixed value, or a float read on every sample
+* Generate(g) : g.NextSample(), ignores its input
+* Play(p) : p.ProcessSample() of players without an input, such as GrainPlayer
+* Envelope(e) : e.GetNextEnvelopePoint()
+* Process(p) : p.ProcessSample(in)
+* Store(v) : writes the sample to v and passes it on
+* Limit(lo, hi) : clamps the sample
+* and combined with
+* a >> b : b(a(in)), in series
+* a + b : a(in) + b(in), both fed the same sample
+* a * b : a(in) * b(in), which with Input() modulates a signal by an envelope
+* Nodes only hold references to the objects they run, so the state stays where it was and a graph costs
+* nothing to build. Each node is evaluated once per sample, left to right, and with the runtime functions
+* of FootstepsLibrary.h inline the compiler turns RenderGraph() into one loop without calls.
+*/
+
+#pragma once
+#include "FootstepsLibrary.h"
+
+namespace nemlib
+{
+    // Base of every graph node, the operators below only apply to types derived from it
+    struct GraphNode {};
+
+    template <typename T>
+    using EnableIfNode = typename std::enable_if<std::is_base_of<GraphNode, T>::value, int>::type;
+
+    /*### LEAVES ###*/
+
+    struct InputNode : GraphNode {
+        float Tick(float InSample) { return InSample; }
+    };
+
+    struct ConstantNode : GraphNode {
+        float Value;
+        float Tick(float) { return Value; }
+    };
+
+    struct ParameterNode : GraphNode {
+        const float* Value;
+        float Tick(float) { return *Value; }
+    };
+
+    template <typename GeneratorType>
+    struct GenerateNode : GraphNode {
+        GeneratorType* Generator;
+        float Tick(float) { return Generator->NextSample(); }
+    };
+
+    template <typename PlayerType>
+    struct PlayNode : GraphNode {
+        PlayerType* Player;
+        float Tick(float) { return Player->ProcessSample(); }
+    };
+
+    template <typename EnvelopeType>
+    struct EnvelopeNode : GraphNode {
+        EnvelopeType* Env;
+        float Tick(float) { return Env->GetNextEnvelopePoint(); }
+    };
+
+    template <typename ProcessorType>
+    struct ProcessNode : GraphNode {
+        ProcessorType* Processor;
+        float Tick(float InSample) { return Processor->ProcessSample(InSample); }
+    };
+
+    struct StoreNode : GraphNode {
+        float* Value;
+        float Tick(float InSample) {
+            *Value = InSample;
+            return InSample;
+        }
+    };
+
+    struct LimitNode : GraphNode {
+        float Min;
+        float Max;
+        float Tick(float InSample) { return std::min(std::max(InSample, Min), Max); }
+    };
+
+    inline InputNode Input() { return {}; }
+    inline ConstantNode Constant(float InValue) { return { {}, InValue }; }
+    inline ParameterNode Parameter(const float& InValue) { return { {}, &InValue }; }
+    template <typename GeneratorType>
+    GenerateNode<GeneratorType> Generate(GeneratorType& InGenerator) { return { {}, &InGenerator }; }
+    template <typename PlayerType>
+    PlayNode<PlayerType> Play(PlayerType& InPlayer) { return { {}, &InPlayer }; }
+    template <typename EnvelopeType>
+    EnvelopeNode<EnvelopeType> Envelope(EnvelopeType& InEnvelope) { return { {}, &InEnvelope }; }
+    template <typename ProcessorType>
+    ProcessNode<ProcessorType> Process(ProcessorType& InProcessor) { return { {}, &InProcessor }; }
+    inline StoreNode Store(float& OutValue) { return { {}, &OutValue }; }
+    // Same result as Clamp()
+    inline LimitNode Limit(float InMin, float InMax) { return { {}, InMin, InMax }; }
+
+    /*### COMBINATIONS ###*/
+
+    template <typename FirstType, typename SecondType>
+    struct SeriesNode : GraphNode {
+        FirstType First;
+        SecondType Second;
+        float Tick(float InSample) { return Second.Tick(First.Tick(InSample)); }
+    };
+
+    // Both sides are evaluated in order, so the graph runs its stateful nodes the same way on every compiler
+    template <typename FirstType, typename SecondType>
+    struct SumNode : GraphNode {
+        FirstType First;
+        SecondType Second;
+        float Tick(float InSample) {
+            float A = First.Tick(InSample);
+            float B = Second.Tick(InSample);
+            return A + B;
+        }
+    };
+
+    template <typename FirstType, typename SecondType>
+    struct ProductNode : GraphNode {
+        FirstType First;
+        SecondType Second;
+        float Tick(float InSample) {
+            float A = First.Tick(InSample);
+            float B = Second.Tick(InSample);
+            return A * B;
+        }
+    };
+
+    template <typename A, typename B, EnableIfNode<A> = 0, EnableIfNode<B> = 0>
+    SeriesNode<A, B> operator>>(const A& InFirst, const B& InSecond) { return { {}, InFirst, InSecond }; }
+
+    template <typename A, typename B, EnableIfNode<A> = 0, EnableIfNode<B> = 0>
+    SumNode<A, B> operator+(const A& InFirst, const B& InSecond) { return { {}, InFirst, InSecond }; }
+
+    template <typename A, typename B, EnableIfNode<A> = 0, EnableIfNode<B> = 0>
+    ProductNode<A, B> operator*(const A& InFirst, const B& InSecond) { return { {}, InFirst, InSecond }; }
+
+    template <typename A, EnableIfNode<A> = 0>
+    ProductNode<ConstantNode, A> operator*(float InGain, const A& InNode) { return { {}, Constant(InGain), InNode }; }
+
+    template <typename A, EnableIfNode<A> = 0>
+    ProductNode<A, ConstantNode> operator*(const A& InNode, float InGain) { return { {}, InNode, Constant(InGain) }; }
+
+    /*### RENDERING ###*/
+
+    // Renders InNumSamples samples of InGraph, fed with silence
+    template <typename GraphType>
+    void RenderGraph(GraphType& InGraph, float* OutBuffer, int InNumSamples) {
+        for (int i = 0; i < InNumSamples; i++) {
+            OutBuffer[i] = InGraph.Tick(0.0f);
+        }
+    }
+
+    /* Same, calling InControl() before every sample for the events the graph does not model, such as timers.
+    Stops before the first sample InControl() returns false for and returns the number of samples rendered */
+    template <typename GraphType, typename ControlType>
+    int RenderGraph(GraphType& InGraph, float* OutBuffer, int InNumSamples, ControlType&& InControl) {
+        for (int i = 0; i < InNumSamples; i++) {
+            if (!InControl()) {
+                return i;
+            }
+            OutBuffer[i] = InGraph.Tick(0.0f);
+        }
+        return InNumSamples;
+    }
+}
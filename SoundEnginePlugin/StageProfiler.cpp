@@ -0,0 +1,112 @@
+#include "StageProfiler.h"
+
+#if FOOTSTEPS_PROFILE_STAGES
+
+#include <chrono>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace
+{
+    const char* const STAGE_NAMES[NUM_PROFILE_STAGES] = {
+        "Scheduling", "Noise", "FilterBank", "Crunch", "Envelopes", "SeparationDelay", "Convolver", "OutputFilters"
+    };
+}
+
+AkUInt64 ReadProfileTimestamp()
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    AkUInt64 uTicks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(uTicks));
+    return uTicks;
+#else
+    return (AkUInt64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void StageProfiler::SetHistoryCapacity(AkUInt32 in_uBuffers)
+{
+    m_uCapacity = in_uBuffers;
+    m_Records.clear();
+    m_Records.reserve(in_uBuffers);
+    m_uDropped = 0;
+}
+
+void StageProfiler::EndBuffer(AkUInt32 in_uFrames)
+{
+    for (int i = 0; i < NUM_PROFILE_STAGES; i++)
+        m_uTotal[i] += m_uCurrent[i];
+    m_uTotalFrames += in_uFrames;
+
+    // Never grows on the render path, buffers past the capacity are only counted
+    if (m_Records.size() >= m_uCapacity)
+    {
+        if (m_uCapacity > 0)
+            m_uDropped++;
+        return;
+    }
+
+    StageProfileRecord Record;
+    Record.uBeginTimestamp = m_uBegin;
+    Record.uEndTimestamp = m_uLast;
+    for (int i = 0; i < NUM_PROFILE_STAGES; i++)
+        Record.uStageCycles[i] = m_uCurrent[i];
+    Record.uFrames = in_uFrames;
+    m_Records.push_back(Record);
+}
+
+const char* StageProfiler::GetStageName(ProfileStage in_eStage)
+{
+    return STAGE_NAMES[in_eStage];
+}
+
+void StageProfiler::WriteCsv(FILE* in_pFile, const StageProfiler& in_Profiler, int in_iTrack, bool in_bHeader)
+{
+    if (in_bHeader)
+        fprintf(in_pFile, "track,buffer,frames,stage,cycles,cycles_per_frame\n");
+
+    const std::vector<StageProfileRecord>& Records = in_Profiler.GetRecords();
+    for (size_t uBuffer = 0; uBuffer < Records.size(); uBuffer++)
+    {
+        const StageProfileRecord& Record = Records[uBuffer];
+        for (int i = 0; i < NUM_PROFILE_STAGES; i++)
+        {
+            fprintf(in_pFile, "%d,%zu,%u,%s,%llu,%.2f\n", in_iTrack, uBuffer, Record.uFrames, STAGE_NAMES[i],
+                (unsigned long long)Record.uStageCycles[i], Record.uFrames > 0 ? (double)Record.uStageCycles[i] / Record.uFrames : 0.0);
+        }
+    }
+}
+
+void StageProfiler::WriteChromeTrace(FILE* in_pFile, const StageProfiler* const* in_pProfilers, int in_iNumProfilers,
+    double in_fTicksPerMicrosecond, AkUInt64 in_uOrigin)
+{
+    // Stages are interleaved sample by sample, so each buffer is one span and the stage split is a stacked counter
+    fprintf(in_pFile, "{\"traceEvents\":[\n");
+    const char* szSeparator = "";
+    for (int iTrack = 0; iTrack < in_iNumProfilers; iTrack++)
+    {
+        for (const StageProfileRecord& Record : in_pProfilers[iTrack]->GetRecords())
+        {
+            const double fBegin = (double)(Record.uBeginTimestamp - in_uOrigin) / in_fTicksPerMicrosecond;
+            const double fDuration = (double)(Record.uEndTimestamp - Record.uBeginTimestamp) / in_fTicksPerMicrosecond;
+            fprintf(in_pFile, "%s{\"name\":\"ExcuteModel\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frames\":%u}}",
+                szSeparator, iTrack, fBegin, fDuration, Record.uFrames);
+            szSeparator = ",\n";
+            fprintf(in_pFile, "%s{\"name\":\"Stage cycles %d\",\"ph\":\"C\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"args\":{", szSeparator, iTrack, iTrack, fBegin);
+            for (int i = 0; i < NUM_PROFILE_STAGES; i++)
+            {
+                fprintf(in_pFile, "%s\"%s\":%llu", i > 0 ? "," : "", STAGE_NAMES[i], (unsigned long long)Record.uStageCycles[i]);
+            }
+            fprintf(in_pFile, "}}");
+        }
+    }
+    fprintf(in_pFile, "\n],\"displayTimeUnit\":\"ns\"}\n");
+}
+
+#endif // FOOTSTEPS_PROFILE_STAGES
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkCommonDefs.h>
+#include <cstdio>
+#include <vector>
+
+// Per-stage cycle attribution of the Generator render loop. Off by default, define
+// FOOTSTEPS_PROFILE_STAGES=1 for the whole build to turn it on. When off the Generator has no
+// profiler member and the laps expand to nothing, so the instrumentation costs nothing.
+// Every lap reads the timestamp counter once per sample, so each stage carries a roughly constant
+// overhead of a few tens of cycles. Compare stages and builds with each other, not with an uninstrumented build.
+#ifndef FOOTSTEPS_PROFILE_STAGES
+#define FOOTSTEPS_PROFILE_STAGES 0
+#endif
+
+#if FOOTSTEPS_PROFILE_STAGES
+#define FOOTSTEPS_PROFILE_LAP(Profiler, Stage) (Profiler).Lap(Stage)
+#else
+#define FOOTSTEPS_PROFILE_LAP(Profiler, Stage) ((void)0)
+#endif
+
+// Stages of the per-sample render, in the order they run
+enum ProfileStage : int {
+    PROFILE_STAGE_SCHEDULING = 0, // step and crunch timers, step triggers and buffer setup
+    PROFILE_STAGE_NOISE,
+    PROFILE_STAGE_FILTERBANK,
+    PROFILE_STAGE_CRUNCH,
+    PROFILE_STAGE_ENVELOPES, // includes the walkers' step scheduling in crowd mode
+    PROFILE_STAGE_SEPARATION, // ball high pass and separation delay
+    PROFILE_STAGE_CONVOLVER,
+    PROFILE_STAGE_OUTPUT, // output HP/LP and clamp
+    NUM_PROFILE_STAGES
+};
+
+#if FOOTSTEPS_PROFILE_STAGES
+
+// Timestamp counter, TSC cycles on x86
+AkUInt64 ReadProfileTimestamp();
+
+// Cycles spent in each stage during one rendered buffer
+struct StageProfileRecord
+{
+    AkUInt64 uBeginTimestamp;
+    AkUInt64 uEndTimestamp;
+    AkUInt64 uStageCycles[NUM_PROFILE_STAGES];
+    AkUInt32 uFrames;
+};
+
+class StageProfiler
+{
+public:
+    // Keeps the records of the next in_uBuffers buffers for export, totals are always kept
+    void SetHistoryCapacity(AkUInt32 in_uBuffers);
+
+    void BeginBuffer()
+    {
+        m_uBegin = m_uLast = ReadProfileTimestamp();
+        for (int i = 0; i < NUM_PROFILE_STAGES; i++)
+            m_uCurrent[i] = 0;
+    }
+
+    // Charges the cycles since the previous lap to in_eStage
+    void Lap(ProfileStage in_eStage)
+    {
+        AkUInt64 uNow = ReadProfileTimestamp();
+        m_uCurrent[in_eStage] += uNow - m_uLast;
+        m_uLast = uNow;
+    }
+
+    void EndBuffer(AkUInt32 in_uFrames);
+
+    const std::vector<StageProfileRecord>& GetRecords() const { return m_Records; }
+    AkUInt64 GetTotalCycles(ProfileStage in_eStage) const { return m_uTotal[in_eStage]; }
+    AkUInt64 GetTotalFrames() const { return m_uTotalFrames; }
+    AkUInt32 GetDroppedBuffers() const { return m_uDropped; }
+
+    static const char* GetStageName(ProfileStage in_eStage);
+
+    // One row per buffer and stage. Writes the header when in_bHeader is set, in_iTrack tells profilers apart
+    static void WriteCsv(FILE* in_pFile, const StageProfiler& in_Profiler, int in_iTrack, bool in_bHeader);
+    // Chrome trace event format, one thread per profiler. in_fTicksPerMicrosecond converts timestamps,
+    // in_uOrigin is subtracted from them
+    static void WriteChromeTrace(FILE* in_pFile, const StageProfiler* const* in_pProfilers, int in_iNumProfilers,
+        double in_fTicksPerMicrosecond, AkUInt64 in_uOrigin);
+
+private:
+    AkUInt64 m_uBegin = 0;
+    AkUInt64 m_uLast = 0;
+    AkUInt64 m_uCurrent[NUM_PROFILE_STAGES] = {};
+    AkUInt64 m_uTotal[NUM_PROFILE_STAGES] = {};
+    AkUInt64 m_uTotalFrames = 0;
+    AkUInt32 m_uCapacity = 0;
+    AkUInt32 m_uDropped = 0;
+    std::vector<StageProfileRecord> m_Records;
+};
+
+#endif // FOOTSTEPS_PROFILE_STAGES
@@ -0,0 +1,99 @@
+#include "SurfaceImpulses.h"
+
+
+namespace
+{
+    // Fraction of the energy left in the tail where an impulse response is cut, -60 dB
+    const float IMPULSE_TAIL_ENERGY = 1.0e-6f;
+
+    // Fade applied when a response is cut at MAX_IMPULSE_TIME before it has decayed, in seconds
+    const float IMPULSE_FADE_TIME = 0.02f;
+
+    // Fixed so every voice and every run gets the same responses
+    const unsigned int IMPULSE_SEED = 0x6d6f6465;
+
+    int GetMaxLength(AkUInt32 in_uSampleRate)
+    {
+        return (int)(MAX_IMPULSE_TIME * (float)in_uSampleRate);
+    }
+}
+
+const SurfaceImpulseBank* SurfaceImpulseBank::Request(AK::IAkPluginMemAlloc* in_pAllocator, AkUInt32 in_uSampleRate, int in_iSurfaceType, const nemlib::Mode& in_Mode)
+{
+    return SharedBank::Request<SurfaceImpulseBank>(in_pAllocator, SHARED_BANK_SURFACE_IMPULSES, in_uSampleRate, (AkUInt32)in_iSurfaceType, in_Mode);
+}
+
+SurfaceImpulseBank::SurfaceImpulseBank(AK::IAkPluginMemAlloc* in_pAllocator, AkUInt32 in_uSampleRate, AkUInt32 in_uSurfaceType, const nemlib::Mode& in_Mode)
+    : SharedBank(in_pAllocator, SHARED_BANK_SURFACE_IMPULSES, in_uSampleRate, in_uSurfaceType)
+    , m_Mode(in_Mode)
+{
+}
+
+int SurfaceImpulseBank::GetMaxPartitions(AkUInt32 in_uSampleRate)
+{
+    return (GetMaxLength(in_uSampleRate) + IMPULSE_BLOCK_SIZE - 1) / IMPULSE_BLOCK_SIZE;
+}
+
+const nemlib::PartitionedImpulse& SurfaceImpulseBank::GetVariation(int in_iIndex) const
+{
+    return m_Variations[std::min(std::max(in_iIndex, 0), IMPULSE_VARIATIONS - 1)];
+}
+
+int SurfaceImpulseBank::GetLength() const
+{
+    return m_iLength;
+}
+
+bool SurfaceImpulseBank::Build()
+{
+    const int SampleRate = (int)m_uSampleRate;
+    const int MaxLength = GetMaxLength(m_uSampleRate);
+    const int NumModes = std::min(m_Mode.nModes, nemlib::MAX_FILTERBANK_FILTERS);
+    nemlib::Buffer<float> Response;
+    if (!Response.Allocate(MaxLength, m_Allocator))
+        return false;
+
+    nemlib::Random Rng(IMPULSE_SEED + (unsigned int)m_uVariant);
+    for (int v = 0; v < IMPULSE_VARIATIONS; ++v)
+    {
+        // Same variation as FilterBank::VaryParameters
+        nemlib::BiquadFilter Filters[nemlib::MAX_FILTERBANK_FILTERS];
+        float Gains[nemlib::MAX_FILTERBANK_FILTERS];
+        for (int i = 0; i < NumModes; ++i)
+        {
+            Filters[i] = nemlib::BiquadFilter(SampleRate, nemlib::Vary(m_Mode.Freqs[i], 0.2f, Rng), nemlib::Vary(m_Mode.Qs[i], 0.3f, Rng), 0.0f, m_Mode.Types[i]);
+            Gains[i] = nemlib::Vary(m_Mode.Gains[i], 0.3f, Rng);
+        }
+
+        double Energy = 0.0;
+        for (int n = 0; n < MaxLength; ++n)
+        {
+            float Input = n == 0 ? 1.0f : 0.0f;
+            float Output = 0.0f;
+            for (int i = 0; i < NumModes; ++i)
+                Output += Gains[i] * Filters[i].ProcessSample(Input);
+            Response[n] = Output;
+            Energy += (double)Output * Output;
+        }
+
+        // Cut once the tail is 60 dB down, or fade out if the modes ring longer than MAX_IMPULSE_TIME
+        int Length = MaxLength;
+        double TailEnergy = 0.0;
+        while (Length > 1 && TailEnergy + (double)Response[Length - 1] * Response[Length - 1] < Energy * IMPULSE_TAIL_ENERGY)
+        {
+            TailEnergy += (double)Response[Length - 1] * Response[Length - 1];
+            --Length;
+        }
+        if (Length == MaxLength)
+        {
+            int FadeLength = std::min((int)(IMPULSE_FADE_TIME * SampleRate), Length);
+            for (int n = 0; n < FadeLength; ++n)
+                Response[Length - 1 - n] *= (float)n / (float)FadeLength;
+        }
+
+        if (!m_Variations[v].SetImpulse(Response.Data(), Length, IMPULSE_BLOCK_SIZE, m_Allocator))
+            return false;
+        m_iLength = std::max(m_iLength, Length);
+    }
+    return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "FootstepsLibrary.h"
+#include "SharedBank.h"
+#include <AK/SoundEngine/Common/AkCommonDefs.h>
+
+// Randomized impulse responses rendered per surface, one of them is picked for every step
+const int IMPULSE_VARIATIONS = 4;
+
+// Partition size of the surface convolution, which is also its latency in samples
+const int IMPULSE_BLOCK_SIZE = 256;
+
+// Longest impulse response kept in seconds, shorter when the modes decay by 60 dB sooner
+const float MAX_IMPULSE_TIME = 0.4f;
+
+// Process-wide impulse responses of the resonant surfaces, one bank per surface and sample rate.
+// Each variation is the response of the surface's filter bank to a unit impulse, with the modes
+// varied the same way the Generator varies them on every step, so a voice in convolution mode only
+// has to convolve the short enveloped excitation. Banks are requested by the first voice prepared for
+// convolution at a rate and rendered by the lookahead worker, the voice steps through its filter bank until then.
+class SurfaceImpulseBank : public SharedBank
+{
+    friend class SharedBank;
+
+public:
+    // Returns the bank of in_iSurfaceType at in_uSampleRate, requesting it from in_Mode and in_pAllocator on first
+    // use. nullptr if out of memory. Never locks
+    static const SurfaceImpulseBank* Request(AK::IAkPluginMemAlloc* in_pAllocator, AkUInt32 in_uSampleRate, int in_iSurfaceType, const nemlib::Mode& in_Mode);
+    // Partitions a convolver needs to play any bank at in_uSampleRate
+    static int GetMaxPartitions(AkUInt32 in_uSampleRate);
+
+    const nemlib::PartitionedImpulse& GetVariation(int in_iIndex) const;
+    // Length of the longest variation in samples
+    int GetLength() const;
+
+private:
+    SurfaceImpulseBank(AK::IAkPluginMemAlloc* in_pAllocator, AkUInt32 in_uSampleRate, AkUInt32 in_uSurfaceType, const nemlib::Mode& in_Mode);
+
+    bool Build() override;
+
+    nemlib::Mode m_Mode;
+    int m_iLength = 0;
+    nemlib::PartitionedImpulse m_Variations[IMPULSE_VARIATIONS];
+};
@@ -0,0 +1,300 @@
+#include "TraceRing.h"
+#include <chrono>
+#include <map>
+
+#if FOOTSTEPS_TRACE_EVENTS
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+#endif
+
+namespace
+{
+    const char TRACE_LOG_MAGIC[4] = { 'F', 'S', 'T', 'R' };
+    const AkUInt32 TRACE_LOG_VERSION = 1;
+
+    struct TraceLogHeader
+    {
+        char Magic[4];
+        AkUInt32 uVersion;
+        AkUInt32 uRecordSize;
+    };
+
+    const char* const EVENT_NAMES[NUM_TRACE_EVENTS] = {
+        "Reset", "BufferBegin", "BufferEnd", "Step", "Ball", "CachedStep", "CrunchGrain", "Surface", "Shoe", "Params", "Dropped"
+    };
+
+    // Sample rate of voices the log has no reset for
+    const double DEFAULT_TRACE_RATE = 48000.0;
+}
+
+#if FOOTSTEPS_TRACE_EVENTS
+
+namespace
+{
+    AkUInt64 ReadTraceClock()
+    {
+        return (AkUInt64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::atomic<AkUInt32> s_uNextVoice{ 1 };
+    // Every buffer ever created, pushed at the head by the rings and walked by the writer
+    std::atomic<TraceRingBuffer*> s_pBuffers{ nullptr };
+    std::atomic<bool> s_bStarted{ false };
+
+    // The log and its thread, the lock is never taken by the rings
+    struct TraceLogState
+    {
+        std::mutex Lock;
+        FILE* pFile = nullptr;
+
+        std::thread Thread;
+        std::mutex WakeLock;
+        std::condition_variable Wake;
+        bool bStop = false;
+    };
+
+    TraceLogState s_State;
+}
+
+TraceRing::TraceRing()
+    : m_pBuffer(TraceLogWriter::AcquireBuffer())
+    , m_uVoice(s_uNextVoice.fetch_add(1, std::memory_order_relaxed))
+{
+    if (m_pBuffer != nullptr)
+        m_pBuffer->uVoice.store(m_uVoice, std::memory_order_relaxed);
+}
+
+TraceRing::~TraceRing()
+{
+    // What the voice wrote last is still logged by the next drain
+    if (m_pBuffer != nullptr)
+        m_pBuffer->bRetired.store(true, std::memory_order_release);
+}
+
+void TraceRing::BeginBuffer()
+{
+    m_uFrame = m_uBufferStart;
+    Write(TRACE_EVENT_BUFFER_BEGIN, ReadTraceClock());
+}
+
+void TraceRing::EndBuffer(AkUInt32 in_uFrames)
+{
+    m_uBufferStart += in_uFrames;
+    m_uFrame = m_uBufferStart;
+    Write(TRACE_EVENT_BUFFER_END, ReadTraceClock());
+}
+
+TraceRingBuffer* TraceLogWriter::AcquireBuffer()
+{
+    // A retired buffer first, the list only grows to the most rings alive at once
+    for (TraceRingBuffer* pBuffer = s_pBuffers.load(std::memory_order_acquire); pBuffer != nullptr; pBuffer = pBuffer->pNext)
+    {
+        bool bRetired = true;
+        if (pBuffer->bRetired.load(std::memory_order_relaxed)
+            && pBuffer->bRetired.compare_exchange_strong(bRetired, false, std::memory_order_acquire, std::memory_order_relaxed))
+            return pBuffer;
+    }
+
+    TraceRingBuffer* pBuffer = new (std::nothrow) TraceRingBuffer();
+    if (pBuffer == nullptr)
+        return nullptr;
+    pBuffer->pNext = s_pBuffers.load(std::memory_order_relaxed);
+    while (!s_pBuffers.compare_exchange_weak(pBuffer->pNext, pBuffer, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+    return pBuffer;
+}
+
+AkUInt32 TraceLogWriter::DrainBuffer(TraceRingBuffer* in_pBuffer, FILE* in_pFile)
+{
+    const AkUInt32 CHUNK_EVENTS = 256;
+    TraceEvent Events[CHUNK_EVENTS];
+    AkUInt32 uWritten = 0;
+    AkUInt64 uLastFrame = 0;
+    for (;;)
+    {
+        const AkUInt32 uRead = in_pBuffer->uRead.load(std::memory_order_relaxed);
+        const AkUInt32 uWrite = in_pBuffer->uWrite.load(std::memory_order_acquire);
+        const AkUInt32 uCount = uWrite - uRead < CHUNK_EVENTS ? uWrite - uRead : CHUNK_EVENTS;
+        if (uCount == 0)
+            break;
+        for (AkUInt32 i = 0; i < uCount; i++)
+            Events[i] = in_pBuffer->Events[(uRead + i) & (TraceRingBuffer::CAPACITY - 1)];
+        // Hands the slots back to the producer
+        in_pBuffer->uRead.store(uRead + uCount, std::memory_order_release);
+
+        fwrite(Events, sizeof(TraceEvent), uCount, in_pFile);
+        uWritten += uCount;
+        uLastFrame = Events[uCount - 1].uFrame;
+    }
+
+    const AkUInt32 uDropped = in_pBuffer->uDropped.load(std::memory_order_relaxed);
+    if (uDropped != in_pBuffer->uReportedDropped)
+    {
+        TraceEvent Dropped;
+        Dropped.uFrame = uLastFrame;
+        Dropped.uValue = uDropped - in_pBuffer->uReportedDropped;
+        Dropped.uType = TRACE_EVENT_DROPPED;
+        Dropped.uVoice = in_pBuffer->uVoice.load(std::memory_order_relaxed);
+        fwrite(&Dropped, sizeof(TraceEvent), 1, in_pFile);
+        uWritten++;
+        in_pBuffer->uReportedDropped = uDropped;
+    }
+    return uWritten;
+}
+
+AkUInt32 TraceLogWriter::DrainAll(FILE* in_pFile)
+{
+    AkUInt32 uWritten = 0;
+    for (TraceRingBuffer* pBuffer = s_pBuffers.load(std::memory_order_acquire); pBuffer != nullptr; pBuffer = pBuffer->pNext)
+        uWritten += DrainBuffer(pBuffer, in_pFile);
+    if (uWritten > 0)
+        fflush(in_pFile);
+    return uWritten;
+}
+
+bool TraceLogWriter::Start(const char* in_szPath, AkUInt32 in_uIntervalMs)
+{
+    std::lock_guard<std::mutex> Guard(s_State.Lock);
+    if (s_State.pFile != nullptr)
+        return true;
+
+    s_State.pFile = fopen(in_szPath, "wb");
+    if (s_State.pFile == nullptr)
+        return false;
+
+    TraceLogHeader Header;
+    for (int i = 0; i < 4; i++)
+        Header.Magic[i] = TRACE_LOG_MAGIC[i];
+    Header.uVersion = TRACE_LOG_VERSION;
+    Header.uRecordSize = sizeof(TraceEvent);
+    fwrite(&Header, sizeof(Header), 1, s_State.pFile);
+
+    // Events from before the start are not part of the log
+    for (TraceRingBuffer* pBuffer = s_pBuffers.load(std::memory_order_acquire); pBuffer != nullptr; pBuffer = pBuffer->pNext)
+    {
+        pBuffer->uRead.store(pBuffer->uWrite.load(std::memory_order_acquire), std::memory_order_release);
+        pBuffer->uReportedDropped = pBuffer->uDropped.load(std::memory_order_relaxed);
+    }
+
+    s_State.bStop = false;
+    s_State.Thread = std::thread([in_uIntervalMs]()
+    {
+        std::unique_lock<std::mutex> WakeGuard(s_State.WakeLock);
+        while (!s_State.bStop)
+        {
+            s_State.Wake.wait_for(WakeGuard, std::chrono::milliseconds(in_uIntervalMs));
+            std::lock_guard<std::mutex> Guard(s_State.Lock);
+            DrainAll(s_State.pFile);
+        }
+    });
+    s_bStarted.store(true, std::memory_order_release);
+    return true;
+}
+
+void TraceLogWriter::Stop()
+{
+    if (!s_State.Thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> WakeGuard(s_State.WakeLock);
+        s_State.bStop = true;
+    }
+    s_State.Wake.notify_one();
+    s_State.Thread.join();
+
+    std::lock_guard<std::mutex> Guard(s_State.Lock);
+    DrainAll(s_State.pFile);
+    fclose(s_State.pFile);
+    s_State.pFile = nullptr;
+    s_bStarted.store(false, std::memory_order_release);
+}
+
+bool TraceLogWriter::IsStarted()
+{
+    return s_bStarted.load(std::memory_order_acquire);
+}
+
+#endif // FOOTSTEPS_TRACE_EVENTS
+
+bool ConvertTraceLog(FILE* in_pLog, FILE* out_pTrace)
+{
+    TraceLogHeader Header;
+    if (fread(&Header, sizeof(Header), 1, in_pLog) != 1)
+        return false;
+    for (int i = 0; i < 4; i++)
+    {
+        if (Header.Magic[i] != TRACE_LOG_MAGIC[i])
+            return false;
+    }
+    if (Header.uVersion != TRACE_LOG_VERSION || Header.uRecordSize != sizeof(TraceEvent))
+        return false;
+
+    struct VoiceTrack
+    {
+        double fRate = DEFAULT_TRACE_RATE;
+        bool bInBuffer = false;
+        AkUInt64 uBeginFrame = 0;
+        AkUInt64 uBeginTime = 0;
+    };
+    std::map<AkUInt32, VoiceTrack> Voices;
+
+    // Timestamps are in microseconds of output, so the trace lines up with what was heard
+    fprintf(out_pTrace, "{\"traceEvents\":[\n");
+    bool bFirst = true;
+    TraceEvent Event;
+    while (fread(&Event, sizeof(Event), 1, in_pLog) == 1)
+    {
+        if (Event.uType >= NUM_TRACE_EVENTS)
+            continue;
+
+        std::map<AkUInt32, VoiceTrack>::iterator It = Voices.find(Event.uVoice);
+        if (It == Voices.end())
+        {
+            It = Voices.insert(std::make_pair(Event.uVoice, VoiceTrack())).first;
+            fprintf(out_pTrace, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"Voice %u\"}}",
+                bFirst ? "" : ",\n", Event.uVoice, Event.uVoice);
+            bFirst = false;
+        }
+        VoiceTrack& Voice = It->second;
+        const double fMicroseconds = (double)Event.uFrame * 1.0e6 / Voice.fRate;
+
+        switch (Event.uType)
+        {
+        case TRACE_EVENT_RESET:
+            Voice.fRate = Event.uValue > 0 ? (double)Event.uValue : DEFAULT_TRACE_RATE;
+            Voice.bInBuffer = false;
+            break;
+        case TRACE_EVENT_BUFFER_BEGIN:
+            Voice.bInBuffer = true;
+            Voice.uBeginFrame = Event.uFrame;
+            Voice.uBeginTime = Event.uValue;
+            continue;
+        case TRACE_EVENT_BUFFER_END:
+            if (Voice.bInBuffer)
+            {
+                // One span per buffer, with how long it took to render against how long it plays
+                const double fBegin = (double)Voice.uBeginFrame * 1.0e6 / Voice.fRate;
+                const double fRenderMicroseconds = (double)(Event.uValue - Voice.uBeginTime) / 1000.0;
+                fprintf(out_pTrace, ",\n{\"name\":\"Buffer\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+                    "\"args\":{\"frames\":%llu,\"render_us\":%.3f,\"load\":%.4f}}",
+                    Event.uVoice, fBegin, fMicroseconds - fBegin, (unsigned long long)(Event.uFrame - Voice.uBeginFrame),
+                    fRenderMicroseconds, fMicroseconds > fBegin ? fRenderMicroseconds / (fMicroseconds - fBegin) : 0.0);
+                Voice.bInBuffer = false;
+            }
+            continue;
+        default:
+            break;
+        }
+
+        fprintf(out_pTrace, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,"
+            "\"args\":{\"frame\":%llu,\"value\":%llu}}",
+            EVENT_NAMES[Event.uType], Event.uVoice, fMicroseconds, (unsigned long long)Event.uFrame,
+            (unsigned long long)Event.uValue);
+    }
+    fprintf(out_pTrace, "\n]}\n");
+    return true;
+}
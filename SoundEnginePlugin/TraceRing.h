@@ -0,0 +1,139 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkCommonDefs.h>
+#include <atomic>
+#include <cstdio>
+
+// Sample-accurate trace of what the Generators do on the audio thread: buffer boundaries, step onsets, crunch
+// grains, surface and shoe switches and parameter changes. Off by default, define FOOTSTEPS_TRACE_EVENTS=1 for
+// the whole build to turn it on. When off the Generator has no ring and the trace points expand to nothing.
+// Every voice writes into its own single-producer single-consumer ring without locking. A thread off the audio
+// thread drains all of them into a binary log (TraceLogWriter), which ConvertTraceLog() turns into a Chrome trace.
+#ifndef FOOTSTEPS_TRACE_EVENTS
+#define FOOTSTEPS_TRACE_EVENTS 0
+#endif
+
+#if FOOTSTEPS_TRACE_EVENTS
+#define FOOTSTEPS_TRACE(Ring, Type, Value) (Ring).Write(Type, Value)
+#define FOOTSTEPS_TRACE_FRAME(Ring, Frame) (Ring).SetFrame(Frame)
+#define FOOTSTEPS_TRACE_NEXT_FRAME(Ring) (Ring).NextFrame()
+#else
+#define FOOTSTEPS_TRACE(Ring, Type, Value) ((void)0)
+#define FOOTSTEPS_TRACE_FRAME(Ring, Frame) ((void)0)
+#define FOOTSTEPS_TRACE_NEXT_FRAME(Ring) ((void)0)
+#endif
+
+enum TraceEventType : AkUInt32 {
+    TRACE_EVENT_RESET = 0, // voice prepared or reset, value is the output sample rate
+    TRACE_EVENT_BUFFER_BEGIN, // value is the steady clock in nanoseconds
+    TRACE_EVENT_BUFFER_END, // same, at the frame after the buffer
+    TRACE_EVENT_STEP, // step onset, value is the walker counted from 1, 0 outside crowd mode
+    TRACE_EVENT_BALL, // ball onset of a crowd walker, value is the walker counted from 1
+    TRACE_EVENT_CACHED_STEP, // step replayed from the step cache
+    TRACE_EVENT_CRUNCH_GRAIN, // value is the grain's surface
+    TRACE_EVENT_SURFACE, // value is the new surface
+    TRACE_EVENT_SHOE, // value is the new shoe
+    TRACE_EVENT_PARAMS, // parameters applied before the buffer, value is the mask of the changed PARAM_*_IDs
+    TRACE_EVENT_DROPPED, // written by the drain, value is the events a full ring dropped since the last drain
+    NUM_TRACE_EVENTS
+};
+
+struct TraceEvent
+{
+    AkUInt64 uFrame; // output frame of the voice, counted from its first buffer
+    AkUInt64 uValue;
+    AkUInt32 uType; // TraceEventType
+    AkUInt32 uVoice; // tells the rings apart in the log
+};
+
+#if FOOTSTEPS_TRACE_EVENTS
+
+// Single-producer single-consumer storage of a TraceRing, drained by TraceLogWriter. Buffers are never freed:
+// one retired by its voice is drained of what it still holds and handed to the next TraceRing created
+struct TraceRingBuffer
+{
+    // Power of two, a voice writes a few events per step so this holds seconds of them
+    static const AkUInt32 CAPACITY = 1024;
+
+    TraceEvent Events[CAPACITY];
+    std::atomic<AkUInt32> uWrite{ 0 };
+    std::atomic<AkUInt32> uRead{ 0 };
+    std::atomic<AkUInt32> uDropped{ 0 };
+    std::atomic<AkUInt32> uVoice{ 0 }; // of the ring writing to it
+    std::atomic<bool> bRetired{ false };
+    AkUInt32 uReportedDropped = 0; // consumer's copy
+    TraceRingBuffer* pNext = nullptr; // set before the buffer is published, then constant
+};
+
+class TraceRing
+{
+public:
+    // Claims a retired buffer or adds a new one to the drain's list, without locking
+    TraceRing();
+    // Retires the buffer, the writer thread logs what is left in it
+    ~TraceRing();
+    TraceRing(const TraceRing&) = delete;
+    TraceRing& operator=(const TraceRing&) = delete;
+
+    // Producer side, only called by the thread rendering the voice. The lookahead worker and the audio thread
+    // hand the Generator over to each other, so there is still a single writer at a time
+    void Write(TraceEventType in_eType, AkUInt64 in_uValue)
+    {
+        if (m_pBuffer == nullptr)
+            return;
+        TraceRingBuffer& Buffer = *m_pBuffer;
+        const AkUInt32 uWrite = Buffer.uWrite.load(std::memory_order_relaxed);
+        if (uWrite - Buffer.uRead.load(std::memory_order_acquire) >= TraceRingBuffer::CAPACITY)
+        {
+            // Only this thread writes the count, no read-modify-write needed
+            Buffer.uDropped.store(Buffer.uDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        TraceEvent& Event = Buffer.Events[uWrite & (TraceRingBuffer::CAPACITY - 1)];
+        Event.uFrame = m_uFrame;
+        Event.uValue = in_uValue;
+        Event.uType = in_eType;
+        Event.uVoice = m_uVoice;
+        Buffer.uWrite.store(uWrite + 1, std::memory_order_release);
+    }
+
+    // Events are stamped with the frame set last, in_uOffset frames into the current buffer
+    void SetFrame(AkUInt32 in_uOffset) { m_uFrame = m_uBufferStart + in_uOffset; }
+    void NextFrame() { m_uFrame++; }
+    void BeginBuffer();
+    void EndBuffer(AkUInt32 in_uFrames);
+    // Frames a virtual voice skipped, they have no buffer events
+    void Skip(AkUInt32 in_uFrames) { m_uBufferStart += in_uFrames; m_uFrame = m_uBufferStart; }
+
+private:
+    TraceRingBuffer* m_pBuffer; // nullptr if none could be allocated, the voice is not traced
+    AkUInt64 m_uBufferStart = 0;
+    AkUInt64 m_uFrame = 0;
+    AkUInt32 m_uVoice;
+};
+
+// Drains every ring into a binary log on its own thread: a header, then TraceEvents as they were written.
+// The thread is never stopped behind the owner's back, Stop() must be called before the module unloads
+class TraceLogWriter
+{
+public:
+    // Starts draining to in_szPath every in_uIntervalMs milliseconds, false if the file cannot be opened.
+    // Does nothing if already started
+    static bool Start(const char* in_szPath, AkUInt32 in_uIntervalMs = 10);
+    // Drains one last time and closes the log
+    static void Stop();
+    static bool IsStarted();
+
+private:
+    friend class TraceRing;
+    // Both run on the writer thread or with it stopped, return the number of events written
+    static AkUInt32 DrainBuffer(TraceRingBuffer* in_pBuffer, FILE* in_pFile);
+    static AkUInt32 DrainAll(FILE* in_pFile);
+    static TraceRingBuffer* AcquireBuffer();
+};
+
+#endif // FOOTSTEPS_TRACE_EVENTS
+
+// Converts a binary log of TraceLogWriter to the Chrome trace event format, one thread per voice on a timeline
+// of output samples. False if in_pLog is not a trace log
+bool ConvertTraceLog(FILE* in_pLog, FILE* out_pTrace);
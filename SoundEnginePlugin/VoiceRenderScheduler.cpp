@@ -0,0 +1,72 @@
+#include "VoiceRenderScheduler.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    const AkUInt32 CACHE_LINE_FLOATS = CACHE_LINE_SIZE / sizeof(AkReal32);
+}
+
+VoiceRenderScheduler::VoiceRenderScheduler(AkUInt32 in_uNumThreads, AkUInt16 in_uMaxFrames)
+    : m_Pool(in_uNumThreads)
+    , m_uStride((in_uMaxFrames + CACHE_LINE_FLOATS - 1) / CACHE_LINE_FLOATS * CACHE_LINE_FLOATS)
+    , m_uMaxFrames(in_uMaxFrames)
+    , m_uRenderFrames(0)
+{
+    m_RenderJob = [this](AkUInt32 in_uVoice)
+    {
+        const VoiceSlot& Slot = m_Voices[in_uVoice];
+        Slot.pGenerator->ExcuteModel(m_Outputs.data() + Slot.uOutputOffset, m_uRenderFrames);
+    };
+}
+
+VoiceRenderScheduler::~VoiceRenderScheduler()
+{
+}
+
+AkUInt32 VoiceRenderScheduler::AddVoice(Generator* in_pGenerator)
+{
+    VoiceSlot Slot = { in_pGenerator, 0 };
+    m_Voices.push_back(Slot);
+    LayoutOutputs();
+    return (AkUInt32)m_Voices.size() - 1;
+}
+
+void VoiceRenderScheduler::RemoveVoice(Generator* in_pGenerator)
+{
+    // Erase rather than swap so the mixing order of the remaining voices is kept
+    m_Voices.erase(std::remove_if(m_Voices.begin(), m_Voices.end(),
+        [in_pGenerator](const VoiceSlot& Slot) { return Slot.pGenerator == in_pGenerator; }), m_Voices.end());
+    LayoutOutputs();
+}
+
+void VoiceRenderScheduler::Render(AkReal32* out_pMix, AkUInt16 in_uFrames)
+{
+    m_uRenderFrames = std::min(in_uFrames, m_uMaxFrames);
+    m_Pool.Run((AkUInt32)m_Voices.size(), m_RenderJob);
+
+    memset(out_pMix, 0, m_uRenderFrames * sizeof(AkReal32));
+    for (AkUInt32 v = 0; v < (AkUInt32)m_Voices.size(); ++v)
+    {
+        const AkReal32* pVoice = m_Outputs.data() + m_Voices[v].uOutputOffset;
+        for (AkUInt16 i = 0; i < m_uRenderFrames; ++i)
+        {
+            out_pMix[i] += pVoice[i];
+        }
+    }
+}
+
+const AkReal32* VoiceRenderScheduler::GetVoiceOutput(AkUInt32 in_uVoice) const
+{
+    return m_Outputs.data() + m_Voices[in_uVoice].uOutputOffset;
+}
+
+void VoiceRenderScheduler::LayoutOutputs()
+{
+    m_Outputs.assign(m_Voices.size() * m_uStride, 0.0f);
+    for (AkUInt32 v = 0; v < (AkUInt32)m_Voices.size(); ++v)
+    {
+        m_Voices[v].uOutputOffset = v * m_uStride;
+    }
+}
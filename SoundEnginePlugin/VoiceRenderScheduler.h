@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Generator.h"
+#include "JobPool.h"
+
+// Renders many Generator voices in parallel for offline tools and engine integrations with spare cores.
+// Every voice renders into its own cache-line aligned buffer as a separate job, then the buffers are
+// summed in voice order on the calling thread, so the mix is bit-identical to serial rendering
+// whatever the thread count.
+class VoiceRenderScheduler
+{
+public:
+    VoiceRenderScheduler(AkUInt32 in_uNumThreads, AkUInt16 in_uMaxFrames);
+    ~VoiceRenderScheduler();
+
+    // Voices are mixed in the order they were added
+    AkUInt32 AddVoice(Generator* in_pGenerator);
+    void RemoveVoice(Generator* in_pGenerator);
+    AkUInt32 GetNumVoices() const { return (AkUInt32)m_Voices.size(); }
+    AkUInt32 GetNumThreads() const { return m_Pool.GetNumThreads(); }
+
+    // Renders in_uFrames (at most the max frames given on construction) of every voice and writes their sum
+    void Render(AkReal32* out_pMix, AkUInt16 in_uFrames);
+
+    // Output of a single voice from the last Render() call
+    const AkReal32* GetVoiceOutput(AkUInt32 in_uVoice) const;
+
+private:
+    // One cache line per voice, so workers never write to a line another worker reads
+    struct alignas(CACHE_LINE_SIZE) VoiceSlot
+    {
+        Generator* pGenerator;
+        AkUInt32 uOutputOffset;
+    };
+
+    void LayoutOutputs();
+
+    JobPool m_Pool;
+    std::vector<VoiceSlot, CacheLineAllocator<VoiceSlot>> m_Voices;
+    std::vector<AkReal32, CacheLineAllocator<AkReal32>> m_Outputs; // m_uStride floats per voice
+    AkUInt32 m_uStride;
+    AkUInt16 m_uMaxFrames;
+    AkUInt16 m_uRenderFrames;
+    std::function<void(AkUInt32)> m_RenderJob;
+};
@@ -0,0 +1,492 @@
+﻿// FootstepsBake
+// Renders variation banks of the footsteps model offline, for platforms that cannot afford to run it live.
+// Every shoe x surface x terrain x pace bucket combination gets N single steps rendered with the same
+// Generator the plug-in uses, trimmed to the audible part of the step and written as 16-bit WAV files,
+// with a manifest.csv listing what each file contains. Combinations are spread over all cores.
+//
+// Usage: FootstepsBake --out <dir> [--variations N] [--rate Hz] [--paces 70,100,140] [--firmness 0-1]
+//                      [--steadiness 0-1] [--seed N] [--threads N] [--convolution]
+//                      [--profile-csv <file>] [--profile-trace <file>] [--event-log <file>] [--event-trace <file>]
+// The profile options need a build with FOOTSTEPS_PROFILE_STAGES=1, they export the cycles spent in
+// each stage of the model for every rendered buffer, as CSV and as Chrome trace JSON.
+// The event options need a build with FOOTSTEPS_TRACE_EVENTS=1, they log the buffers, steps, grains and
+// parameter changes of every worker's Generator as the binary trace log, and as Chrome trace JSON.
+//
+// Build, from the repository root once the plug-in projects are generated (FootstepsConfig.h), with
+// WWISESDK pointing at the Wwise SDK. Only the model's sources are needed, not the plug-in's:
+//   g++ -std=c++17 -O2 -I"$WWISESDK/include" -I. Tools/FootstepsBake/FootstepsBake.cpp
+//       SoundEnginePlugin/{Generator,FootstepsLibrary,FootstepsKernels,CrunchGrains,SurfaceImpulses,SharedBank,CpuGovernor,StageProfiler,TraceRing}.cpp
+//       -o FootstepsBake -lpthread
+//   cl /std:c++17 /O2 /EHsc /I"%WWISESDK%\include" /I. Tools\FootstepsBake\FootstepsBake.cpp
+//       SoundEnginePlugin\Generator.cpp SoundEnginePlugin\FootstepsLibrary.cpp SoundEnginePlugin\FootstepsKernels.cpp
+//       SoundEnginePlugin\CrunchGrains.cpp SoundEnginePlugin\SurfaceImpulses.cpp SoundEnginePlugin\SharedBank.cpp
+//       SoundEnginePlugin\CpuGovernor.cpp SoundEnginePlugin\StageProfiler.cpp SoundEnginePlugin\TraceRing.cpp /Fe:FootstepsBake.exe
+// Add -DFOOTSTEPS_PROFILE_STAGES=1 or -DFOOTSTEPS_TRACE_EVENTS=1 (/D on MSVC) for the profile and event options.
+
+#include "../../SoundEnginePlugin/Generator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <pmmintrin.h>
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+    const char* const SHOE_NAMES[] = { "trainer", "highheel", "oxford", "workboot" };
+    const char* const SURFACE_NAMES[] = { "wood", "concrete", "dirt", "grass", "hollowwood", "metal" };
+    const char* const TERRAIN_NAMES[] = { "flat", "upstairs" };
+    const int NUM_SHOES = sizeof(SHOE_NAMES) / sizeof(SHOE_NAMES[0]);
+    const int NUM_SURFACES = sizeof(SURFACE_NAMES) / sizeof(SURFACE_NAMES[0]);
+    const int NUM_TERRAINS = sizeof(TERRAIN_NAMES) / sizeof(TERRAIN_NAMES[0]);
+
+    // ExcuteModel renders at most a Wwise buffer at a time
+    const int RENDER_BLOCK = 1024;
+    // Samples quieter than this relative to the step's peak are trimmed from both ends
+    const float TRIM_THRESHOLD_DB = -60.0f;
+#if FOOTSTEPS_PROFILE_STAGES
+    // Buffers each worker keeps for export
+    const AkUInt32 PROFILE_HISTORY = 1 << 16;
+#endif
+#if FOOTSTEPS_TRACE_EVENTS
+    // The bake runs hundreds of times faster than real time, drain the rings often to keep up
+    const AkUInt32 EVENT_DRAIN_INTERVAL_MS = 1;
+#endif
+
+    struct BakeOptions
+    {
+        std::string OutDir;
+        int Variations = 8;
+        AkUInt32 SampleRate = 48000;
+        std::vector<float> Paces = { 70.0f, 100.0f, 140.0f };
+        float Firmness = 0.3f;
+        float Steadiness = 0.1f;
+        AkUInt32 Seed = 1;
+        int Threads = 0; // 0 uses every core
+        bool Convolution = false;
+        std::string ProfileCsv;
+        std::string ProfileTrace;
+        std::string EventLog;
+        std::string EventTrace;
+    };
+
+    struct BakeJob
+    {
+        int Shoe;
+        int Surface;
+        int Terrain;
+        float Pace;
+        int Variation;
+        AkUInt32 Seed;
+    };
+
+    struct BakeResult
+    {
+        std::string File;
+        int Frames = 0;
+        float PeakDB = -144.0f;
+        bool Written = false;
+    };
+
+    void PrintUsage()
+    {
+        printf("Usage: FootstepsBake --out <dir> [--variations N] [--rate Hz] [--paces 70,100,140]\n"
+               "                     [--firmness 0-1] [--steadiness 0-1] [--seed N] [--threads N] [--convolution]\n"
+               "                     [--profile-csv <file>] [--profile-trace <file>] [--event-log <file>] [--event-trace <file>]\n");
+    }
+
+    bool ParseOptions(int argc, char** argv, BakeOptions& out_Options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const char* szArg = argv[i];
+            const char* szValue = i + 1 < argc ? argv[i + 1] : nullptr;
+            if (strcmp(szArg, "--convolution") == 0)
+            {
+                out_Options.Convolution = true;
+                continue;
+            }
+            if (szValue == nullptr)
+                return false;
+
+            if (strcmp(szArg, "--out") == 0)
+                out_Options.OutDir = szValue;
+            else if (strcmp(szArg, "--variations") == 0)
+                out_Options.Variations = std::max(atoi(szValue), 1);
+            else if (strcmp(szArg, "--rate") == 0)
+                out_Options.SampleRate = (AkUInt32)std::max(atoi(szValue), 8000);
+            else if (strcmp(szArg, "--firmness") == 0)
+                out_Options.Firmness = nemlib::Clamp((float)atof(szValue), 0.0f, 1.0f);
+            else if (strcmp(szArg, "--steadiness") == 0)
+                out_Options.Steadiness = nemlib::Clamp((float)atof(szValue), 0.0f, 1.0f);
+            else if (strcmp(szArg, "--seed") == 0)
+                out_Options.Seed = (AkUInt32)strtoul(szValue, nullptr, 10);
+            else if (strcmp(szArg, "--profile-csv") == 0)
+                out_Options.ProfileCsv = szValue;
+            else if (strcmp(szArg, "--profile-trace") == 0)
+                out_Options.ProfileTrace = szValue;
+            else if (strcmp(szArg, "--event-log") == 0)
+                out_Options.EventLog = szValue;
+            else if (strcmp(szArg, "--event-trace") == 0)
+                out_Options.EventTrace = szValue;
+            else if (strcmp(szArg, "--threads") == 0)
+                out_Options.Threads = std::max(atoi(szValue), 1);
+            else if (strcmp(szArg, "--paces") == 0)
+            {
+                out_Options.Paces.clear();
+                for (const char* p = szValue; *p != '\0';)
+                {
+                    out_Options.Paces.push_back(nemlib::Clamp((float)atof(p), 60.0f, 300.0f));
+                    const char* pComma = strchr(p, ',');
+                    if (pComma == nullptr)
+                        break;
+                    p = pComma + 1;
+                }
+                if (out_Options.Paces.empty())
+                    return false;
+            }
+            else
+                return false;
+            i++;
+        }
+#if !FOOTSTEPS_PROFILE_STAGES
+        if (!out_Options.ProfileCsv.empty() || !out_Options.ProfileTrace.empty())
+        {
+            fprintf(stderr, "Profiling needs a build with FOOTSTEPS_PROFILE_STAGES=1\n");
+            return false;
+        }
+#endif
+#if FOOTSTEPS_TRACE_EVENTS
+        // The trace is converted from the log, which goes next to it unless asked for
+        if (out_Options.EventLog.empty() && !out_Options.EventTrace.empty())
+            out_Options.EventLog = out_Options.EventTrace + ".log";
+#else
+        if (!out_Options.EventLog.empty() || !out_Options.EventTrace.empty())
+        {
+            fprintf(stderr, "Event tracing needs a build with FOOTSTEPS_TRACE_EVENTS=1\n");
+            return false;
+        }
+#endif
+        return !out_Options.OutDir.empty();
+    }
+
+    void WriteUInt32(FILE* pFile, AkUInt32 in_uValue)
+    {
+        const unsigned char Bytes[4] = { (unsigned char)in_uValue, (unsigned char)(in_uValue >> 8), (unsigned char)(in_uValue >> 16), (unsigned char)(in_uValue >> 24) };
+        fwrite(Bytes, 1, 4, pFile);
+    }
+
+    void WriteUInt16(FILE* pFile, AkUInt16 in_uValue)
+    {
+        const unsigned char Bytes[2] = { (unsigned char)in_uValue, (unsigned char)(in_uValue >> 8) };
+        fwrite(Bytes, 1, 2, pFile);
+    }
+
+    // Mono 16-bit PCM, little endian whatever the host
+    bool WriteWav(const std::string& in_Path, const float* in_pSamples, int in_iFrames, AkUInt32 in_uSampleRate)
+    {
+        FILE* pFile = fopen(in_Path.c_str(), "wb");
+        if (pFile == nullptr)
+            return false;
+
+        const AkUInt32 uDataSize = (AkUInt32)in_iFrames * 2;
+        fwrite("RIFF", 1, 4, pFile);
+        WriteUInt32(pFile, 36 + uDataSize);
+        fwrite("WAVEfmt ", 1, 8, pFile);
+        WriteUInt32(pFile, 16);
+        WriteUInt16(pFile, 1); // PCM
+        WriteUInt16(pFile, 1); // mono
+        WriteUInt32(pFile, in_uSampleRate);
+        WriteUInt32(pFile, in_uSampleRate * 2);
+        WriteUInt16(pFile, 2);
+        WriteUInt16(pFile, 16);
+        fwrite("data", 1, 4, pFile);
+        WriteUInt32(pFile, uDataSize);
+        for (int i = 0; i < in_iFrames; i++)
+        {
+            const float fSample = nemlib::Clamp(in_pSamples[i], -1.0f, 1.0f);
+            WriteUInt16(pFile, (AkUInt16)(AkInt16)lrintf(fSample * 32767.0f));
+        }
+
+        const bool bOk = ferror(pFile) == 0;
+        fclose(pFile);
+        return bOk;
+    }
+
+    void EnableFlushToZero()
+    {
+        // The output filters decay into denormals between steps, which is several times slower without this.
+        // The sound engine's audio thread runs the model the same way.
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+        _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+        _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+#endif
+    }
+
+    // Renders one step the way a one-shot voice would and trims it to the audible range
+    BakeResult BakeVariation(Generator& io_Gen, const BakeOptions& in_Options, const BakeJob& in_Job, std::vector<float>& io_Buffer)
+    {
+        char szName[128];
+        snprintf(szName, sizeof(szName), "%s_%s_%s_p%d_%02d.wav", SHOE_NAMES[in_Job.Shoe], SURFACE_NAMES[in_Job.Surface],
+            TERRAIN_NAMES[in_Job.Terrain], (int)lrintf(in_Job.Pace), in_Job.Variation);
+        BakeResult Result;
+        Result.File = szName;
+
+        io_Gen.SetSeed(in_Job.Seed);
+        if (!io_Gen.PrepareModel(in_Options.SampleRate))
+            return Result;
+        io_Gen.PrepareSubsystems({ in_Options.Convolution, false, true, in_Job.Terrain, 1, in_Job.Surface, 0, DEFAULT_IDLE_RELEASE_TIME });
+        io_Gen.SetAutomeated(false);
+        io_Gen.SetShoeType(in_Job.Shoe);
+        io_Gen.SetSurfaceType(in_Job.Surface);
+        io_Gen.SetTerrain(in_Job.Terrain);
+        io_Gen.SetPace(in_Job.Pace);
+        io_Gen.SetFirmness(in_Options.Firmness);
+        io_Gen.SetSteadiness(in_Options.Steadiness);
+        io_Gen.SetConvolution(in_Options.Convolution);
+
+        // The step length comes from its envelope boundaries plus the ring time of the filters
+        const int iFrames = (int)ceilf(io_Gen.TriggerOneShot() * (float)in_Options.SampleRate);
+        io_Buffer.resize(iFrames);
+        for (int iDone = 0; iDone < iFrames; iDone += RENDER_BLOCK)
+        {
+            io_Gen.ExcuteModel(&io_Buffer[iDone], (AkUInt16)std::min(RENDER_BLOCK, iFrames - iDone));
+        }
+
+        float fPeak = 0.0f;
+        for (float fSample : io_Buffer)
+        {
+            fPeak = std::max(fPeak, fabsf(fSample));
+        }
+        const float fThreshold = fPeak * powf(10.0f, TRIM_THRESHOLD_DB / 20.0f);
+        int iBegin = 0;
+        int iEnd = iFrames;
+        while (iBegin < iEnd && fabsf(io_Buffer[iBegin]) <= fThreshold)
+            iBegin++;
+        while (iEnd > iBegin && fabsf(io_Buffer[iEnd - 1]) <= fThreshold)
+            iEnd--;
+
+        Result.Frames = iEnd - iBegin;
+        Result.PeakDB = fPeak > 0.0f ? 20.0f * log10f(fPeak) : -144.0f;
+        const std::string Path = (std::filesystem::path(in_Options.OutDir) / szName).string();
+        Result.Written = WriteWav(Path, io_Buffer.data() + iBegin, Result.Frames, in_Options.SampleRate);
+        return Result;
+    }
+
+    bool WriteManifest(const BakeOptions& in_Options, const std::vector<BakeJob>& in_Jobs, const std::vector<BakeResult>& in_Results)
+    {
+        const std::string Path = (std::filesystem::path(in_Options.OutDir) / "manifest.csv").string();
+        FILE* pFile = fopen(Path.c_str(), "w");
+        if (pFile == nullptr)
+            return false;
+
+        fprintf(pFile, "file,shoe,surface,terrain,pace,firmness,steadiness,convolution,variation,seed,frames,sample_rate,peak_db\n");
+        for (size_t i = 0; i < in_Jobs.size(); i++)
+        {
+            const BakeJob& Job = in_Jobs[i];
+            const BakeResult& Result = in_Results[i];
+            fprintf(pFile, "%s,%s,%s,%s,%.1f,%.3f,%.3f,%d,%d,%u,%d,%u,%.2f\n", Result.File.c_str(), SHOE_NAMES[Job.Shoe],
+                SURFACE_NAMES[Job.Surface], TERRAIN_NAMES[Job.Terrain], Job.Pace, in_Options.Firmness, in_Options.Steadiness,
+                in_Options.Convolution ? 1 : 0, Job.Variation, Job.Seed, Result.Frames, in_Options.SampleRate, Result.PeakDB);
+        }
+
+        const bool bOk = ferror(pFile) == 0;
+        fclose(pFile);
+        return bOk;
+    }
+
+#if FOOTSTEPS_PROFILE_STAGES
+    bool WriteProfiles(const BakeOptions& in_Options, const std::vector<std::unique_ptr<Generator>>& in_Generators,
+        double in_fTicksPerMicrosecond, AkUInt64 in_uOrigin)
+    {
+        std::vector<const StageProfiler*> Profilers;
+        for (const std::unique_ptr<Generator>& pGen : in_Generators)
+        {
+            Profilers.push_back(&pGen->GetProfiler());
+        }
+
+        // Summary of the whole bake, per rendered frame
+        AkUInt64 uFrames = 0;
+        for (const StageProfiler* pProfiler : Profilers)
+            uFrames += pProfiler->GetTotalFrames();
+        for (int i = 0; i < NUM_PROFILE_STAGES; i++)
+        {
+            AkUInt64 uCycles = 0;
+            for (const StageProfiler* pProfiler : Profilers)
+                uCycles += pProfiler->GetTotalCycles((ProfileStage)i);
+            printf("  %-16s %8.1f cycles/frame\n", StageProfiler::GetStageName((ProfileStage)i), uFrames > 0 ? (double)uCycles / (double)uFrames : 0.0);
+        }
+
+        bool bOk = true;
+        if (!in_Options.ProfileCsv.empty())
+        {
+            FILE* pFile = fopen(in_Options.ProfileCsv.c_str(), "w");
+            if (pFile == nullptr)
+                return false;
+            for (size_t i = 0; i < Profilers.size(); i++)
+                StageProfiler::WriteCsv(pFile, *Profilers[i], (int)i, i == 0);
+            bOk = ferror(pFile) == 0 && bOk;
+            fclose(pFile);
+        }
+        if (!in_Options.ProfileTrace.empty())
+        {
+            FILE* pFile = fopen(in_Options.ProfileTrace.c_str(), "w");
+            if (pFile == nullptr)
+                return false;
+            StageProfiler::WriteChromeTrace(pFile, Profilers.data(), (int)Profilers.size(), in_fTicksPerMicrosecond, in_uOrigin);
+            bOk = ferror(pFile) == 0 && bOk;
+            fclose(pFile);
+        }
+        return bOk;
+    }
+#endif
+
+#if FOOTSTEPS_TRACE_EVENTS
+    bool WriteEventTrace(const BakeOptions& in_Options)
+    {
+        FILE* pLog = fopen(in_Options.EventLog.c_str(), "rb");
+        if (pLog == nullptr)
+            return false;
+        FILE* pTrace = fopen(in_Options.EventTrace.c_str(), "w");
+        if (pTrace == nullptr)
+        {
+            fclose(pLog);
+            return false;
+        }
+        bool bOk = ConvertTraceLog(pLog, pTrace);
+        bOk = ferror(pTrace) == 0 && bOk;
+        fclose(pTrace);
+        fclose(pLog);
+        return bOk;
+    }
+#endif
+}
+
+int main(int argc, char** argv)
+{
+    BakeOptions Options;
+    if (!ParseOptions(argc, argv, Options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    std::error_code Error;
+    std::filesystem::create_directories(Options.OutDir, Error);
+    if (Error)
+    {
+        fprintf(stderr, "Cannot create %s: %s\n", Options.OutDir.c_str(), Error.message().c_str());
+        return 1;
+    }
+
+    // Seeds only depend on the job's position, so a bake is reproducible whatever the thread count
+    std::vector<BakeJob> Jobs;
+    for (int Shoe = 0; Shoe < NUM_SHOES; Shoe++)
+        for (int Surface = 0; Surface < NUM_SURFACES; Surface++)
+            for (int Terrain = 0; Terrain < NUM_TERRAINS; Terrain++)
+                for (float Pace : Options.Paces)
+                    for (int Variation = 0; Variation < Options.Variations; Variation++)
+                    {
+                        const AkUInt32 uSeed = Options.Seed * 2654435761u + (AkUInt32)Jobs.size();
+                        Jobs.push_back({ Shoe, Surface, Terrain, Pace, Variation, uSeed });
+                    }
+
+    // One generator per worker, kept until the end so their profiles can be exported
+    const int iThreads = Options.Threads > 0 ? Options.Threads : (int)std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<std::unique_ptr<Generator>> Generators;
+    for (int i = 0; i < iThreads; i++)
+    {
+        Generators.emplace_back(new Generator());
+#if FOOTSTEPS_PROFILE_STAGES
+        Generators.back()->GetProfiler().SetHistoryCapacity(PROFILE_HISTORY);
+#endif
+    }
+
+    std::vector<BakeResult> Results(Jobs.size());
+    std::atomic<size_t> NextJob(0);
+    auto Worker = [&](Generator* pGen)
+    {
+        EnableFlushToZero();
+        std::vector<float> Buffer;
+        for (size_t i = NextJob++; i < Jobs.size(); i = NextJob++)
+        {
+            Results[i] = BakeVariation(*pGen, Options, Jobs[i], Buffer);
+        }
+    };
+
+#if FOOTSTEPS_TRACE_EVENTS
+    if (!Options.EventLog.empty() && !TraceLogWriter::Start(Options.EventLog.c_str(), EVENT_DRAIN_INTERVAL_MS))
+    {
+        fprintf(stderr, "Cannot write %s\n", Options.EventLog.c_str());
+        return 1;
+    }
+#endif
+    const auto Start = std::chrono::steady_clock::now();
+#if FOOTSTEPS_PROFILE_STAGES
+    const AkUInt64 uStartTicks = ReadProfileTimestamp();
+#endif
+    std::vector<std::thread> Threads;
+    for (int i = 1; i < iThreads; i++)
+    {
+        Threads.emplace_back(Worker, Generators[i].get());
+    }
+    Worker(Generators[0].get());
+    for (std::thread& Thread : Threads)
+    {
+        Thread.join();
+    }
+    const double fSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+#if FOOTSTEPS_TRACE_EVENTS
+    TraceLogWriter::Stop();
+#endif
+#if FOOTSTEPS_PROFILE_STAGES
+    const double fTicksPerMicrosecond = (double)(ReadProfileTimestamp() - uStartTicks) / std::max(fSeconds * 1e6, 1.0);
+#endif
+
+    double fAudioSeconds = 0.0;
+    int iFailed = 0;
+    for (const BakeResult& Result : Results)
+    {
+        fAudioSeconds += (double)Result.Frames / (double)Options.SampleRate;
+        if (!Result.Written)
+        {
+            fprintf(stderr, "Failed to write %s\n", Result.File.c_str());
+            iFailed++;
+        }
+    }
+    if (!WriteManifest(Options, Jobs, Results))
+    {
+        fprintf(stderr, "Failed to write the manifest\n");
+        return 1;
+    }
+
+    printf("Baked %zu steps (%.1f s of audio) in %.2f s on %d threads, %.0fx real time\n", Jobs.size(), fAudioSeconds,
+        fSeconds, iThreads, fSeconds > 0.0 ? fAudioSeconds / fSeconds : 0.0);
+#if FOOTSTEPS_PROFILE_STAGES
+    if (!WriteProfiles(Options, Generators, fTicksPerMicrosecond, uStartTicks))
+    {
+        fprintf(stderr, "Failed to write the profiles\n");
+        return 1;
+    }
+#endif
+#if FOOTSTEPS_TRACE_EVENTS
+    if (!Options.EventTrace.empty() && !WriteEventTrace(Options))
+    {
+        fprintf(stderr, "Failed to write the event trace\n");
+        return 1;
+    }
+#endif
+    return iFailed == 0 ? 0 : 1;
+}
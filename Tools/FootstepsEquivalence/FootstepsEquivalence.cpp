@@ -0,0 +1,1326 @@
+// FootstepsEquivalence
+// Checks that optimized versions of the nemlib kernels still render what the reference scalar code renders.
+// The reference kernels below are frozen copies of BiquadFilter, FilterBank, CurveEnvelope and WhiteNoiseGen as
+// they were before any SIMD, fast-math or multi-rate work. They must not be changed along with nemlib, they are
+// what the live classes are measured against. Both run side by side on identical seeded input, and every
+// component reports its max abs error, SNR and spectral deviation against per-component thresholds.
+//
+// The full Generator render cannot be frozen the same way, so it is compared against renders written by a
+// reference build: run --write-golden <dir> on the build before the change, then --golden <dir> on the build
+// with it. Every scenario is seeded, so a build that did not change the model matches bit for bit.
+// The random streams the models draw from are checked for bias on a fixed seed: mean, variance, serial
+// correlation and a chi-square over equal buckets, against the uniform distribution they should follow. The
+// same statistics are run on a deliberately biased stream, the check fails if they don't catch it.
+// VoiceRenderScheduler's mix of many voices rendered on every core is checked bit for bit against the same voices
+// rendered and summed on one thread.
+// FootstepsSourceParams is checked for torn parameter batches, with a writer thread staging batches while the
+// main thread takes snapshots like the audio thread does.
+// The kernels with per instruction set variants (see FootstepsKernels.h) and the golden renders are checked with
+// every variant this CPU supports, the golden renders are written with the one selected at load.
+//
+// Usage: FootstepsEquivalence [--golden <dir> | --write-golden <dir>] [--rate Hz] [--seconds S] [--seed N] [--tiers]
+//                             [--bench]
+// --tiers also reports the Generator quality tiers and rate divisors against the full quality render. Those are
+// lossy by design and never fail the run, the numbers are there to judge what a tier costs in quality.
+// --bench times the kernels and the Generator with each variant, as the best of a few runs. It also renders the
+// Generator in buffers of 32 to 1024 frames, the cost per frame of small buffers over that of 1024-frame ones is
+// the per-buffer overhead low-latency outputs pay. Last comes the size of the Generator and of its parts, and the
+// cache misses per buffer of one voice and of BENCH_VOICES voices rendered in turn, where the hardware counters
+// can be read (Linux perf events), and how VoiceRenderScheduler scales from 1 thread to every core.
+// Exits with 1 when a component is over its thresholds, 2 on bad arguments or missing golden renders.
+
+#include "../../SoundEnginePlugin/FootstepsSourceParams.h"
+#include "../../SoundEnginePlugin/Generator.h"
+#include "../../SoundEnginePlugin/VoiceRenderScheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <pmmintrin.h>
+#include <xmmintrin.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Welch spectra for the spectral deviation, Hann windows overlapping by half
+    const int SPECTRUM_SIZE = 1024;
+    // Bins this far below the reference's loudest bin are left out of the spectral deviation,
+    // their level is dominated by rounding noise
+    const double SPECTRUM_FLOOR_DB = -80.0;
+    // Input segments, coefficients and modes change at every segment boundary
+    const int SEGMENT_FRAMES = 4096;
+    // ExcuteModel renders at most a Wwise buffer at a time
+    const int RENDER_BLOCK = 1024;
+    // Timed runs of each benchmark, the fastest is kept as the others are more likely to have been interrupted
+    const int BENCH_RUNS = 5;
+    // Values drawn from each random stream and the buckets of its chi-square
+    const int RANDOM_VALUES = 1 << 20;
+    const int RANDOM_BUCKETS = 64;
+    // Largest deviation of the mean and of the variance, in standard errors of the uniform distribution
+    const double RANDOM_MAX_Z = 5.0;
+    // Chi-square with 63 degrees of freedom only goes over this once in some 100000 unbiased streams
+    const double RANDOM_MAX_CHI_SQUARE = 125.0;
+    // Batches the writer thread stages during the parameter batch check
+    const int PARAM_BATCHES = 200000;
+    // Buffer sizes of the per-buffer overhead curve, the last one is the reference
+    const int BENCH_BUFFER_FRAMES[] = { 32, 64, 128, 256, 512, 1024 };
+    const int NUM_BENCH_BUFFER_SIZES = sizeof(BENCH_BUFFER_FRAMES) / sizeof(BENCH_BUFFER_FRAMES[0]);
+    // Voices of the cache miss benchmark, enough for their state to outgrow L2, and the frames of their buffers
+    const int BENCH_VOICES = 256;
+    const int BENCH_VOICE_BUFFER_FRAMES = 256;
+    const int CACHE_LINE_BYTES = 64;
+    // Voices mixed by the scheduler check and its scaling benchmark, which renders a quarter of the frames
+    const int SCHEDULER_VOICES = 16;
+    const int SCALING_VOICES = 64;
+
+    struct Thresholds
+    {
+        double MaxAbsError;
+        double MinSnrDB;
+        double MaxSpectralDeviationDB;
+    };
+
+    // A replacement kernel has to stay within these of the reference to be merged. They leave room for
+    // reassociated float arithmetic, which costs the recursive filters some 20 dB of SNR at low frequencies,
+    // but not for a wrong coefficient or a sample out of place
+    const Thresholds NOISE_THRESHOLDS = { 1e-6, 120.0, 0.01 };
+    const Thresholds BIQUAD_THRESHOLDS = { 2e-3, 70.0, 0.1 };
+    const Thresholds FILTERBANK_THRESHOLDS = { 1e-3, 75.0, 0.1 };
+    const Thresholds ENVELOPE_THRESHOLDS = { 1e-5, 100.0, 0.1 };
+    const Thresholds GENERATOR_THRESHOLDS = { 1e-3, 60.0, 0.5 };
+    // The scheduler promises the serial mix bit for bit
+    const Thresholds MIX_THRESHOLDS = { 0.0, INFINITY, 0.0 };
+
+    struct EquivalenceOptions
+    {
+        std::string GoldenDir;
+        bool WriteGolden = false;
+        AkUInt32 SampleRate = 48000;
+        float Seconds = 4.0f;
+        AkUInt32 Seed = 1;
+        bool Tiers = false;
+        bool Bench = false;
+    };
+
+    struct Metrics
+    {
+        double MaxAbsError = 0.0;
+        double SnrDB = INFINITY;
+        double SpectralDeviationDB = 0.0;
+    };
+
+    // Seeded Generator configurations rendered for the full model comparison
+    struct RenderScenario
+    {
+        const char* Name;
+        int Shoe;
+        int Surface;
+        int Terrain;
+        float Pace;
+        int CrowdSize;
+        bool Convolution;
+    };
+
+    const RenderScenario RENDER_SCENARIOS[] = {
+        { "wood_trainer", 0, 0, 0, 100.0f, 1, false },
+        { "concrete_highheel", 1, 1, 0, 120.0f, 1, false },
+        { "dirt_oxford", 2, 2, 0, 90.0f, 1, false },
+        { "grass_workboot", 3, 3, 0, 140.0f, 1, false },
+        { "hollowwood_trainer_upstairs", 0, 4, 1, 80.0f, 1, false },
+        { "metal_oxford", 2, 5, 0, 110.0f, 1, false },
+        { "concrete_crowd", 3, 1, 0, 100.0f, 6, false },
+        { "wood_convolution", 0, 0, 0, 100.0f, 1, true },
+    };
+    const int NUM_RENDER_SCENARIOS = sizeof(RENDER_SCENARIOS) / sizeof(RENDER_SCENARIOS[0]);
+
+    /*### REFERENCE KERNELS ###*/
+
+    // Frozen copy of WhiteNoiseGen: sample n of a seed is the lowbias32 hash of n turned into [-1.0, 1.0)
+    float ReferenceNoiseSample(AkUInt32 in_uSeed, AkUInt32 in_uIndex)
+    {
+        AkUInt32 X = in_uSeed + 0x9E3779B9u * in_uIndex;
+        X ^= X >> 16;
+        X *= 0x7FEB352Du;
+        X ^= X >> 15;
+        X *= 0x846CA68Bu;
+        X ^= X >> 16;
+        const AkUInt32 uFloatBits = 0x40000000u | (X >> 9);
+        float fSample;
+        memcpy(&fSample, &uFloatBits, sizeof(fSample));
+        return fSample - 3.0f;
+    }
+
+    // Frozen copy of BiquadFilter, Q in dB for the low and high passes. Only the filter types the models use
+    class ReferenceBiquad
+    {
+    public:
+        void Set(int in_iSampleRate, float in_fFrequency, float in_fQ, int in_iType)
+        {
+            const float W = 2.0f * (float)nemlib::NEM_PI * std::min(std::max(in_fFrequency, 1.0f) / (float)in_iSampleRate, 0.499f);
+            const float Q = fabsf(in_fQ);
+            const float AQ = sinf(W) / (2.0f * std::max(Q, 0.001f));
+            const float AQdB = sinf(W) / (2.0f * powf(10.0f, Q / 20.0f));
+            const float Wc = cosf(W);
+            switch (in_iType)
+            {
+            case nemlib::bq_type_highpass:
+                m_B0 = (1.0f + Wc) / 2.0f; m_B1 = -1.0f - Wc; m_B2 = (1.0f + Wc) / 2.0f;
+                m_A0 = 1.0f + AQdB; m_A1 = -2.0f * Wc; m_A2 = 1.0f - AQdB;
+                break;
+            case nemlib::bq_type_bandpass:
+                m_B0 = AQ; m_B1 = 0.0f; m_B2 = -AQ;
+                m_A0 = 1.0f + AQ; m_A1 = -2.0f * Wc; m_A2 = 1.0f - AQ;
+                break;
+            default: // low pass
+                m_B0 = (1.0f - Wc) / 2.0f; m_B1 = 1.0f - Wc; m_B2 = (1.0f - Wc) / 2.0f;
+                m_A0 = 1.0f + AQdB; m_A1 = -2.0f * Wc; m_A2 = 1.0f - AQdB;
+                break;
+            }
+        }
+
+        void Reset() { m_X1 = m_X2 = m_Y1 = m_Y2 = 0.0f; }
+
+        float ProcessSample(float in_fSample)
+        {
+            const float fOut = ((in_fSample * m_B0) + (m_X1 * m_B1) + (m_X2 * m_B2) - (m_Y1 * m_A1) - (m_Y2 * m_A2)) / m_A0;
+            m_Y2 = m_Y1;
+            m_Y1 = fOut;
+            m_X2 = m_X1;
+            m_X1 = in_fSample;
+            return fOut;
+        }
+
+    private:
+        float m_B0 = 0.0f, m_B1 = 0.0f, m_B2 = 0.0f, m_A0 = 1.0f, m_A1 = 0.0f, m_A2 = 0.0f;
+        float m_X1 = 0.0f, m_X2 = 0.0f, m_Y1 = 0.0f, m_Y2 = 0.0f;
+    };
+
+    // Frozen copy of FilterBank: the modes' outputs summed with their gains, faded in over 10 ms after every new mode
+    class ReferenceFilterBank
+    {
+    public:
+        explicit ReferenceFilterBank(int in_iSampleRate) : m_iSampleRate(in_iSampleRate) {}
+
+        void Initialise(const nemlib::Mode& in_Mode)
+        {
+            m_iNumModes = std::min(in_Mode.nModes, nemlib::MAX_FILTERBANK_FILTERS);
+            for (int i = 0; i < m_iNumModes; i++)
+            {
+                m_Filters[i].Reset();
+                m_Filters[i].Set(m_iSampleRate, in_Mode.Freqs[i], in_Mode.Qs[i], in_Mode.Types[i]);
+                m_fGains[i] = in_Mode.Gains[i];
+            }
+            m_fOutputMult = 0.0f;
+        }
+
+        float ProcessSample(float in_fSample)
+        {
+            if (m_fOutputMult < 1.0f)
+                m_fOutputMult += 1.0f / (0.01f * (float)m_iSampleRate);
+            float fOutput = 0.0f;
+            for (int i = 0; i < m_iNumModes; i++)
+                fOutput += m_Filters[i].ProcessSample(in_fSample) * m_fGains[i];
+            return fOutput * m_fOutputMult * m_fOutputMult;
+        }
+
+    private:
+        ReferenceBiquad m_Filters[nemlib::MAX_FILTERBANK_FILTERS];
+        float m_fGains[nemlib::MAX_FILTERBANK_FILTERS] = {};
+        int m_iNumModes = 0;
+        int m_iSampleRate;
+        float m_fOutputMult = 0.0f;
+    };
+
+    // Frozen copy of CurveEnvelope, evaluated at every point. Without segment times the Time is spread over
+    // the points, with them each segment ramps to its value over its own time
+    class ReferenceEnvelope
+    {
+    public:
+        ReferenceEnvelope(int in_iSampleRate, const std::vector<float>& in_Values, const std::vector<float>& in_Times)
+            : m_Values(in_Values), m_Times(in_Times), m_fPosInc(1.0f / (float)in_iSampleRate)
+        {
+            m_fTime = 0.0f;
+            for (float fTime : m_Times)
+                m_fTime += fTime;
+            m_fBoundary = m_Times[0];
+        }
+
+        float NextPoint()
+        {
+            const int iNumValues = (int)m_Values.size();
+            if (m_iCounter > iNumValues - 1)
+                return m_Values[iNumValues - 1];
+
+            float fValue;
+            if (m_fPos > m_fBoundary)
+            {
+                m_iCounter++;
+                if (m_iCounter <= iNumValues - 1)
+                    m_fBoundary += m_Times[m_iCounter - 1];
+            }
+            if (m_iCounter <= iNumValues - 1)
+                fValue = m_Values[m_iCounter] + (m_fPos - m_fBoundary) * (m_Values[m_iCounter] - m_Values[m_iCounter - 1]) / m_Times[m_iCounter - 1];
+            else
+                fValue = m_Values[iNumValues - 1];
+            if (m_fPos <= m_fTime)
+                m_fPos += m_fPosInc;
+            return fValue;
+        }
+
+    private:
+        std::vector<float> m_Values;
+        std::vector<float> m_Times;
+        float m_fPosInc;
+        float m_fTime;
+        float m_fPos = 0.0f;
+        float m_fBoundary;
+        int m_iCounter = 1;
+    };
+
+    /*### MEASUREMENTS ###*/
+
+    // Welch power spectrum, bins 0 to SPECTRUM_SIZE / 2
+    std::vector<double> PowerSpectrum(nemlib::RealFFT& io_FFT, const std::vector<float>& in_Signal)
+    {
+        std::vector<double> Power(SPECTRUM_SIZE / 2 + 1, 0.0);
+        std::vector<float> Frame(SPECTRUM_SIZE);
+        std::vector<float> Spectrum(SPECTRUM_SIZE + 2);
+        const int iHop = SPECTRUM_SIZE / 2;
+        const int iFrames = std::max(((int)in_Signal.size() - SPECTRUM_SIZE) / iHop + 1, 1);
+        for (int iFrame = 0; iFrame < iFrames; iFrame++)
+        {
+            for (int i = 0; i < SPECTRUM_SIZE; i++)
+            {
+                const size_t uIndex = (size_t)iFrame * iHop + i;
+                const float fWindow = 0.5f - 0.5f * cosf(2.0f * (float)nemlib::NEM_PI * (float)i / (float)SPECTRUM_SIZE);
+                Frame[i] = uIndex < in_Signal.size() ? in_Signal[uIndex] * fWindow : 0.0f;
+            }
+            io_FFT.Forward(Frame.data(), Spectrum.data());
+            for (int k = 0; k <= SPECTRUM_SIZE / 2; k++)
+            {
+                const double fRe = Spectrum[2 * k];
+                const double fIm = Spectrum[2 * k + 1];
+                Power[k] += fRe * fRe + fIm * fIm;
+            }
+        }
+        return Power;
+    }
+
+    Metrics Compare(nemlib::RealFFT& io_FFT, const std::vector<float>& in_Reference, const std::vector<float>& in_Test)
+    {
+        Metrics Result;
+        double fSignal = 0.0;
+        double fError = 0.0;
+        for (size_t i = 0; i < in_Reference.size(); i++)
+        {
+            const double fDiff = (double)in_Test[i] - (double)in_Reference[i];
+            Result.MaxAbsError = std::max(Result.MaxAbsError, fabs(fDiff));
+            fSignal += (double)in_Reference[i] * in_Reference[i];
+            fError += fDiff * fDiff;
+        }
+        if (fError > 0.0)
+            Result.SnrDB = fSignal > 0.0 ? 10.0 * log10(fSignal / fError) : -INFINITY;
+        if (fError == 0.0)
+            return Result;
+
+        const std::vector<double> ReferencePower = PowerSpectrum(io_FFT, in_Reference);
+        const std::vector<double> TestPower = PowerSpectrum(io_FFT, in_Test);
+        const double fFloor = *std::max_element(ReferencePower.begin(), ReferencePower.end()) * pow(10.0, SPECTRUM_FLOOR_DB / 10.0);
+        for (size_t k = 0; k < ReferencePower.size(); k++)
+        {
+            if (ReferencePower[k] <= fFloor && TestPower[k] <= fFloor)
+                continue;
+            const double fDeviation = fabs(10.0 * log10(std::max(TestPower[k], fFloor) / std::max(ReferencePower[k], fFloor)));
+            Result.SpectralDeviationDB = std::max(Result.SpectralDeviationDB, fDeviation);
+        }
+        return Result;
+    }
+
+    // Prints one result line, in_pThresholds is null for the report-only rows. True when within the thresholds
+    bool Report(const char* in_szName, const Metrics& in_Metrics, const Thresholds* in_pThresholds)
+    {
+        bool bPass = true;
+        if (in_pThresholds != nullptr)
+        {
+            bPass = in_Metrics.MaxAbsError <= in_pThresholds->MaxAbsError && in_Metrics.SnrDB >= in_pThresholds->MinSnrDB
+                && in_Metrics.SpectralDeviationDB <= in_pThresholds->MaxSpectralDeviationDB;
+        }
+        char szSnr[32];
+        if (std::isinf(in_Metrics.SnrDB) && in_Metrics.SnrDB > 0.0)
+            snprintf(szSnr, sizeof(szSnr), "exact");
+        else
+            snprintf(szSnr, sizeof(szSnr), "%.1f dB", in_Metrics.SnrDB);
+        printf("  %-46s max abs %10.3g  SNR %10s  spectral %7.3f dB  %s\n", in_szName, in_Metrics.MaxAbsError, szSnr,
+            in_Metrics.SpectralDeviationDB, in_pThresholds == nullptr ? "(report only)" : bPass ? "ok" : "FAILED");
+        return bPass;
+    }
+
+    /*### COMPONENTS ###*/
+
+    // Seeded noise bursts separated by silence, so the filters are measured while they ring out as well
+    std::vector<float> MakeInput(std::mt19937& io_Rng, int in_iFrames)
+    {
+        std::vector<float> Input(in_iFrames, 0.0f);
+        std::uniform_real_distribution<float> Sample(-1.0f, 1.0f);
+        for (int i = 0; i < in_iFrames; i++)
+        {
+            if ((i / (SEGMENT_FRAMES / 4)) % 4 != 3)
+                Input[i] = Sample(io_Rng);
+        }
+        return Input;
+    }
+
+    nemlib::Mode MakeMode(std::mt19937& io_Rng)
+    {
+        std::uniform_real_distribution<float> Unit(0.0f, 1.0f);
+        nemlib::Mode Result = {};
+        Result.nModes = 1 + (int)(Unit(io_Rng) * (float)nemlib::MAX_FILTERBANK_FILTERS) % nemlib::MAX_FILTERBANK_FILTERS;
+        for (int i = 0; i < Result.nModes; i++)
+        {
+            Result.Types[i] = Unit(io_Rng) < 0.8f ? nemlib::bq_type_bandpass : (Unit(io_Rng) < 0.5f ? nemlib::bq_type_lowpass : nemlib::bq_type_highpass);
+            Result.Freqs[i] = 40.0f * powf(400.0f, Unit(io_Rng));
+            Result.Qs[i] = 0.5f + Unit(io_Rng) * 30.0f;
+            Result.Gains[i] = 0.1f + Unit(io_Rng);
+        }
+        return Result;
+    }
+
+    // Name of a result row for the selected kernel variant
+    std::string VariantRowName(const char* in_szName)
+    {
+        return std::string(in_szName) + " (" + nemlib::GetKernelVariantName(nemlib::GetKernelVariant()) + ")";
+    }
+
+    bool CheckNoise(nemlib::RealFFT& io_FFT, const EquivalenceOptions& in_Options, int in_iFrames)
+    {
+        // Hands the noise out in odd sized chunks and skips part of the stream, like the models do
+        nemlib::WhiteNoiseGen Noise((int)in_Options.SampleRate);
+        Noise.SetSeed(in_Options.Seed);
+        std::vector<float> Reference(in_iFrames);
+        std::vector<float> Test(in_iFrames);
+        std::mt19937 Rng(in_Options.Seed);
+        AkUInt32 uIndex = 0;
+        for (int i = 0; i < in_iFrames;)
+        {
+            const int iChunk = std::min((int)(Rng() % 67) + 1, in_iFrames - i);
+            if (Rng() % 8 == 0)
+            {
+                const int iSkip = (int)(Rng() % 100);
+                Noise.Skip(iSkip);
+                uIndex += (AkUInt32)iSkip;
+            }
+            if (Rng() % 2 == 0)
+                Noise.Fill(&Test[i], iChunk);
+            else
+                for (int j = 0; j < iChunk; j++)
+                    Test[i + j] = Noise.NextSample();
+            for (int j = 0; j < iChunk; j++)
+                Reference[i + j] = ReferenceNoiseSample(in_Options.Seed, uIndex++);
+            i += iChunk;
+        }
+        return Report(VariantRowName("WhiteNoiseGen").c_str(), Compare(io_FFT, Reference, Test), &NOISE_THRESHOLDS);
+    }
+
+    bool CheckBiquad(nemlib::RealFFT& io_FFT, const EquivalenceOptions& in_Options, int in_iFrames)
+    {
+        const char* const TYPE_NAMES[] = { "lowpass", "highpass", "bandpass" };
+        const int iRate = (int)in_Options.SampleRate;
+        bool bPass = true;
+        for (int iType = nemlib::bq_type_lowpass; iType <= nemlib::bq_type_bandpass; iType++)
+        {
+            std::mt19937 Rng(in_Options.Seed + (AkUInt32)iType);
+            std::uniform_real_distribution<float> Unit(0.0f, 1.0f);
+            const std::vector<float> Input = MakeInput(Rng, in_iFrames);
+            std::vector<float> Reference(in_iFrames);
+            std::vector<float> Test(in_iFrames);
+
+            // Coefficients change at every segment without clearing the filter memories, as the models do
+            nemlib::BiquadFilter Filter(iRate, 1000.0f, 1.0f, 0.0f, iType);
+            ReferenceBiquad RefFilter;
+            for (int i = 0; i < in_iFrames; i++)
+            {
+                if (i % SEGMENT_FRAMES == 0)
+                {
+                    const float fFrequency = 30.0f * powf(600.0f, Unit(Rng));
+                    const float fQ = 0.3f + Unit(Rng) * 20.0f;
+                    Filter.SetQFactor(fQ);
+                    Filter.SetFrequency(fFrequency);
+                    RefFilter.Set(iRate, fFrequency, fQ, iType);
+                }
+                Test[i] = Filter.ProcessSample(Input[i]);
+                Reference[i] = RefFilter.ProcessSample(Input[i]);
+            }
+            char szName[64];
+            snprintf(szName, sizeof(szName), "BiquadFilter %s", TYPE_NAMES[iType]);
+            bPass = Report(szName, Compare(io_FFT, Reference, Test), &BIQUAD_THRESHOLDS) && bPass;
+        }
+        return bPass;
+    }
+
+    bool CheckFilterBank(nemlib::RealFFT& io_FFT, const EquivalenceOptions& in_Options, int in_iFrames)
+    {
+        std::mt19937 Rng(in_Options.Seed);
+        const std::vector<float> Input = MakeInput(Rng, in_iFrames);
+        std::vector<float> Reference(in_iFrames);
+        std::vector<float> Test(in_iFrames);
+
+        nemlib::FilterBank Bank((int)in_Options.SampleRate, nemlib::MAX_FILTERBANK_FILTERS);
+        ReferenceFilterBank RefBank((int)in_Options.SampleRate);
+        for (int i = 0; i < in_iFrames; i++)
+        {
+            if (i % SEGMENT_FRAMES == 0)
+            {
+                const nemlib::Mode NewMode = MakeMode(Rng);
+                Bank.InitialiseFilterBank(NewMode);
+                RefBank.Initialise(NewMode);
+            }
+            Test[i] = Bank.ProcessSample(Input[i]);
+            Reference[i] = RefBank.ProcessSample(Input[i]);
+        }
+        return Report(VariantRowName("FilterBank").c_str(), Compare(io_FFT, Reference, Test), &FILTERBANK_THRESHOLDS);
+    }
+
+    bool CheckEnvelope(nemlib::RealFFT& io_FFT, const EquivalenceOptions& in_Options, int in_iFrames, bool in_bTiers)
+    {
+        // Step shapes like the heel and ball envelopes, retriggered at every segment
+        const int iRate = (int)in_Options.SampleRate;
+        std::mt19937 Rng(in_Options.Seed);
+        std::uniform_real_distribution<float> Unit(0.0f, 1.0f);
+        const int iSegments = std::max(in_iFrames / SEGMENT_FRAMES, 1);
+        std::vector<std::vector<float>> Values(iSegments);
+        std::vector<std::vector<float>> Times(iSegments);
+        for (int s = 0; s < iSegments; s++)
+        {
+            Values[s] = { 0.0f, 0.5f + 0.5f * Unit(Rng), 0.1f + 0.3f * Unit(Rng), 0.0f };
+            Times[s] = { 0.0005f + 0.01f * Unit(Rng), 0.005f + 0.03f * Unit(Rng), 0.01f + 0.04f * Unit(Rng) };
+        }
+
+        auto Render = [&](int in_iResolution, std::vector<float>& out_Samples)
+        {
+            nemlib::CurveEnvelope Env(iRate, Values[0], Times[0]);
+            Env.SetResolution(in_iResolution);
+            out_Samples.assign(in_iFrames, 0.0f);
+            for (int i = 0; i < in_iFrames; i++)
+            {
+                const int s = i / SEGMENT_FRAMES;
+                if (i % SEGMENT_FRAMES == 0 && s < iSegments)
+                {
+                    Env.SetValues({ Values[s][0], Values[s][1], Values[s][2], Values[s][3] });
+                    Env.SetTimes({ Times[s][0], Times[s][1], Times[s][2] });
+                    Env.ResetEnvelope();
+                }
+                out_Samples[i] = Env.GetNextEnvelopePoint();
+            }
+        };
+
+        std::vector<float> Reference(in_iFrames, 0.0f);
+        for (int s = 0; s < iSegments; s++)
+        {
+            ReferenceEnvelope RefEnv(iRate, Values[s], Times[s]);
+            const int iEnd = s + 1 < iSegments ? (s + 1) * SEGMENT_FRAMES : in_iFrames;
+            for (int i = s * SEGMENT_FRAMES; i < iEnd; i++)
+                Reference[i] = RefEnv.NextPoint();
+        }
+
+        std::vector<float> Test;
+        Render(1, Test);
+        bool bPass = Report("CurveEnvelope", Compare(io_FFT, Reference, Test), &ENVELOPE_THRESHOLDS);
+        if (in_bTiers)
+        {
+            for (int iResolution : { 4, 16, 32 })
+            {
+                char szName[64];
+                snprintf(szName, sizeof(szName), "CurveEnvelope resolution %d", iResolution);
+                Render(iResolution, Test);
+                Report(szName, Compare(io_FFT, Reference, Test), nullptr);
+            }
+        }
+        return bPass;
+    }
+
+    /*### FULL RENDER ###*/
+
+    // What a voice playing the scenario would allocate
+    GeneratorSubsystems GetSubsystems(const RenderScenario& in_Scenario)
+    {
+        return { in_Scenario.Convolution, false, false, in_Scenario.Terrain, in_Scenario.CrowdSize, in_Scenario.Surface, 0, DEFAULT_IDLE_RELEASE_TIME };
+    }
+
+    void RenderModel(const RenderScenario& in_Scenario, const EquivalenceOptions& in_Options, int in_iFrames,
+        const GeneratorTier& in_Tier, AkInt32 in_iRateDivisor, std::vector<float>& out_Samples, int in_iBufferFrames = RENDER_BLOCK)
+    {
+        Generator Gen;
+        Gen.SetSeed(in_Options.Seed);
+        Gen.PrepareModel(in_Options.SampleRate, nullptr, in_iRateDivisor);
+        Gen.PrepareSubsystems(GetSubsystems(in_Scenario));
+        Gen.SetTier(in_Tier);
+        Gen.SetShoeType(in_Scenario.Shoe);
+        Gen.SetSurfaceType(in_Scenario.Surface);
+        Gen.SetTerrain(in_Scenario.Terrain);
+        Gen.SetPace(in_Scenario.Pace);
+        Gen.SetCrowdSize(in_Scenario.CrowdSize);
+        Gen.SetConvolution(in_Scenario.Convolution);
+        out_Samples.assign(in_iFrames, 0.0f);
+        for (int iDone = 0; iDone < in_iFrames; iDone += in_iBufferFrames)
+        {
+            Gen.ExcuteModel(&out_Samples[iDone], (AkUInt16)std::min(in_iBufferFrames, in_iFrames - iDone));
+        }
+    }
+
+    // A voice of a scenario, without rendering it
+    void PrepareVoice(Generator& io_Gen, const RenderScenario& in_Scenario, const EquivalenceOptions& in_Options, AkUInt32 in_uSeed)
+    {
+        io_Gen.SetSeed(in_uSeed);
+        io_Gen.PrepareModel(in_Options.SampleRate);
+        io_Gen.PrepareSubsystems(GetSubsystems(in_Scenario));
+        io_Gen.SetShoeType(in_Scenario.Shoe);
+        io_Gen.SetSurfaceType(in_Scenario.Surface);
+        io_Gen.SetTerrain(in_Scenario.Terrain);
+        io_Gen.SetPace(in_Scenario.Pace);
+        io_Gen.SetCrowdSize(in_Scenario.CrowdSize);
+        io_Gen.SetConvolution(in_Scenario.Convolution);
+    }
+
+    // Every scenario in turn, each voice with its own seed
+    std::vector<std::unique_ptr<Generator>> PrepareVoices(const EquivalenceOptions& in_Options, int in_iVoices)
+    {
+        std::vector<std::unique_ptr<Generator>> Voices;
+        for (int i = 0; i < in_iVoices; i++)
+        {
+            Voices.emplace_back(new Generator());
+            PrepareVoice(*Voices.back(), RENDER_SCENARIOS[i % NUM_RENDER_SCENARIOS], in_Options, in_Options.Seed + (AkUInt32)i);
+        }
+        return Voices;
+    }
+
+    void WriteUInt32(FILE* pFile, AkUInt32 in_uValue)
+    {
+        const unsigned char Bytes[4] = { (unsigned char)in_uValue, (unsigned char)(in_uValue >> 8), (unsigned char)(in_uValue >> 16), (unsigned char)(in_uValue >> 24) };
+        fwrite(Bytes, 1, 4, pFile);
+    }
+
+    void WriteUInt16(FILE* pFile, AkUInt16 in_uValue)
+    {
+        const unsigned char Bytes[2] = { (unsigned char)in_uValue, (unsigned char)(in_uValue >> 8) };
+        fwrite(Bytes, 1, 2, pFile);
+    }
+
+    AkUInt32 ReadUInt32(const unsigned char* in_pBytes)
+    {
+        return (AkUInt32)in_pBytes[0] | ((AkUInt32)in_pBytes[1] << 8) | ((AkUInt32)in_pBytes[2] << 16) | ((AkUInt32)in_pBytes[3] << 24);
+    }
+
+    // Mono 32-bit float WAV, little endian whatever the host, so golden renders can be moved between machines
+    bool WriteFloatWav(const std::string& in_Path, const std::vector<float>& in_Samples, AkUInt32 in_uSampleRate)
+    {
+        FILE* pFile = fopen(in_Path.c_str(), "wb");
+        if (pFile == nullptr)
+            return false;
+
+        const AkUInt32 uDataSize = (AkUInt32)in_Samples.size() * 4;
+        fwrite("RIFF", 1, 4, pFile);
+        WriteUInt32(pFile, 36 + uDataSize);
+        fwrite("WAVEfmt ", 1, 8, pFile);
+        WriteUInt32(pFile, 16);
+        WriteUInt16(pFile, 3); // IEEE float
+        WriteUInt16(pFile, 1); // mono
+        WriteUInt32(pFile, in_uSampleRate);
+        WriteUInt32(pFile, in_uSampleRate * 4);
+        WriteUInt16(pFile, 4);
+        WriteUInt16(pFile, 32);
+        fwrite("data", 1, 4, pFile);
+        WriteUInt32(pFile, uDataSize);
+        for (float fSample : in_Samples)
+        {
+            AkUInt32 uBits;
+            memcpy(&uBits, &fSample, sizeof(uBits));
+            WriteUInt32(pFile, uBits);
+        }
+
+        const bool bOk = ferror(pFile) == 0;
+        fclose(pFile);
+        return bOk;
+    }
+
+    // Only reads back what WriteFloatWav writes
+    bool ReadFloatWav(const std::string& in_Path, AkUInt32 in_uSampleRate, std::vector<float>& out_Samples)
+    {
+        FILE* pFile = fopen(in_Path.c_str(), "rb");
+        if (pFile == nullptr)
+            return false;
+
+        unsigned char Header[44];
+        bool bOk = fread(Header, 1, sizeof(Header), pFile) == sizeof(Header) && memcmp(Header, "RIFF", 4) == 0
+            && memcmp(Header + 8, "WAVEfmt ", 8) == 0 && Header[20] == 3 && Header[22] == 1
+            && ReadUInt32(Header + 24) == in_uSampleRate && memcmp(Header + 36, "data", 4) == 0;
+        if (bOk)
+        {
+            std::vector<unsigned char> Data(ReadUInt32(Header + 40));
+            bOk = fread(Data.data(), 1, Data.size(), pFile) == Data.size();
+            out_Samples.resize(Data.size() / 4);
+            for (size_t i = 0; bOk && i < out_Samples.size(); i++)
+            {
+                const AkUInt32 uBits = ReadUInt32(&Data[i * 4]);
+                memcpy(&out_Samples[i], &uBits, sizeof(uBits));
+            }
+        }
+        fclose(pFile);
+        return bOk;
+    }
+
+    // Writes the golden renders, or compares with them. Returns 0 when everything matched, 1 on a failure, 2 on a missing file
+    int CheckGenerator(nemlib::RealFFT& io_FFT, const EquivalenceOptions& in_Options, int in_iFrames)
+    {
+        const GeneratorTier FullTier = { nemlib::MAX_FILTERBANK_FILTERS, true, 1 };
+        int iResult = 0;
+        std::vector<float> Test;
+        std::vector<float> Reference;
+        for (const RenderScenario& Scenario : RENDER_SCENARIOS)
+        {
+            RenderModel(Scenario, in_Options, in_iFrames, FullTier, 1, Test);
+            const std::string Path = (std::filesystem::path(in_Options.GoldenDir) / (std::string(Scenario.Name) + ".wav")).string();
+            if (in_Options.WriteGolden)
+            {
+                if (!WriteFloatWav(Path, Test, in_Options.SampleRate))
+                {
+                    fprintf(stderr, "Failed to write %s\n", Path.c_str());
+                    return 2;
+                }
+                continue;
+            }
+            // Renders of another length or seed would not line up sample for sample
+            if (!ReadFloatWav(Path, in_Options.SampleRate, Reference) || Reference.size() != Test.size())
+            {
+                fprintf(stderr, "No golden render matching these options in %s, write them with --write-golden\n", Path.c_str());
+                return 2;
+            }
+            char szName[64];
+            snprintf(szName, sizeof(szName), "Generator %s", Scenario.Name);
+            if (!Report(VariantRowName(szName).c_str(), Compare(io_FFT, Reference, Test), &GENERATOR_THRESHOLDS))
+                iResult = 1;
+        }
+        if (in_Options.WriteGolden)
+            printf("  Wrote %d golden renders to %s\n", NUM_RENDER_SCENARIOS, in_Options.GoldenDir.c_str());
+        return iResult;
+    }
+
+    // The tiers take other random draws than the full model, so only the spectral deviation is meaningful here
+    void ReportTiers(nemlib::RealFFT& io_FFT, const EquivalenceOptions& in_Options, int in_iFrames)
+    {
+        struct TierVariant
+        {
+            const char* Name;
+            GeneratorTier Tier;
+            AkInt32 RateDivisor;
+        };
+        const TierVariant TIER_VARIANTS[] = {
+            { "5 modes", { 5, true, 1 }, 1 },
+            { "no crunch", { nemlib::MAX_FILTERBANK_FILTERS, false, 1 }, 1 },
+            { "envelope resolution 16", { nemlib::MAX_FILTERBANK_FILTERS, true, 16 }, 1 },
+            { "rate / 2", { nemlib::MAX_FILTERBANK_FILTERS, true, 1 }, 2 },
+            { "rate / 4", { nemlib::MAX_FILTERBANK_FILTERS, true, 1 }, 4 },
+        };
+        const GeneratorTier FullTier = { nemlib::MAX_FILTERBANK_FILTERS, true, 1 };
+        const RenderScenario& Scenario = RENDER_SCENARIOS[2];
+        std::vector<float> Reference;
+        std::vector<float> Test;
+        RenderModel(Scenario, in_Options, in_iFrames, FullTier, 1, Reference);
+        for (const TierVariant& Variant : TIER_VARIANTS)
+        {
+            RenderModel(Scenario, in_Options, in_iFrames, Variant.Tier, Variant.RateDivisor, Test);
+            char szName[64];
+            snprintf(szName, sizeof(szName), "Generator %s", Variant.Name);
+            Report(szName, Compare(io_FFT, Reference, Test), nullptr);
+        }
+    }
+
+    // The same voices rendered one after the other and summed in voice order, then mixed by the scheduler on
+    // every core
+    bool CheckVoiceScheduler(nemlib::RealFFT& io_FFT, const EquivalenceOptions& in_Options, int in_iFrames)
+    {
+        const AkUInt32 uThreads = std::max(std::thread::hardware_concurrency(), 2u);
+        std::vector<std::unique_ptr<Generator>> SerialVoices = PrepareVoices(in_Options, SCHEDULER_VOICES);
+        std::vector<std::unique_ptr<Generator>> ScheduledVoices = PrepareVoices(in_Options, SCHEDULER_VOICES);
+        VoiceRenderScheduler Scheduler(uThreads, (AkUInt16)RENDER_BLOCK);
+        for (std::unique_ptr<Generator>& Voice : ScheduledVoices)
+            Scheduler.AddVoice(Voice.get());
+
+        std::vector<float> Reference(in_iFrames, 0.0f);
+        std::vector<float> Test(in_iFrames);
+        std::vector<float> VoiceOutput(RENDER_BLOCK);
+        for (int iDone = 0; iDone < in_iFrames; iDone += RENDER_BLOCK)
+        {
+            const int iBlock = std::min(RENDER_BLOCK, in_iFrames - iDone);
+            for (std::unique_ptr<Generator>& Voice : SerialVoices)
+            {
+                Voice->ExcuteModel(VoiceOutput.data(), (AkUInt16)iBlock);
+                for (int i = 0; i < iBlock; i++)
+                    Reference[iDone + i] += VoiceOutput[i];
+            }
+            Scheduler.Render(&Test[iDone], (AkUInt16)iBlock);
+        }
+
+        char szName[64];
+        snprintf(szName, sizeof(szName), "VoiceRenderScheduler, %d voices on %u threads", SCHEDULER_VOICES, uThreads);
+        return Report(szName, Compare(io_FFT, Reference, Test), &MIX_THRESHOLDS);
+    }
+
+    /*### RANDOM STREAMS ###*/
+
+    // Deviations of a stream from the uniform distribution over [in_fMin, in_fMax), the mean, variance and lag 1
+    // correlation in standard errors
+    struct RandomStatistics
+    {
+        double MeanZ = 0.0;
+        double VarianceZ = 0.0;
+        double CorrelationZ = 0.0;
+        double ChiSquare = 0.0;
+    };
+
+    RandomStatistics MeasureRandomStatistics(const std::vector<float>& in_Values, float in_fMin, float in_fMax)
+    {
+        const double fCount = (double)in_Values.size();
+        const double fRange = (double)in_fMax - (double)in_fMin;
+        // Uniform over [0, 1) once rescaled: mean 1/2, variance 1/12, fourth central moment 1/80
+        std::vector<double> Buckets(RANDOM_BUCKETS, 0.0);
+        double fSum = 0.0;
+        double fSquares = 0.0;
+        double fLagProducts = 0.0;
+        double fPrevious = 0.5;
+        for (float fValue : in_Values)
+        {
+            const double fUnit = ((double)fValue - (double)in_fMin) / fRange;
+            const int iBucket = std::min((int)(fUnit * RANDOM_BUCKETS), RANDOM_BUCKETS - 1);
+            Buckets[std::max(iBucket, 0)] += 1.0;
+            fSum += fUnit;
+            fSquares += (fUnit - 0.5) * (fUnit - 0.5);
+            fLagProducts += (fUnit - 0.5) * (fPrevious - 0.5);
+            fPrevious = fUnit;
+        }
+
+        RandomStatistics Statistics;
+        Statistics.MeanZ = (fSum / fCount - 0.5) / sqrt(1.0 / 12.0 / fCount);
+        Statistics.VarianceZ = (fSquares / fCount - 1.0 / 12.0) / sqrt((1.0 / 80.0 - 1.0 / 144.0) / fCount);
+        Statistics.CorrelationZ = (fLagProducts / fCount) / (1.0 / 12.0 / sqrt(fCount));
+        const double fExpected = fCount / RANDOM_BUCKETS;
+        for (double fBucket : Buckets)
+            Statistics.ChiSquare += (fBucket - fExpected) * (fBucket - fExpected) / fExpected;
+        return Statistics;
+    }
+
+    // Prints one result line. True when the stream looks unbiased, or when in_bExpectBiased and it doesn't
+    bool ReportRandom(const char* in_szName, const RandomStatistics& in_Statistics, bool in_bExpectBiased)
+    {
+        const bool bUnbiased = fabs(in_Statistics.MeanZ) <= RANDOM_MAX_Z && fabs(in_Statistics.VarianceZ) <= RANDOM_MAX_Z
+            && fabs(in_Statistics.CorrelationZ) <= RANDOM_MAX_Z && in_Statistics.ChiSquare <= RANDOM_MAX_CHI_SQUARE;
+        const bool bPass = bUnbiased != in_bExpectBiased;
+        printf("  %-46s mean %+6.2f  var %+6.2f  lag1 %+6.2f  chi2 %8.1f  %s\n", in_szName, in_Statistics.MeanZ,
+            in_Statistics.VarianceZ, in_Statistics.CorrelationZ, in_Statistics.ChiSquare,
+            bPass ? (in_bExpectBiased ? "ok (bias caught)" : "ok") : (in_bExpectBiased ? "FAILED (bias missed)" : "FAILED"));
+        return bPass;
+    }
+
+    bool CheckRandom(const EquivalenceOptions& in_Options)
+    {
+        std::vector<float> Values(RANDOM_VALUES);
+        bool bPass = true;
+
+        nemlib::Random Rng(in_Options.Seed);
+        for (float& fValue : Values)
+            fValue = Rng.NextFloat();
+        bPass = ReportRandom("Random NextFloat", MeasureRandomStatistics(Values, 0.0f, 1.0f), false) && bPass;
+
+        Rng.SetSeed(in_Options.Seed);
+        for (int i = 0; i < RANDOM_VALUES; i += RENDER_BLOCK)
+            Rng.NextNoiseBlock(&Values[i], std::min(RENDER_BLOCK, RANDOM_VALUES - i));
+        bPass = ReportRandom(VariantRowName("Random NextNoiseBlock").c_str(), MeasureRandomStatistics(Values, -1.0f, 1.0f), false) && bPass;
+
+        nemlib::WhiteNoiseGen Noise((int)in_Options.SampleRate);
+        Noise.SetSeed(in_Options.Seed);
+        for (int i = 0; i < RANDOM_VALUES; i += RENDER_BLOCK)
+            Noise.Fill(&Values[i], std::min(RENDER_BLOCK, RANDOM_VALUES - i));
+        bPass = ReportRandom(VariantRowName("WhiteNoiseGen Fill").c_str(), MeasureRandomStatistics(Values, -1.0f, 1.0f), false) && bPass;
+
+        // Every 32nd draw below 1/2 drawn again, a bias of 1/256 on the mean that a weak check would miss
+        Rng.SetSeed(in_Options.Seed);
+        for (int i = 0; i < RANDOM_VALUES; i++)
+        {
+            Values[i] = Rng.NextFloat();
+            if (i % 32 == 0 && Values[i] < 0.5f)
+                Values[i] = Rng.NextFloat();
+        }
+        bPass = ReportRandom("Biased NextFloat", MeasureRandomStatistics(Values, 0.0f, 1.0f), true) && bPass;
+        return bPass;
+    }
+
+    /*### PARAMETERS ###*/
+
+    // RTPCs of one batch, every one set to the batch number so a snapshot mixing two batches shows
+    const AkPluginParamID BATCH_PARAM_IDS[] = { PARAM_PACE_ID, PARAM_FIRMNESS_ID, PARAM_STEADINESS_ID, PARAM_PACESPREAD_ID,
+        PARAM_STEADINESSSPREAD_ID, PARAM_PACETARGET_ID, PARAM_FIRMNESSTARGET_ID, PARAM_SURFACEBLEND_ID };
+    const int NUM_BATCH_PARAMS = sizeof(BATCH_PARAM_IDS) / sizeof(BATCH_PARAM_IDS[0]);
+
+    void ReadBatchParams(const FootstepsRTPCParams& in_RTPC, AkReal32 out_Values[NUM_BATCH_PARAMS])
+    {
+        const AkReal32 Values[NUM_BATCH_PARAMS] = { in_RTPC.fPace, in_RTPC.fFirmness, in_RTPC.fSteadiness, in_RTPC.fPaceSpread,
+            in_RTPC.fSteadinessSpread, in_RTPC.fPaceTarget, in_RTPC.fFirmnessTarget, in_RTPC.fSurfaceBlend };
+        for (int i = 0; i < NUM_BATCH_PARAMS; i++)
+            out_Values[i] = Values[i];
+    }
+
+    // Snapshots have to hold whole batches: the RTPCs set before a buffer on the audio thread, and the batches
+    // given to SetParams by a writer thread while the audio thread keeps taking snapshots
+    bool CheckParamBatches()
+    {
+        FootstepsSourceParams Params;
+        Params.Init(nullptr, nullptr, 0);
+        AkReal32 Values[NUM_BATCH_PARAMS];
+
+        // Same thread, published once at the next snapshot
+        AkUInt32 uSequence = Params.GetSnapshot().uSequence;
+        for (int i = 0; i < NUM_BATCH_PARAMS; i++)
+        {
+            const AkReal32 fValue = 1.0f;
+            Params.SetParam(BATCH_PARAM_IDS[i], &fValue, sizeof(fValue));
+        }
+        const FootstepsParamSnapshot& Snapshot = Params.GetSnapshot();
+        ReadBatchParams(Snapshot.RTPC, Values);
+        bool bPass = Snapshot.uSequence == uSequence + 1 && std::all_of(Values, Values + NUM_BATCH_PARAMS, [](AkReal32 v) { return v == 1.0f; });
+
+        std::atomic<bool> bWriterDone(false);
+        std::thread Writer([&]()
+        {
+            AkReal32 BatchValues[NUM_BATCH_PARAMS];
+            FootstepsParamValue Batch[NUM_BATCH_PARAMS];
+            for (int b = 2; b < PARAM_BATCHES; b++)
+            {
+                for (int i = 0; i < NUM_BATCH_PARAMS; i++)
+                {
+                    BatchValues[i] = (AkReal32)b;
+                    Batch[i] = { BATCH_PARAM_IDS[i], &BatchValues[i], sizeof(AkReal32) };
+                }
+                Params.SetParams(Batch, NUM_BATCH_PARAMS);
+            }
+            bWriterDone.store(true, std::memory_order_release);
+        });
+
+        int iSnapshots = 0;
+        int iTorn = 0;
+        int iBackwards = 0;
+        AkReal32 fLast = 1.0f;
+        for (bool bDone = false; !bDone;)
+        {
+            bDone = bWriterDone.load(std::memory_order_acquire);
+            ReadBatchParams(Params.GetSnapshot().RTPC, Values);
+            iSnapshots++;
+            if (!std::all_of(Values, Values + NUM_BATCH_PARAMS, [&](AkReal32 v) { return v == Values[0]; }))
+                iTorn++;
+            if (Values[0] < fLast)
+                iBackwards++;
+            fLast = Values[0];
+        }
+        Writer.join();
+        bPass = bPass && iTorn == 0 && iBackwards == 0 && fLast == (AkReal32)(PARAM_BATCHES - 1);
+
+        // Set on the audio thread after the last batch was taken, the batch must not bring the old value back
+        const AkReal32 fPace = -1.0f;
+        Params.SetParam(PARAM_PACE_ID, &fPace, sizeof(fPace));
+        Params.GetSnapshot();
+        bPass = bPass && Params.GetSnapshot().RTPC.fPace == fPace;
+
+        printf("  %-46s %d batches, %d snapshots, %d torn, %d out of order  %s\n", "FootstepsSourceParams batches",
+            PARAM_BATCHES, iSnapshots, iTorn, iBackwards, bPass ? "ok" : "FAILED");
+        return bPass;
+    }
+
+    /*### BENCHMARK ###*/
+
+    template <typename RunType>
+    double MeasureNanosecondsPerFrame(int in_iFrames, RunType&& in_Run)
+    {
+        double fBest = INFINITY;
+        for (int i = 0; i < BENCH_RUNS; i++)
+        {
+            const auto Start = std::chrono::steady_clock::now();
+            in_Run();
+            const double fNanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count();
+            fBest = std::min(fBest, fNanoseconds / (double)in_iFrames);
+        }
+        return fBest;
+    }
+
+    // One row per benchmark and one column per kernel variant, with the speed-up over the scalar kernels
+    void ReportBenchmark(const EquivalenceOptions& in_Options, int in_iFrames)
+    {
+        const int iRate = (int)in_Options.SampleRate;
+        const int iVariants = (int)nemlib::GetSupportedKernelVariant() + 1;
+        std::mt19937 Rng(in_Options.Seed);
+        const std::vector<float> Input = MakeInput(Rng, in_iFrames);
+        std::vector<float> Output(in_iFrames);
+
+        // Every filter of the bank in use, as on the richest surfaces
+        nemlib::Mode BankMode = {};
+        BankMode.nModes = nemlib::MAX_FILTERBANK_FILTERS;
+        for (int i = 0; i < BankMode.nModes; i++)
+        {
+            BankMode.Types[i] = nemlib::bq_type_bandpass;
+            BankMode.Freqs[i] = 80.0f * powf(1.6f, (float)i);
+            BankMode.Qs[i] = 8.0f;
+            BankMode.Gains[i] = 0.5f;
+        }
+
+        const char* const BENCH_NAMES[] = { "WhiteNoiseGen Fill", "WhiteNoiseGen NextSample", "FilterBank", "Generator, every scenario" };
+        const int NUM_BENCHES = sizeof(BENCH_NAMES) / sizeof(BENCH_NAMES[0]);
+        double fResults[NUM_BENCHES][nemlib::NUM_KERNEL_VARIANTS] = {};
+        const GeneratorTier FullTier = { nemlib::MAX_FILTERBANK_FILTERS, true, 1 };
+        for (int v = 0; v < iVariants; v++)
+        {
+            nemlib::SelectKernels((nemlib::KernelVariant)v);
+            nemlib::WhiteNoiseGen Noise(iRate);
+            fResults[0][v] = MeasureNanosecondsPerFrame(in_iFrames, [&]()
+            {
+                for (int i = 0; i < in_iFrames; i += RENDER_BLOCK)
+                    Noise.Fill(&Output[i], std::min(RENDER_BLOCK, in_iFrames - i));
+            });
+            fResults[1][v] = MeasureNanosecondsPerFrame(in_iFrames, [&]()
+            {
+                for (int i = 0; i < in_iFrames; i++)
+                    Output[i] = Noise.NextSample();
+            });
+            nemlib::FilterBank Bank(iRate, nemlib::MAX_FILTERBANK_FILTERS);
+            Bank.InitialiseFilterBank(BankMode);
+            fResults[2][v] = MeasureNanosecondsPerFrame(in_iFrames, [&]()
+            {
+                for (int i = 0; i < in_iFrames; i++)
+                    Output[i] = Bank.ProcessSample(Input[i]);
+            });
+            fResults[3][v] = MeasureNanosecondsPerFrame(in_iFrames * NUM_RENDER_SCENARIOS, [&]()
+            {
+                for (const RenderScenario& Scenario : RENDER_SCENARIOS)
+                    RenderModel(Scenario, in_Options, in_iFrames, FullTier, 1, Output);
+            });
+        }
+
+        printf("  %-28s", "ns per frame");
+        for (int v = 0; v < iVariants; v++)
+            printf("  %16s", nemlib::GetKernelVariantName((nemlib::KernelVariant)v));
+        printf("\n");
+        for (int b = 0; b < NUM_BENCHES; b++)
+        {
+            printf("  %-28s", BENCH_NAMES[b]);
+            for (int v = 0; v < iVariants; v++)
+                printf("  %8.2f (x%4.2f)", fResults[b][v], fResults[b][0] / fResults[b][v]);
+            printf("\n");
+        }
+    }
+
+    // Every scenario rendered in buffers of each size with the kernels selected at load. The sizes take turns
+    // between runs, so a slower stretch of the machine doesn't land on a single one
+    void ReportBufferSizes(const EquivalenceOptions& in_Options, int in_iFrames)
+    {
+        const GeneratorTier FullTier = { nemlib::MAX_FILTERBANK_FILTERS, true, 1 };
+        std::vector<float> Output(in_iFrames);
+        double fResults[NUM_BENCH_BUFFER_SIZES];
+        for (int i = 0; i < NUM_BENCH_BUFFER_SIZES; i++)
+            fResults[i] = INFINITY;
+        for (int r = 0; r < BENCH_RUNS; r++)
+        {
+            for (int i = 0; i < NUM_BENCH_BUFFER_SIZES; i++)
+            {
+                const double fNanoseconds = MeasureNanosecondsPerFrame(in_iFrames * NUM_RENDER_SCENARIOS, [&]()
+                {
+                    for (const RenderScenario& Scenario : RENDER_SCENARIOS)
+                        RenderModel(Scenario, in_Options, in_iFrames, FullTier, 1, Output, BENCH_BUFFER_FRAMES[i]);
+                });
+                fResults[i] = std::min(fResults[i], fNanoseconds);
+            }
+        }
+
+        const double fReference = fResults[NUM_BENCH_BUFFER_SIZES - 1];
+        printf("  %-28s  %12s  %10s  %16s\n", "Buffer frames", "ns per frame", "vs 1024", "ns per buffer");
+        for (int i = 0; i < NUM_BENCH_BUFFER_SIZES; i++)
+        {
+            // What a buffer costs on top of its frames at the reference cost per frame
+            printf("  %-28d  %12.2f  %+9.1f%%  %16.1f\n", BENCH_BUFFER_FRAMES[i], fResults[i],
+                (fResults[i] / fReference - 1.0) * 100.0, (fResults[i] - fReference) * (double)BENCH_BUFFER_FRAMES[i]);
+        }
+    }
+
+    // Last level cache misses of the calling thread, where the hardware counters can be read
+    class CacheMissCounter
+    {
+    public:
+#if defined(__linux__)
+        CacheMissCounter()
+        {
+            perf_event_attr Attributes = {};
+            Attributes.type = PERF_TYPE_HARDWARE;
+            Attributes.size = sizeof(Attributes);
+            Attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+            Attributes.disabled = 1;
+            Attributes.exclude_kernel = 1;
+            Attributes.exclude_hv = 1;
+            m_iFile = (int)syscall(SYS_perf_event_open, &Attributes, 0, -1, -1, 0);
+        }
+        ~CacheMissCounter()
+        {
+            if (m_iFile >= 0)
+                close(m_iFile);
+        }
+        bool IsAvailable() const { return m_iFile >= 0; }
+        void Start()
+        {
+            ioctl(m_iFile, PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_iFile, PERF_EVENT_IOC_ENABLE, 0);
+        }
+        AkUInt64 Stop()
+        {
+            ioctl(m_iFile, PERF_EVENT_IOC_DISABLE, 0);
+            AkUInt64 uCount = 0;
+            return read(m_iFile, &uCount, sizeof(uCount)) == (ssize_t)sizeof(uCount) ? uCount : 0;
+        }
+
+    private:
+        int m_iFile;
+#else
+        bool IsAvailable() const { return false; }
+        void Start() {}
+        AkUInt64 Stop() { return 0; }
+#endif
+    };
+
+    // Sizes of the Generator and its DSP components, then what rendering voices in turn costs per buffer. With a
+    // single voice its state stays in cache, with BENCH_VOICES it is reloaded for every buffer
+    void ReportLayout(const EquivalenceOptions& in_Options, int in_iFrames)
+    {
+        std::vector<std::unique_ptr<Generator>> Voices = PrepareVoices(in_Options, BENCH_VOICES);
+
+        const GeneratorMemoryFootprint Footprint = Voices[0]->GetMemoryFootprint();
+        const struct { const char* Name; size_t Bytes; } SIZES[] = {
+            { "Generator", Footprint.Object },
+            { "  per-sample state", Footprint.HotState },
+            { "  crowd walkers", Footprint.Walkers },
+            { "  convolver and debug state", Footprint.Subsystems },
+            { "  configuration", Footprint.Configuration },
+            { "nemlib::WhiteNoiseGen", sizeof(nemlib::WhiteNoiseGen) },
+            { "nemlib::CurveEnvelope", sizeof(nemlib::CurveEnvelope) },
+            { "nemlib::BiquadFilter", sizeof(nemlib::BiquadFilter) },
+            { "nemlib::FilterBank", sizeof(nemlib::FilterBank) },
+            { "nemlib::Timer", sizeof(nemlib::Timer) },
+            { "CrowdWalker", sizeof(CrowdWalker) },
+        };
+        printf("  %-28s  %12s  %12s\n", "sizeof", "bytes", "cache lines");
+        for (const auto& Size : SIZES)
+            printf("  %-28s  %12zu  %12zu\n", Size.Name, Size.Bytes, (Size.Bytes + CACHE_LINE_BYTES - 1) / CACHE_LINE_BYTES);
+
+        CacheMissCounter Counter;
+        std::vector<float> Output(BENCH_VOICE_BUFFER_FRAMES);
+        const int iBuffers = std::max(in_iFrames / BENCH_VOICE_BUFFER_FRAMES, 1);
+        printf("  %-28s  %12s  %12s\n", "Voices rendered in turn", "ns per frame", "misses/buffer");
+        for (int iVoices : { 1, BENCH_VOICES })
+        {
+            // The voices' rendering is timed as a whole, the misses are counted over the same runs
+            AkUInt64 uMisses = 0;
+            int iCountedBuffers = 0;
+            const double fNanoseconds = MeasureNanosecondsPerFrame(iBuffers * BENCH_VOICE_BUFFER_FRAMES * iVoices, [&]()
+            {
+                if (Counter.IsAvailable())
+                    Counter.Start();
+                for (int b = 0; b < iBuffers; b++)
+                    for (int v = 0; v < iVoices; v++)
+                        Voices[v]->ExcuteModel(Output.data(), (AkUInt16)BENCH_VOICE_BUFFER_FRAMES);
+                if (Counter.IsAvailable())
+                    uMisses += Counter.Stop();
+                iCountedBuffers += iBuffers * iVoices;
+            });
+            if (Counter.IsAvailable())
+                printf("  %-28d  %12.2f  %12.1f\n", iVoices, fNanoseconds, (double)uMisses / (double)iCountedBuffers);
+            else
+                printf("  %-28d  %12.2f  %12s\n", iVoices, fNanoseconds, "n/a");
+        }
+    }
+
+    // SCALING_VOICES voices mixed by the scheduler with 1, 2, 4... threads up to every core
+    void ReportVoiceScaling(const EquivalenceOptions& in_Options, int in_iFrames)
+    {
+        const AkUInt32 uCores = std::max(std::thread::hardware_concurrency(), 1u);
+        std::vector<AkUInt32> ThreadCounts;
+        for (AkUInt32 uThreads = 1; uThreads < uCores; uThreads *= 2)
+            ThreadCounts.push_back(uThreads);
+        ThreadCounts.push_back(uCores);
+
+        const int iFrames = std::max(in_iFrames / 4, RENDER_BLOCK);
+        std::vector<float> Mix(RENDER_BLOCK);
+        double fSingleThread = 0.0;
+        printf("  %-28s  %12s  %10s  %10s\n", "Threads", "ns per frame", "speed-up", "efficiency");
+        for (AkUInt32 uThreads : ThreadCounts)
+        {
+            std::vector<std::unique_ptr<Generator>> Voices = PrepareVoices(in_Options, SCALING_VOICES);
+            VoiceRenderScheduler Scheduler(uThreads, (AkUInt16)RENDER_BLOCK);
+            for (std::unique_ptr<Generator>& Voice : Voices)
+                Scheduler.AddVoice(Voice.get());
+            // Per frame of a single voice, so the numbers compare with the other benchmarks
+            const double fNanoseconds = MeasureNanosecondsPerFrame(iFrames * SCALING_VOICES, [&]()
+            {
+                for (int iDone = 0; iDone < iFrames; iDone += RENDER_BLOCK)
+                    Scheduler.Render(Mix.data(), (AkUInt16)std::min(RENDER_BLOCK, iFrames - iDone));
+            });
+            if (uThreads == 1)
+                fSingleThread = fNanoseconds;
+            const double fSpeedUp = fSingleThread / fNanoseconds;
+            printf("  %-28u  %12.2f  %9.2fx  %9.0f%%\n", uThreads, fNanoseconds, fSpeedUp, fSpeedUp / (double)uThreads * 100.0);
+        }
+    }
+
+    void PrintUsage()
+    {
+        printf("Usage: FootstepsEquivalence [--golden <dir> | --write-golden <dir>] [--rate Hz] [--seconds S]\n"
+               "                            [--seed N] [--tiers] [--bench]\n");
+    }
+
+    bool ParseOptions(int argc, char** argv, EquivalenceOptions& out_Options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const char* szArg = argv[i];
+            const char* szValue = i + 1 < argc ? argv[i + 1] : nullptr;
+            if (strcmp(szArg, "--tiers") == 0)
+            {
+                out_Options.Tiers = true;
+                continue;
+            }
+            if (strcmp(szArg, "--bench") == 0)
+            {
+                out_Options.Bench = true;
+                continue;
+            }
+            if (szValue == nullptr)
+                return false;
+
+            if (strcmp(szArg, "--golden") == 0)
+                out_Options.GoldenDir = szValue;
+            else if (strcmp(szArg, "--write-golden") == 0)
+            {
+                out_Options.GoldenDir = szValue;
+                out_Options.WriteGolden = true;
+            }
+            else if (strcmp(szArg, "--rate") == 0)
+                out_Options.SampleRate = (AkUInt32)std::max(atoi(szValue), 8000);
+            else if (strcmp(szArg, "--seconds") == 0)
+                out_Options.Seconds = nemlib::Clamp((float)atof(szValue), 0.5f, 60.0f);
+            else if (strcmp(szArg, "--seed") == 0)
+                out_Options.Seed = (AkUInt32)strtoul(szValue, nullptr, 10);
+            else
+                return false;
+            i++;
+        }
+        return true;
+    }
+
+    void EnableFlushToZero()
+    {
+        // Same floating point mode as the sound engine's audio thread, the reference renders were made in it too
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+        _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+        _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+#endif
+    }
+}
+
+int main(int argc, char** argv)
+{
+    EquivalenceOptions Options;
+    if (!ParseOptions(argc, argv, Options))
+    {
+        PrintUsage();
+        return 2;
+    }
+    if (Options.WriteGolden)
+    {
+        std::error_code Error;
+        std::filesystem::create_directories(Options.GoldenDir, Error);
+        if (Error)
+        {
+            fprintf(stderr, "Cannot create %s: %s\n", Options.GoldenDir.c_str(), Error.message().c_str());
+            return 2;
+        }
+    }
+
+    EnableFlushToZero();
+    nemlib::RealFFT FFT(SPECTRUM_SIZE);
+    const int iFrames = (int)(Options.Seconds * (float)Options.SampleRate);
+    bool bPass = true;
+
+    // Everything but the per variant checks runs with the variant selected at load
+    const nemlib::KernelVariant LoadedVariant = nemlib::GetKernelVariant();
+    const int iVariants = (int)nemlib::GetSupportedKernelVariant() + 1;
+    printf("Kernels against the frozen reference, %d frames at %u Hz, seed %u, %s kernels selected\n", iFrames,
+        Options.SampleRate, Options.Seed, nemlib::GetKernelVariantName(LoadedVariant));
+    for (int v = 0; v < iVariants; v++)
+    {
+        nemlib::SelectKernels((nemlib::KernelVariant)v);
+        bPass = CheckNoise(FFT, Options, iFrames) && bPass;
+        bPass = CheckFilterBank(FFT, Options, iFrames) && bPass;
+    }
+    nemlib::SelectKernels(LoadedVariant);
+    bPass = CheckBiquad(FFT, Options, iFrames) && bPass;
+    bPass = CheckEnvelope(FFT, Options, iFrames, Options.Tiers) && bPass;
+    bPass = CheckVoiceScheduler(FFT, Options, iFrames) && bPass;
+    bPass = CheckRandom(Options) && bPass;
+    bPass = CheckParamBatches() && bPass;
+
+    if (!Options.GoldenDir.empty())
+    {
+        printf("Generator %s golden renders\n", Options.WriteGolden ? "writing" : "against the");
+        const int iFirstVariant = Options.WriteGolden ? (int)LoadedVariant : 0;
+        const int iLastVariant = Options.WriteGolden ? (int)LoadedVariant : iVariants - 1;
+        for (int v = iFirstVariant; v <= iLastVariant; v++)
+        {
+            nemlib::SelectKernels((nemlib::KernelVariant)v);
+            const int iResult = CheckGenerator(FFT, Options, iFrames);
+            if (iResult == 2)
+                return 2;
+            bPass = iResult == 0 && bPass;
+        }
+        nemlib::SelectKernels(LoadedVariant);
+    }
+    if (Options.Tiers)
+    {
+        printf("Generator quality tiers against the full quality render\n");
+        ReportTiers(FFT, Options, iFrames);
+    }
+    if (Options.Bench)
+    {
+        printf("Kernel variants, best of %d runs\n", BENCH_RUNS);
+        ReportBenchmark(Options, iFrames);
+        nemlib::SelectKernels(LoadedVariant);
+        printf("Generator per buffer size, best of %d runs\n", BENCH_RUNS);
+        ReportBufferSizes(Options, iFrames);
+        printf("Generator layout and cache misses per buffer, best of %d runs\n", BENCH_RUNS);
+        ReportLayout(Options, iFrames);
+        printf("VoiceRenderScheduler, %d voices, best of %d runs\n", SCALING_VOICES, BENCH_RUNS);
+        ReportVoiceScaling(Options, iFrames);
+    }
+
+    printf(bPass ? "All components within their thresholds\n" : "Some components are over their thresholds\n");
+    return bPass ? 0 : 1;
+}
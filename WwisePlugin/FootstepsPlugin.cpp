@@ -1,80 +1,125 @@
-/*******************************************************************************
-The content of this file includes portions of the AUDIOKINETIC Wwise Technology
-released in source code form as part of the SDK installer package.
-
-Commercial License Usage
-
-Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
-may use this file in accordance with the end user license agreement provided
-with the software or, alternatively, in accordance with the terms contained in a
-written agreement between you and Audiokinetic Inc.
-
-Apache License Usage
-
-Alternatively, this file may be used under the Apache License, Version 2.0 (the
-"Apache License"); you may not use this file except in compliance with the
-Apache License. You may obtain a copy of the Apache License at
-http://www.apache.org/licenses/LICENSE-2.0.
-
-Unless required by applicable law or agreed to in writing, software distributed
-under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
-OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
-the specific language governing permissions and limitations under the License.
-
-  Copyright (c) 2021 Audiokinetic Inc.
-*******************************************************************************/
-
-#include "FootstepsPlugin.h"
-#include "../SoundEnginePlugin/FootstepsSourceFactory.h"
-
-//property names
-const char* const szShoeType = "ShoeType";
-const char* const szSurfaceType = "SurfaceType";
-const char* const szTerrainType = "TerrainType";
-const char* const szPace = "Pace";
-const char* const szFirmness = "Firmness";
-const char* const szSteadiness = "Steadiness";
-const char* const szAutomated = "Automated";
-
-FootstepsPlugin::FootstepsPlugin()
-{
-}
-
-FootstepsPlugin::~FootstepsPlugin()
-{
-}
-
-bool FootstepsPlugin::GetBankParameters(const GUID & in_guidPlatform, AK::Wwise::Plugin::DataWriter& in_dataWriter) const
-{
-    // Write bank data here
-    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, szShoeType));
-    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, szSurfaceType));
-    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, szTerrainType));
-    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, szPace));
-    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, szFirmness));
-    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, szSteadiness));
-    in_dataWriter.WriteBool(m_propertySet.GetBool(in_guidPlatform, szAutomated));
-
-    return true;
-}
-
-
-
-bool FootstepsPlugin::GetSourceDuration(double& out_dblMinDuration, double& out_dblMaxDuration) const
-{
-    out_dblMinDuration = 0;
-    out_dblMaxDuration = FLT_MAX;
-
-    return true;
-}
-
-DEFINE_AUDIOPLUGIN_CONTAINER(Footsteps);											// Create a PluginContainer structure that contains the info for our plugin
-EXPORT_AUDIOPLUGIN_CONTAINER(Footsteps);											// This is a DLL, we want to have a standardized name
-ADD_AUDIOPLUGIN_CLASS_TO_CONTAINER(                                             // Add our CLI class to the PluginContainer
-    Footsteps,        // Name of the plug-in container for this shared library
-    FootstepsPlugin,  // Authoring plug-in class to add to the plug-in container
-    FootstepsSource   // Corresponding Sound Engine plug-in class
-);
-DEFINE_PLUGIN_REGISTER_HOOK
-
-DEFINEDUMMYASSERTHOOK;							// Placeholder assert hook for Wwise plug-ins using AKASSERT (cassert used by default)
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2021 Audiokinetic Inc.
+*******************************************************************************/
+
+#include "FootstepsPlugin.h"
+#include "../SoundEnginePlugin/FootstepsSourceFactory.h"
+
+//property names
+const char* const szShoeType = "ShoeType";
+const char* const szSurfaceType = "SurfaceType";
+const char* const szTerrainType = "TerrainType";
+const char* const szPace = "Pace";
+const char* const szFirmness = "Firmness";
+const char* const szSteadiness = "Steadiness";
+const char* const szAutomated = "Automated";
+const char* const szCrowdSize = "CrowdSize";
+const char* const szPaceSpread = "PaceSpread";
+const char* const szSteadinessSpread = "SteadinessSpread";
+const char* const szLookaheadTime = "LookaheadTime";
+const char* const szOneShot = "OneShot";
+const char* const szConvolution = "Convolution";
+const char* const szPaceTarget = "PaceTarget";
+const char* const szPaceCurveTime = "PaceCurveTime";
+const char* const szFirmnessTarget = "FirmnessTarget";
+const char* const szFirmnessCurveTime = "FirmnessCurveTime";
+const char* const szCpuBudget = "CpuBudget";
+const char* const szMaxModes = "MaxModes";
+const char* const szRateDivisor = "RateDivisor";
+const char* const szCrunch = "Crunch";
+const char* const szEnvelopeResolution = "EnvelopeResolution";
+const char* const szBlendSurface = "BlendSurface";
+const char* const szSurfaceBlend = "SurfaceBlend";
+const char* const szIdleReleaseTime = "IdleReleaseTime";
+
+//longest step the sound engine can render in one-shot mode, in seconds
+const double kOneShotMaxDuration = 1.0;
+
+FootstepsPlugin::FootstepsPlugin()
+{
+}
+
+FootstepsPlugin::~FootstepsPlugin()
+{
+}
+
+bool FootstepsPlugin::GetBankParameters(const GUID & in_guidPlatform, AK::Wwise::Plugin::DataWriter& in_dataWriter) const
+{
+    // Write bank data here
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, szShoeType));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, szSurfaceType));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, szTerrainType));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, szPace));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, szFirmness));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, szSteadiness));
+    in_dataWriter.WriteBool(m_propertySet.GetBool(in_guidPlatform, szAutomated));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, szCrowdSize));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, szPaceSpread));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, szSteadinessSpread));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, szLookaheadTime));
+    in_dataWriter.WriteBool(m_propertySet.GetBool(in_guidPlatform, szOneShot));
+    in_dataWriter.WriteBool(m_propertySet.GetBool(in_guidPlatform, szConvolution));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, szPaceTarget));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, szPaceCurveTime));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, szFirmnessTarget));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, szFirmnessCurveTime));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, szCpuBudget));
+    // Quality tier, unlinked per platform in the authoring tool so handhelds get the cheaper settings
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, szMaxModes));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, szRateDivisor));
+    in_dataWriter.WriteBool(m_propertySet.GetBool(in_guidPlatform, szCrunch));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, szEnvelopeResolution));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, szBlendSurface));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, szSurfaceBlend));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, szIdleReleaseTime));
+
+    return true;
+}
+
+
+
+bool FootstepsPlugin::GetSourceDuration(double& out_dblMinDuration, double& out_dblMaxDuration) const
+{
+    out_dblMinDuration = 0;
+    out_dblMaxDuration = FLT_MAX;
+
+    if (m_propertySet.GetBool(BasePlatformID, szOneShot))
+    {
+        out_dblMaxDuration = kOneShotMaxDuration;
+    }
+
+    return true;
+}
+
+DEFINE_AUDIOPLUGIN_CONTAINER(Footsteps);											// Create a PluginContainer structure that contains the info for our plugin
+EXPORT_AUDIOPLUGIN_CONTAINER(Footsteps);											// This is a DLL, we want to have a standardized name
+ADD_AUDIOPLUGIN_CLASS_TO_CONTAINER(                                             // Add our CLI class to the PluginContainer
+    Footsteps,        // Name of the plug-in container for this shared library
+    FootstepsPlugin,  // Authoring plug-in class to add to the plug-in container
+    FootstepsSource   // Corresponding Sound Engine plug-in class
+);
+DEFINE_PLUGIN_REGISTER_HOOK
+
+DEFINEDUMMYASSERTHOOK;							// Placeholder assert hook for Wwise plug-ins using AKASSERT (cassert used by default)